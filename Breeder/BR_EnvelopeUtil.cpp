@@ -221,10 +221,11 @@ bool BR_Envelope::SetPoint (int id, double* position, double* value, int* shape,
 		if (snapValue && value)
 			WritePtr(value, this->SnapValue(*value));
 
-		if (position) m_points[id].position = *position - m_takeEnvOffset;
-		ReadPtr(value,  m_points[id].value);
-		ReadPtr(shape,  m_points[id].shape);
-		ReadPtr(bezier, m_points[id].bezier);
+		vector<BR_Envelope::EnvPoint>& points = m_points.Edit();
+		if (position) points[id].position = *position - m_takeEnvOffset;
+		ReadPtr(value,  points[id].value);
+		ReadPtr(shape,  points[id].shape);
+		ReadPtr(bezier, points[id].bezier);
 
 		m_update = true;
 		if (position) m_sorted = false;
@@ -249,7 +250,7 @@ bool BR_Envelope::SetSelection (int id, bool selected)
 	{
 		if (m_points[id].selected != selected)
 		{
-			m_points[id].selected = selected;
+			m_points.Edit()[id].selected = selected;
 			m_update = true;
 		}
 		return true;
@@ -271,7 +272,8 @@ bool BR_Envelope::CreatePoint (int id, double position, double value, int shape,
 			return false;
 
 		BR_Envelope::EnvPoint newPoint(position, (snapValue) ? (this->SnapValue(value)) : (value), shape, 0, selected, 0, bezier);
-		m_points.insert(m_points.begin() + id, newPoint);
+		vector<BR_Envelope::EnvPoint>& points = m_points.Edit();
+		points.insert(points.begin() + id, newPoint);
 
 		m_update       = true;
 		m_sorted       = false;
@@ -286,7 +288,8 @@ bool BR_Envelope::DeletePoint (int id)
 {
 	if (this->ValidateId(id))
 	{
-		m_points.erase(m_points.begin() + id);
+		vector<BR_Envelope::EnvPoint>& points = m_points.Edit();
+		points.erase(points.begin() + id);
 
 		m_update       = true;
 		m_pointsEdited = true;
@@ -346,9 +349,10 @@ bool BR_Envelope::SetTimeSig (int id, bool sig, bool partial, int num, int den)
 		if (sig && (!CheckBounds(num, MIN_SIG, MAX_SIG) || !CheckBounds(den, MIN_SIG, MAX_SIG)))
 				return false;
 
-		m_points[id].sig = (sig) ? ((den << 16) + num) : (0);
-		m_points[id].partial = SetBit(m_points[id].partial, 0, sig);
-		m_points[id].partial = SetBit(m_points[id].partial, 2, partial);
+		vector<BR_Envelope::EnvPoint>& points = m_points.Edit();
+		points[id].sig = (sig) ? ((den << 16) + num) : (0);
+		points[id].partial = SetBit(points[id].partial, 0, sig);
+		points[id].partial = SetBit(points[id].partial, 2, partial);
 
 		m_update       = true;
 		m_pointsEdited = true;
@@ -371,7 +375,7 @@ bool BR_Envelope::SetCreatePoint (int id, double position, double value, int sha
 			m_sorted = false;
 
 		BR_Envelope::EnvPoint newPoint(position, value, (shape < MIN_SHAPE || shape > MAX_SHAPE) ? this->GetDefaultShape() : shape, 0, selected, 0, (shape == 5) ? bezier : 0);
-		m_points.push_back(newPoint);
+		m_points.Edit().push_back(newPoint);
 
 		return true;
 	}
@@ -383,13 +387,14 @@ bool BR_Envelope::SetCreatePoint (int id, double position, double value, int sha
 				m_sorted = false;
 		}
 
+		vector<BR_Envelope::EnvPoint>& points = m_points.Edit();
 		if (shape >= MIN_SHAPE && shape <= MAX_SHAPE)
-			m_points[id].shape = shape;
+			points[id].shape = shape;
 
-		m_points[id].position = position;
-		m_points[id].value    = value;
-		m_points[id].bezier   = (m_points[id].shape == BEZIER) ? bezier : 0;
-		m_points[id].selected = selected;
+		points[id].position = position;
+		points[id].value    = value;
+		points[id].bezier   = (points[id].shape == BEZIER) ? bezier : 0;
+		points[id].selected = selected;
 
 		m_update       = true;
 		m_pointsEdited = true;
@@ -411,7 +416,8 @@ int BR_Envelope::DeletePoints (int startId, int endId)
 	if (!this->ValidateId(startId) || !this->ValidateId(endId))
 		return 0;
 
-	m_points.erase(m_points.begin() + startId, m_points.begin() + endId+1);
+	vector<BR_Envelope::EnvPoint>& points = m_points.Edit();
+	points.erase(points.begin() + startId, points.begin() + endId+1);
 
 	m_update       = true;
 	m_pointsEdited = true;
@@ -454,11 +460,12 @@ int BR_Envelope::DeletePointsInRange (double start, double end)
 	}
 	else
 	{
-		for (vector<BR_Envelope::EnvPoint>::iterator i = m_points.begin(); i != m_points.end();)
+		vector<BR_Envelope::EnvPoint>& points = m_points.Edit();
+		for (vector<BR_Envelope::EnvPoint>::iterator i = points.begin(); i != points.end();)
 		{
 			if (i->position >= start && i->position <= end)
 			{
-				i = m_points.erase(i);
+				i = points.erase(i);
 				m_update       = true;
 				m_pointsEdited = true;
 				++pointsErased;
@@ -473,8 +480,9 @@ int BR_Envelope::DeletePointsInRange (double start, double end)
 
 void BR_Envelope::UnselectAll ()
 {
-	for (size_t i = 0; i < m_points.size(); ++i)
-		m_points[i].selected = 0;
+	vector<BR_Envelope::EnvPoint>& points = m_points.Edit();
+	for (size_t i = 0; i < points.size(); ++i)
+		points[i].selected = 0;
 	m_update = true;
 }
 
@@ -531,7 +539,7 @@ bool BR_Envelope::ValidateId (int id)
 
 void BR_Envelope::DeleteAllPoints ()
 {
-	m_points.clear();
+	m_points = BR_Envelope::PointList();
 	m_sorted = true;
 	m_update = true;
 }
@@ -540,7 +548,8 @@ void BR_Envelope::Sort ()
 {
 	if (!m_sorted)
 	{
-		stable_sort(m_points.begin(), m_points.end(), BR_Envelope::EnvPoint::ComparePoints());
+		vector<BR_Envelope::EnvPoint>& points = m_points.Edit();
+		stable_sort(points.begin(), points.end(), BR_Envelope::EnvPoint::ComparePoints());
 		m_sorted = true;
 	}
 }
@@ -577,7 +586,7 @@ int BR_Envelope::Find (double position, double surroundingRange /*=0*/)
 	{
 		int prevId = (m_sorted) ? (this->FindPrevious(position, 0)) : (0);
 
-		for (vector<BR_Envelope::EnvPoint>::iterator i = m_points.begin(); i != m_points.end() ; ++i)
+		for (vector<BR_Envelope::EnvPoint>::const_iterator i = m_points.begin(); i != m_points.end() ; ++i)
 		{
 			if (i->position == position)
 			{
@@ -683,90 +692,183 @@ double BR_Envelope::ValueAtPosition (double position, bool fastMode /*= false*/)
 			return m_points[this->LastPointAtPos(nextId)].value;
 
 		// Everything else
-		double t1 = m_points[id].position;
-		double t2 = m_points[nextId].position;
-		double v1 = m_points[id].value;
-		double v2 = m_points[nextId].value;
-		if (faderMode)
+		BR_Envelope::Segment segment;
+		this->PrepareSegment(id, nextId, faderMode, &segment);
+		return this->SegmentValue(segment, position, faderMode);
+	}
+}
+
+double BR_Envelope::HitTestValue (double position)
+{
+	if (m_tempoMap)
+		return this->ValueAtPosition(position);
+
+	if (m_sorted && !m_pointsEdited)
+	{
+		const int id = this->FindPrevious(position - m_takeEnvOffset, 0);
+		if (this->ValidateId(id) && this->ValidateId(id + 1) && m_points[id].shape == BEZIER)
+			return this->ValueAtPosition(position);
+	}
+	return this->ValueAtPosition(position, true);
+}
+
+void BR_Envelope::ValuesAtPositions (double start, double step, int count, double* values)
+{
+	// Unsorted points can't be walked incrementally, fall back to evaluating each position separately
+	if (!m_sorted)
+	{
+		for (int i = 0; i < count; ++i)
+			values[i] = this->ValueAtPosition(start + i * step, true);
+		return;
+	}
+
+	const bool faderMode = this->IsScaledToFader();
+	const int pointCount = (int)m_points.size();
+	start -= m_takeEnvOffset;
+
+	// Only one search per call, after that segments are walked as positions advance
+	int id = this->FindPrevious(start, 0);
+	BR_Envelope::Segment segment;
+	segment.id = -1;
+
+	for (int i = 0; i < count; ++i)
+	{
+		const double position = start + i * step;
+		while (id + 1 < pointCount && m_points[id + 1].position < position)
+			++id;
+
+		// No previous point?
+		if (id < 0)
 		{
-			v1 = this->NormalizedDisplayValue(v1);
-			v2 = this->NormalizedDisplayValue(v2);
+			values[i] = (pointCount) ? m_points[0].value : this->LaneCenterValue();
+			continue;
 		}
 
-		double returnValue = 0;
-		switch (m_points[id].shape)
+		// No next point?
+		const int nextId = id + 1;
+		if (nextId >= pointCount)
 		{
-			case SQUARE:
-			{
-				returnValue = v1;
-			}
-			break;
+			values[i] = m_points[id].value;
+			continue;
+		}
 
-			case LINEAR:
-			{
-				double t = (position - t1) / (t2 - t1);
-				returnValue = (!m_tempoMap) ? (v1 + (v2 - v1) * t) : CalculateTempoAtPosition(v1, v2, t1, t2, position);
-			}
-			break;
+		// Position at the end of transition ?
+		if (m_points[nextId].position == position)
+		{
+			values[i] = m_points[this->LastPointAtPos(nextId)].value;
+			continue;
+		}
 
-			case FAST_END:                                 // f(x) = x^3
-			{
-				double t = (position - t1) / (t2 - t1);
-				returnValue =  v1 + (v2 - v1) * pow(t, 3);
-			}
-			break;
+		// Everything else (segment properties are prepared only when entering new segment)
+		if (segment.id != id)
+			this->PrepareSegment(id, nextId, faderMode, &segment);
+		values[i] = this->SegmentValue(segment, position, faderMode);
+	}
+}
 
-			case FAST_START:                               // f(x) = 1 - (1 - x)^3
-			{
-				double t = (position - t1) / (t2 - t1);
-				returnValue =  v1 + (v2 - v1) * (1 - pow(1-t, 3));
-			}
-			break;
+void BR_Envelope::PrepareSegment (int id, int nextId, bool faderMode, BR_Envelope::Segment* segment)
+{
+	/* no bounds checking - internal function so caller handles before calling */
+	segment->id    = id;
+	segment->shape = m_points[id].shape;
+	segment->t1    = m_points[id].position;
+	segment->t2    = m_points[nextId].position;
+	segment->v1    = m_points[id].value;
+	segment->v2    = m_points[nextId].value;
+	if (faderMode)
+	{
+		segment->v1 = this->NormalizedDisplayValue(segment->v1);
+		segment->v2 = this->NormalizedDisplayValue(segment->v2);
+	}
 
-			case SLOW_START_END:                           // f(x) = x^2 * (3-2x)
-			{
-				double t = (position - t1) / (t2 - t1);
-				returnValue =  v1 + (v2 - v1) * (pow(t, 2) * (3 - 2*t));
-			}
-			break;
+	if (segment->shape == BEZIER)
+	{
+		const double t1 = segment->t1, t2 = segment->t2, v1 = segment->v1, v2 = segment->v2;
 
-			case BEZIER:
-			{
-				int id0 = (m_sorted) ? (id-1)     : (this->FindPrevious(t1, 0));
-				int id3 = (m_sorted) ? (nextId+1) : (this->FindNext(t2, 0));
-				double t0 = (!this->ValidateId(id0)) ? (t1) : (m_points[id0].position);
-				double v0 = (!this->ValidateId(id0)) ? (v1) : (m_points[id0].value);
-				double t3 = (!this->ValidateId(id3)) ? (t2) : (m_points[id3].position);
-				double v3 = (!this->ValidateId(id3)) ? (v2) : (m_points[id3].value);
-				if (faderMode)
-				{
-					v0 = this->NormalizedDisplayValue(v0);
-					v3 = this->NormalizedDisplayValue(v3);
-				}
+		int id0 = (m_sorted) ? (id-1)     : (this->FindPrevious(t1, 0));
+		int id3 = (m_sorted) ? (nextId+1) : (this->FindNext(t2, 0));
+		double t0 = (!this->ValidateId(id0)) ? (t1) : (m_points[id0].position);
+		double v0 = (!this->ValidateId(id0)) ? (v1) : (m_points[id0].value);
+		double t3 = (!this->ValidateId(id3)) ? (t2) : (m_points[id3].position);
+		double v3 = (!this->ValidateId(id3)) ? (v2) : (m_points[id3].value);
+		if (faderMode)
+		{
+			v0 = this->NormalizedDisplayValue(v0);
+			v3 = this->NormalizedDisplayValue(v3);
+		}
 
-				double x1, x2, y1, y2, empty;
-				LICE_Bezier_FindCardinalCtlPts(0.25, t0, t1, t2, v0, v1, v2, &empty, &x1, &empty, &y1);
-				LICE_Bezier_FindCardinalCtlPts(0.25, t1, t2, t3, v1, v2, v3, &x2, &empty, &y2, &empty);
-
-				double tension = m_points[id].bezier;
-				x1 += tension * ((tension > 0) ? (t2-x1) : (x1-t1));
-				x2 += tension * ((tension > 0) ? (t2-x2) : (x2-t1));
-				y1 -= tension * ((tension > 0) ? (y1-v1) : (v2-y1));
-				y2 -= tension * ((tension > 0) ? (y2-v1) : (v2-y2));
-
-				x1 = SetToBounds(x1, t1, t2);
-				x2 = SetToBounds(x2, t1, t2);
-				y1 = SetToBounds(y1, this->MinValueAbs(), this->MaxValueAbs());
-				y2 = SetToBounds(y2, this->MinValueAbs(), this->MaxValueAbs());
-				returnValue = LICE_CBezier_GetY(t1, x1, x2, t2, v1, y1, y2, v2, position);
-			}
-			break;
+		double x1, x2, y1, y2, empty;
+		LICE_Bezier_FindCardinalCtlPts(0.25, t0, t1, t2, v0, v1, v2, &empty, &x1, &empty, &y1);
+		LICE_Bezier_FindCardinalCtlPts(0.25, t1, t2, t3, v1, v2, v3, &x2, &empty, &y2, &empty);
+
+		double tension = m_points[id].bezier;
+		x1 += tension * ((tension > 0) ? (t2-x1) : (x1-t1));
+		x2 += tension * ((tension > 0) ? (t2-x2) : (x2-t1));
+		y1 -= tension * ((tension > 0) ? (y1-v1) : (v2-y1));
+		y2 -= tension * ((tension > 0) ? (y2-v1) : (v2-y2));
+
+		segment->x1 = SetToBounds(x1, t1, t2);
+		segment->x2 = SetToBounds(x2, t1, t2);
+		segment->y1 = SetToBounds(y1, this->MinValueAbs(), this->MaxValueAbs());
+		segment->y2 = SetToBounds(y2, this->MinValueAbs(), this->MaxValueAbs());
+	}
+	else
+	{
+		segment->x1 = segment->x2 = segment->y1 = segment->y2 = 0;
+	}
+}
+
+double BR_Envelope::SegmentValue (const BR_Envelope::Segment& segment, double position, bool faderMode)
+{
+	const double t1 = segment.t1, t2 = segment.t2, v1 = segment.v1, v2 = segment.v2;
+
+	double returnValue = 0;
+	switch (segment.shape)
+	{
+		case SQUARE:
+		{
+			returnValue = v1;
 		}
+		break;
 
-		if (faderMode)
-			returnValue = this->RealValue(returnValue);
-		return returnValue;
+		case LINEAR:
+		{
+			double t = (position - t1) / (t2 - t1);
+			returnValue = (!m_tempoMap) ? (v1 + (v2 - v1) * t) : CalculateTempoAtPosition(v1, v2, t1, t2, position);
+		}
+		break;
+
+		case FAST_END:                                 // f(x) = x^3
+		{
+			double t = (position - t1) / (t2 - t1);
+			returnValue =  v1 + (v2 - v1) * pow(t, 3);
+		}
+		break;
+
+		case FAST_START:                               // f(x) = 1 - (1 - x)^3
+		{
+			double t = (position - t1) / (t2 - t1);
+			returnValue =  v1 + (v2 - v1) * (1 - pow(1-t, 3));
+		}
+		break;
+
+		case SLOW_START_END:                           // f(x) = x^2 * (3-2x)
+		{
+			double t = (position - t1) / (t2 - t1);
+			returnValue =  v1 + (v2 - v1) * (pow(t, 2) * (3 - 2*t));
+		}
+		break;
+
+		case BEZIER:
+		{
+			returnValue = LICE_CBezier_GetY(t1, segment.x1, segment.x2, t2, v1, segment.y1, segment.y2, v2, position);
+		}
+		break;
 	}
+
+	if (faderMode)
+		returnValue = this->RealValue(returnValue);
+	return returnValue;
 }
 
 double BR_Envelope::NormalizedDisplayValue (double value)
@@ -1451,7 +1553,7 @@ bool BR_Envelope::Commit (bool force /*=false*/)
 		if (m_tempoMap)
 		{
 			WDL_FastString chunkStart = this->GetProperties();
-			for (vector<BR_Envelope::EnvPoint>::iterator i = m_points.begin(); i != m_points.end(); ++i)
+			for (vector<BR_Envelope::EnvPoint>::const_iterator i = m_points.begin(); i != m_points.end(); ++i)
 				i->Append(chunkStart, true);
 			chunkStart.Append(">");
 			GetSetObjectState(m_envelope, chunkStart.Get());
@@ -1499,7 +1601,10 @@ bool BR_Envelope::Commit (bool force /*=false*/)
 			{
 				double value = (m_properties.faderMode != 0) ? ScaleToEnvelopeMode(m_properties.faderMode, m_points[i].value) : m_points[i].value;
 				double position = m_points[i].position * playrate;
-				SetEnvelopePoint(m_envelope, i, &position, &value, &m_points[i].shape, &m_points[i].bezier, &m_points[i].selected, &g_bTrue);
+				int shape = m_points[i].shape;
+				double bezier = m_points[i].bezier;
+				bool selected = m_points[i].selected;
+				SetEnvelopePoint(m_envelope, i, &position, &value, &shape, &bezier, &selected, &g_bTrue);
 			}
 			for (size_t i = currentCount; i < m_points.size(); ++i)
 			{
@@ -1512,6 +1617,7 @@ bool BR_Envelope::Commit (bool force /*=false*/)
 			PreventUIRefresh(-1);
 		}
 
+		PointCache().erase(m_envelope);
 		UpdateArrange();
 		m_update       = false;
 		m_pointsEdited = false;
@@ -1531,7 +1637,7 @@ int BR_Envelope::FindFirstPoint ()
 	{
 		int id = 0;
 		double first = m_points[id].position;
-		for (vector<BR_Envelope::EnvPoint>::iterator i = m_points.begin(); i != m_points.end() ; ++i)
+		for (vector<BR_Envelope::EnvPoint>::const_iterator i = m_points.begin(); i != m_points.end() ; ++i)
 			if (i->position < first)
 				id = (int)(i - m_points.begin());
 		return id;
@@ -1546,7 +1652,7 @@ int BR_Envelope::LastPointAtPos (int id)
 
 	if (m_sorted)
 	{
-		for (vector<BR_Envelope::EnvPoint>::iterator i = id + m_points.begin(); i != m_points.end() ; ++i)
+		for (vector<BR_Envelope::EnvPoint>::const_iterator i = id + m_points.begin(); i != m_points.end() ; ++i)
 		{
 			if (i->position == position)
 				lastId = (int)(i - m_points.begin());
@@ -1556,7 +1662,7 @@ int BR_Envelope::LastPointAtPos (int id)
 	}
 	else
 	{
-		for (vector<BR_Envelope::EnvPoint>::iterator i = m_points.begin(); i != m_points.end() ; ++i)
+		for (vector<BR_Envelope::EnvPoint>::const_iterator i = m_points.begin(); i != m_points.end() ; ++i)
 			if (i->position == position)
 				lastId = (int)(i - m_points.begin());
 	}
@@ -1578,7 +1684,7 @@ int BR_Envelope::FindNext (double position, double offset)
 		int id = -1;
 		double nextPos = 0;
 		bool foundFirst = false;
-		for (vector<BR_Envelope::EnvPoint>::iterator i = m_points.begin(); i != m_points.end() ; ++i)
+		for (vector<BR_Envelope::EnvPoint>::const_iterator i = m_points.begin(); i != m_points.end() ; ++i)
 		{
 			double currentPos = i->position;
 			if (currentPos > position)
@@ -1617,7 +1723,7 @@ int BR_Envelope::FindPrevious (double position, double offset)
 		int id = -1;
 		double prevPos = 0;
 		bool foundFirst = false;
-		for (vector<BR_Envelope::EnvPoint>::iterator i = m_points.begin(); i != m_points.end() ; ++i)
+		for (vector<BR_Envelope::EnvPoint>::const_iterator i = m_points.begin(); i != m_points.end() ; ++i)
 		{
 			double currentPos = i->position;
 			if (currentPos < position)
@@ -1648,50 +1754,60 @@ void BR_Envelope::Build (bool takeEnvelopesUseProjectTime)
 	{
 		int count = CountEnvelopePoints(m_envelope);
 		m_properties.faderMode = (GetEnvelopeScalingMode(m_envelope) == 1) ? 1 : 0;
-		m_points.reserve(count);
-		m_pointsSel.reserve(count);
+		double playrate = (m_take) ? (GetMediaItemTakeInfo_Value(m_take, "D_PLAYRATE")) : 1;
 
-		// Since information on partial measures is missing from the API, we need to parse the chunk for tempo map
-		if (m_tempoMap)
+		const bool useCache = s_pointCacheScopes > 0;
+		if (!useCache || !this->BuildFromCache(count, playrate))
 		{
-			char* envState = GetSetObjectState(m_envelope, "");
-			char* token = strtok(envState, "\n");
-			LineParser lp(false);
-			bool start = false;
-			int id = -1;
-			while (token != NULL)
+			std::shared_ptr<vector<BR_Envelope::EnvPoint> > points = std::make_shared<vector<BR_Envelope::EnvPoint> >();
+			points->reserve(count);
+			m_pointsSel.reserve(count);
+
+			// Since information on partial measures is missing from the API, we need to parse the chunk for tempo map
+			if (m_tempoMap)
 			{
-				lp.parse(token);
-				BR_Envelope::EnvPoint point;
-				if (point.ReadLine(lp))
+				char* envState = GetSetObjectState(m_envelope, "");
+				char* token = strtok(envState, "\n");
+				LineParser lp(false);
+				bool start = false;
+				int id = -1;
+				while (token != NULL)
 				{
-					++id;
-					start = true;
-					m_points.push_back(point);
-					if (point.selected == 1)
-						m_pointsSel.push_back(id);
+					lp.parse(token);
+					BR_Envelope::EnvPoint point;
+					if (point.ReadLine(lp))
+					{
+						++id;
+						start = true;
+						points->push_back(point);
+						if (point.selected == 1)
+							m_pointsSel.push_back(id);
+					}
+					else if (!start)
+						AppendLine(m_chunkProperties, token);
+					token = strtok(NULL, "\n");
 				}
-				else if (!start)
-					AppendLine(m_chunkProperties, token);
-				token = strtok(NULL, "\n");
+				FreeHeapPtr(envState);
 			}
-			FreeHeapPtr(envState);
-		}
-		else
-		{
-			double playrate = (m_take) ? (GetMediaItemTakeInfo_Value(m_take, "D_PLAYRATE")) : 1;
-			for (int i = 0; i < count; ++i)
+			else
 			{
-				BR_Envelope::EnvPoint point;
-				GetEnvelopePoint(m_envelope, i, &point.position, &point.value, &point.shape, &point.bezier, &point.selected);
-				point.position /= playrate;
+				for (int i = 0; i < count; ++i)
+				{
+					BR_Envelope::EnvPoint point;
+					GetEnvelopePoint(m_envelope, i, &point.position, &point.value, &point.shape, &point.bezier, &point.selected);
+					point.position /= playrate;
 
-				if (m_properties.faderMode != 0)
-					point.value = ScaleFromEnvelopeMode(m_properties.faderMode, point.value);
+					if (m_properties.faderMode != 0)
+						point.value = ScaleFromEnvelopeMode(m_properties.faderMode, point.value);
 
-				m_points.push_back(point);
-				if (point.selected) m_pointsSel.push_back(i);
+					points->push_back(point);
+					if (point.selected) m_pointsSel.push_back(i);
+				}
 			}
+
+			m_points = BR_Envelope::PointList(points);
+			if (useCache)
+				this->StoreInCache(count, playrate);
 		}
 	}
 
@@ -1699,6 +1815,104 @@ void BR_Envelope::Build (bool takeEnvelopesUseProjectTime)
 		m_takeEnvOffset = GetMediaItemInfo_Value(GetMediaItemTake_Item(m_take), "D_POSITION");
 }
 
+std::unordered_map<TrackEnvelope*,BR_Envelope::CachedPoints>& BR_Envelope::PointCache ()
+{
+	static std::unordered_map<TrackEnvelope*,BR_Envelope::CachedPoints> s_cache;
+	return s_cache;
+}
+
+int BR_Envelope::s_pointCacheScopes = 0;
+
+BR_Envelope::PointCacheScope::PointCacheScope ()
+{
+	++s_pointCacheScopes;
+}
+
+BR_Envelope::PointCacheScope::~PointCacheScope ()
+{
+	--s_pointCacheScopes;
+}
+
+bool BR_Envelope::BuildFromCache (int count, double playrate)
+{
+	// Cached points stay valid for as long as the state of envelope's project doesn't change. To keep the cache
+	// small, everything gets dropped when the active project changes (that's where edits usually happen anyway)
+	std::unordered_map<TrackEnvelope*,BR_Envelope::CachedPoints>& cache = PointCache();
+	static ReaProject* s_activeProject = NULL;
+	static int s_activeStateCount = -1;
+	ReaProject* activeProject = EnumProjects(-1, NULL, 0);
+	const int activeStateCount = GetProjectStateChangeCount(activeProject);
+	if (activeProject != s_activeProject || activeStateCount != s_activeStateCount)
+	{
+		cache.clear();
+		s_activeProject    = activeProject;
+		s_activeStateCount = activeStateCount;
+	}
+
+	std::unordered_map<TrackEnvelope*,BR_Envelope::CachedPoints>::const_iterator it = cache.find(m_envelope);
+	if (it == cache.end())
+		return false;
+
+	const BR_Envelope::CachedPoints& cached = it->second;
+	ReaProject* project = this->GetProject();
+	if (!project || cached.project != project || cached.stateCount != GetProjectStateChangeCount(project))
+		return false;
+	if (cached.pointCount != count || cached.faderMode != m_properties.faderMode || cached.playrate != playrate)
+		return false;
+
+	double ends[6];
+	this->GetEnds(count, ends);
+	if (memcmp(ends, cached.ends, sizeof(ends)))
+		return false;
+
+	m_points    = BR_Envelope::PointList(cached.points);
+	m_pointsSel = cached.pointsSel;
+	m_chunkProperties.Set(&cached.chunkProperties);
+	return true;
+}
+
+void BR_Envelope::StoreInCache (int count, double playrate)
+{
+	ReaProject* project = this->GetProject();
+	if (!project)
+		return;
+
+	BR_Envelope::CachedPoints& cached = PointCache()[m_envelope];
+	cached.project    = project;
+	cached.stateCount = GetProjectStateChangeCount(project);
+	cached.pointCount = count;
+	cached.faderMode  = m_properties.faderMode;
+	cached.playrate   = playrate;
+	cached.points     = m_points.Share();
+	cached.pointsSel  = m_pointsSel;
+	cached.chunkProperties.Set(&m_chunkProperties);
+	this->GetEnds(count, cached.ends);
+}
+
+ReaProject* BR_Envelope::GetProject ()
+{
+	MediaTrack* track = (m_take) ? (GetMediaItemTake_Track(m_take)) : (m_parent);
+	return (track) ? ((ReaProject*)GetSetMediaTrackInfo(track, "P_PROJECT", NULL)) : (NULL);
+}
+
+void BR_Envelope::GetEnds (int count, double* ends)
+{
+	memset(ends, 0, 6 * sizeof(double));
+	for (int i = 0; i < 2 && count > 0; ++i)
+	{
+		bool selected = false;
+		GetEnvelopePoint(m_envelope, (i == 0) ? (0) : (count - 1), &ends[3*i], &ends[3*i + 1], NULL, NULL, &selected);
+		ends[3*i + 2] = (selected) ? (1) : (0);
+	}
+}
+
+vector<BR_Envelope::EnvPoint>& BR_Envelope::PointList::Edit ()
+{
+	if (m_points.use_count() > 1)
+		m_points = std::make_shared<vector<BR_Envelope::EnvPoint> >(*m_points);
+	return *m_points;
+}
+
 void BR_Envelope::UpdateConsequential ()
 {
 	for (size_t i = 0; i < m_pointsSel.size(); ++i)
@@ -2105,7 +2319,7 @@ bool BR_Envelope::EnvPoint::ReadLine (const LineParser& lp)
 	}
 }
 
-void BR_Envelope::EnvPoint::Append (WDL_FastString& string, bool tempoPoint)
+void BR_Envelope::EnvPoint::Append (WDL_FastString& string, bool tempoPoint) const
 {
 	if (tempoPoint)
 	{
@@ -27,6 +27,9 @@
 ******************************************************************************/
 #pragma once
 
+#include <memory>
+#include <unordered_map>
+
 /******************************************************************************
 * Envelope shapes - this is how Reaper stores point shapes internally         *
 ******************************************************************************/
@@ -112,6 +115,8 @@ public:
 
 	/* Points properties */
 	double ValueAtPosition (double position, bool fastMode = false); // fastMode will not use native API which is more accurate in some cases (noticed it with bezier curves), but much slower with high point count (accuracy difference should be minimal but still important when dealing with things like mouse detection where every pixel counts!)
+	void ValuesAtPositions (double start, double step, int count, double* values); // same as ValueAtPosition() in fastMode for positions start, start+step...but searches for the first point only once and walks segments from there on (much faster when evaluating blocks of samples)
+	double HitTestValue (double position);                                         // same as ValueAtPosition() but only evaluates the segment at position (found with binary search) - native API is used only for bezier segments where fastMode isn't pixel-exact
 	double NormalizedDisplayValue (double value);                    // Convert point value to 0.0 - 1.0 range as displayed in arrange
 	double RealValue (double normalizedDisplayValue);                // Convert normalized display value in range 0.0 - 1.0 to real envelope value
 	double SnapValue (double value);                                 // Snaps value to current settings (only relevant for take pitch envelope)
@@ -166,11 +171,26 @@ public:
 	/* Committing - does absolutely nothing if there are no edits or locking is turned on (unless forced) */
 	bool Commit (bool force = false);
 
+	/* Objects constructed while PointCacheScope exists share points read from the same envelope as long as its project doesn't  *
+	*  change - edits made through the API without an undo point can go unnoticed so use only for read-only stuff (mouse context) */
+	class PointCacheScope
+	{
+	public:
+		PointCacheScope ();
+		~PointCacheScope ();
+	};
+
 private:
 	struct IdPair
 	{
 		int first, second;
 	};
+	struct Segment
+	{
+		int id, shape;
+		double t1, t2, v1, v2; // start and end point (values are normalized in fader mode)
+		double x1, x2, y1, y2; // bezier control points
+	};
 	struct EnvProperties
 	{
 		int active, AIoptions; // automation items options, second ACT token in track env. chunk
@@ -225,7 +245,7 @@ private:
 		explicit EnvPoint (double position);
 		bool operator==(const EnvPoint &) const;
 		bool ReadLine (const LineParser& lp); // use only once per object (for efficiency, tempoStr is never deleted, only appended too)
-		void Append (WDL_FastString& string, bool tempoPoint);
+		void Append (WDL_FastString& string, bool tempoPoint) const;
 		struct ComparePoints
 		{
 			bool operator() (const EnvPoint& first, const EnvPoint& second)
@@ -235,11 +255,48 @@ private:
 		};
 	};
 
+	class PointList // copy-on-write points, shared with copies of the object and the point cache (reading is free, Edit() detaches before any modification)
+	{
+	public:
+		PointList () : m_points(std::make_shared<vector<BR_Envelope::EnvPoint> >()) {}
+		explicit PointList (const std::shared_ptr<vector<BR_Envelope::EnvPoint> >& points) : m_points(points) {}
+		const BR_Envelope::EnvPoint& operator[] (size_t id) const { return (*m_points)[id]; }
+		bool operator== (const PointList& points) const          { return m_points == points.m_points || *m_points == *points.m_points; }
+		bool operator!= (const PointList& points) const          { return !(*this == points); }
+		size_t size () const                                      { return m_points->size(); }
+		bool empty () const                                       { return m_points->empty(); }
+		const BR_Envelope::EnvPoint& back () const                { return m_points->back(); }
+		vector<BR_Envelope::EnvPoint>::const_iterator begin () const { return m_points->begin(); }
+		vector<BR_Envelope::EnvPoint>::const_iterator end () const   { return m_points->end(); }
+		vector<BR_Envelope::EnvPoint>& Edit ();
+		const std::shared_ptr<vector<BR_Envelope::EnvPoint> >& Share () const { return m_points; }
+	private:
+		std::shared_ptr<vector<BR_Envelope::EnvPoint> > m_points;
+	};
+	struct CachedPoints // see BuildFromCache()
+	{
+		ReaProject* project;
+		int stateCount, pointCount, faderMode;
+		double playrate;
+		double ends[6]; // first and last point as returned by the API (position, value, selection) - cheap check for edits that don't change the project state
+		std::shared_ptr<vector<BR_Envelope::EnvPoint> > points;
+		vector<size_t> pointsSel;
+		WDL_FastString chunkProperties;
+	};
+	static std::unordered_map<TrackEnvelope*,BR_Envelope::CachedPoints>& PointCache ();
+	static int s_pointCacheScopes;
+
 	int FindFirstPoint ();
 	int LastPointAtPos (int id);
+	void PrepareSegment (int id, int nextId, bool faderMode, BR_Envelope::Segment* segment);
+	double SegmentValue (const BR_Envelope::Segment& segment, double position, bool faderMode);
 	int FindNext (double position, double offset);     // used for internal stuff since position
 	int FindPrevious (double position, double offset); // offset of take envelopes has to be tracked
 	void Build (bool takeEnvelopesUseProjectTime);
+	bool BuildFromCache (int count, double playrate); // reuses points read by other BR_Envelope objects, see PointCacheScope
+	void StoreInCache (int count, double playrate);
+	ReaProject* GetProject ();
+	void GetEnds (int count, double* ends);
 	void UpdateConsequential ();
 	void FillFxInfo ();
 	bool FillProperties () const; // to make operator== const (yes, m_properties does get modified but only if not cached already)
@@ -258,7 +315,7 @@ private:
 	int m_yOffset;
 	BR_EnvType m_takeEnvType;
 	void* m_data;
-	vector<BR_Envelope::EnvPoint> m_points;
+	BR_Envelope::PointList m_points;
 	bool m_rebuildConseq;
 	vector<size_t> m_pointsSel;
 	vector<IdPair> m_pointsConseq;
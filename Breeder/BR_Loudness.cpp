@@ -33,8 +33,11 @@
 #include "../SnM/SnM_Dlg.h"
 #include "../SnM/SnM_Util.h"
 #include "../SnM/SnM.h"
+#include "../Utility/ThreadPool.h"
 #include "../libebur128/ebur128.h"
 
+#include <WDL/sha.h>
+
 #include <WDL/localize/localize.h>
 
 /******************************************************************************
@@ -61,9 +64,14 @@ const char* const PREF_WND             = "BR - LoudnessPref WndPos";
 const char* const EXPORT_FORMAT_KEY    = "BR - LoudnessExportFormat";
 const char* const EXPORT_FORMAT_WND    = "BR - LoudnessExportFormat WndPos";
 const char* const EXPORT_FORMAT_RECENT = "BR - LoudnessExportFormat_Pattern_";
+const char* const ANALYZE_THREADS_KEY  = "BR - AnalyzeLoudnessThreads";
+const char* const CACHE_SIZE_KEY       = "BR - LoudnessCacheSize";
+const char* const CACHE_DIR            = "BR_LoudnessCache";
+const char* const CACHE_INDEX          = "index.txt";
 
 const int EXPORT_FORMAT_RECENT_MAX      = 10;
 const int VERSION                       = 1;
+const int CACHE_SIZE_DEFAULT            = 64; // MB
 
 // Export format wildcards
 static const struct
@@ -180,6 +188,8 @@ const int UPDATE_TIMER_FREQ  = 200;
 SNM_WindowManager<BR_AnalyzeLoudnessWnd>                              g_loudnessWndManager(LOUDNESS_WND);
 static SWSProjConfig<WDL_PtrList_DeleteOnDestroy<BR_LoudnessObject> > g_analyzedObjects; // no WDL_PtrList_DOD here (abort analysis)
 static HWND                                                           g_normalizeWnd = NULL;
+static SWS_ThreadPool                                                 g_analyzePool;  // all loudness objects get analyzed here, thread count can be set in ini (0 -> one thread per CPU core)
+static BR_LoudnessCache                                               g_analyzeCache; // analyze results of takes, shared between projects and sessions
 
 /******************************************************************************
 * Loudness object                                                             *
@@ -201,9 +211,9 @@ m_killFlag            (false),
 m_integratedOnly      (false),
 m_doTruePeak          (true),
 m_truePeakAnalyzed    (false),
-m_process             (NULL),
 m_doHighPrecisionMode (true),
-m_doDualMonoMode      (true)
+m_doDualMonoMode      (true),
+m_job                 (-1)
 {
 }
 
@@ -224,9 +234,9 @@ m_killFlag            (false),
 m_integratedOnly      (false),
 m_doTruePeak          (true),
 m_truePeakAnalyzed    (false),
-m_process             (NULL),
 m_doHighPrecisionMode (true),
-m_doDualMonoMode      (true)
+m_doDualMonoMode      (true),
+m_job                 (-1)
 {
 	this->CheckSetAudioData();
 }
@@ -248,9 +258,9 @@ m_killFlag            (false),
 m_integratedOnly      (false),
 m_doTruePeak          (true),
 m_truePeakAnalyzed    (false),
-m_process             (NULL),
 m_doHighPrecisionMode (true),
-m_doDualMonoMode      (true)
+m_doDualMonoMode      (true),
+m_job                 (-1)
 {
 	this->CheckSetAudioData();
 }
@@ -279,9 +289,28 @@ bool BR_LoudnessObject::Analyze (bool integratedOnly, bool doTruePeak, bool doHi
 
 		if (!analyzed)
 		{
-			this->SetRunning(true);
-			this->SetProgress(0);
-			this->SetProcess((HANDLE)_beginthreadex(NULL, 0, this->AnalyzeData, (void*)this, 0, NULL));
+			WDL_FastString cacheKey;
+			this->BuildCacheKey(&cacheKey);
+			this->SetCacheKey(cacheKey.Get());
+
+			// Same media with the same settings was already analyzed (possibly in another project)
+			BR_LoudnessCache::Data cached;
+			if (cacheKey.GetLength() && g_analyzeCache.Load(cacheKey.Get(), &cached))
+			{
+				this->SetAnalyzeData(cached.integrated, cached.range, cached.truePeak, cached.truePeakPos, cached.shortTermMax, cached.momentaryMax, cached.shortTermValues, cached.momentaryValues);
+				if (!integratedOnly && doTruePeak)
+					this->SetTruePeakAnalyzed(true);
+				if (!integratedOnly)
+					this->SetAnalyzedStatus(true);
+				this->SetProgress(1);
+				this->SetRunning(false);
+			}
+			else
+			{
+				this->SetRunning(true); // queued jobs count as running too so callers can wait for them as usual
+				this->SetProgress(0);
+				this->SetJob(g_analyzePool.Submit(this->AnalyzeData, (void*)this));
+			}
 		}
 		return true;
 	}
@@ -297,14 +326,17 @@ bool BR_LoudnessObject::Analyze (bool integratedOnly, bool doTruePeak, bool doHi
 
 void BR_LoudnessObject::AbortAnalyze ()
 {
-	if (this->GetProcess())
+	if (this->GetJob() != -1)
 	{
-		this->SetKillFlag(true);
-		WaitForSingleObject(this->GetProcess(), INFINITE);
-		this->SetKillFlag(false);
-		CloseHandle(this->GetProcess());
+		// Job still waiting in the queue can simply be removed, otherwise signal it to stop and wait for it
+		if (!g_analyzePool.Cancel(this->GetJob()))
+		{
+			this->SetKillFlag(true);
+			g_analyzePool.Wait(this->GetJob());
+			this->SetKillFlag(false);
+		}
 
-		this->SetProcess(NULL);
+		this->SetJob(-1);
 		this->SetRunning(false);
 		this->SetProgress(0);
 	}
@@ -1121,6 +1153,24 @@ unsigned WINAPI BR_LoudnessObject::AnalyzeData (void* loudnessObject)
 	int processedSamples = 0;
 	int i = 0;
 
+	// Buffers are allocated once and reused for every block (last block can only be shorter)
+	vector<double> samples(bufSz);
+	vector<double> gain(sampleCount);
+	vector<double> envGain(sampleCount);
+
+	// Pan fader (takes only) doesn't change over time so get per-channel gain once
+	vector<double> channelGain(data.channels, 1.0);
+	if (doPan)
+	{
+		for (int channel = 0; channel < data.channels; ++channel)
+		{
+			if (data.pan > 0 && (channel % 2 == 0))
+				channelGain[channel] = 1 - data.pan; // takes have no pan law!
+			else if (data.pan < 0 && (channel % 2 == 1))
+				channelGain[channel] = 1 + data.pan;
+		}
+	}
+
 	while (currentTime < data.audioEnd && !_this->GetKillFlag())
 	{
 		// Make sure we always fill our buffer exactly to audio end (and skip momentary/short-term intervals if not enough new samples)
@@ -1131,46 +1181,62 @@ unsigned WINAPI BR_LoudnessObject::AnalyzeData (void* loudnessObject)
 			sampleCount = static_cast<int>(data.samplerate * remainingTime);
 			bufSz = sampleCount * data.channels;
 			skipIntervals = true;
+
+			if (sampleCount > (int)gain.size()) // rounding safety
+			{
+				samples.resize(bufSz);
+				gain.resize(sampleCount);
+				envGain.resize(sampleCount);
+			}
 		}
 
 		// Get new 200 ms (or 10 ms in high precision mode) of samples
 		// GetAudioAccessorSamples() stops writing to the buffer once it reaches the item's end, everything from that point to sampleCount is garbage
-		std::vector<double> samples(bufSz);
+		// so clear the buffer first (otherwise we'd get samples from the previous block there)
+		std::fill(samples.begin(), samples.begin() + bufSz, 0.0);
 		GetAudioAccessorSamples(data.audio, data.samplerate, data.channels, currentTime, sampleCount, &samples[0]);
 
-		// Correct for volume and pan/volume envelopes
-		int currentChannel = 1;
-		double sampleTime = currentTime;
-
-		for (double &sample : samples)
+		// Correct for volume and pan/volume envelopes: get gain for each sample frame in the block first...
+		std::fill(gain.begin(), gain.begin() + sampleCount, data.volume);
+		if (doVolPreFXEnv)
 		{
-			double adjust = 1;
-
-			// Volume envelopes
-			if (doVolPreFXEnv)
-				adjust *= data.volEnvPreFX.ValueAtPosition(sampleTime, true);
-			if (doVolEnv) 
-				adjust *= data.volEnv.ValueAtPosition(sampleTime + itemPos, true);
-
-			// Volume fader
-			adjust *= data.volume;
+			data.volEnvPreFX.ValuesAtPositions(currentTime, sampleTimeLen, sampleCount, &envGain[0]);
+			for (int frame = 0; frame < sampleCount; ++frame)
+				gain[frame] *= envGain[frame];
+		}
+		if (doVolEnv)
+		{
+			data.volEnv.ValuesAtPositions(currentTime + itemPos, sampleTimeLen, sampleCount, &envGain[0]);
+			for (int frame = 0; frame < sampleCount; ++frame)
+				gain[frame] *= envGain[frame];
+		}
 
-			// Pan fader (takes only)
-			if (doPan)
+		// ...and then apply it to interleaved samples (kept branchless so compiler can vectorize it)
+		if (doPan)
+		{
+			for (int frame = 0; frame < sampleCount; ++frame)
 			{
-				if (data.pan > 0 && (currentChannel % 2 == 1))
-					adjust *= 1 - data.pan; // takes have no pan law!
-				else if (data.pan < 0 && (currentChannel % 2 == 0))
-					adjust *= 1 + data.pan;
+				double* frameSamples = &samples[frame * data.channels];
+				for (int channel = 0; channel < data.channels; ++channel)
+					frameSamples[channel] *= gain[frame] * channelGain[channel];
+			}
+		}
+		else if (data.channels == 2)
+		{
+			for (int frame = 0; frame < sampleCount; ++frame)
+			{
+				samples[2*frame]     *= gain[frame];
+				samples[2*frame + 1] *= gain[frame];
+			}
+		}
+		else
+		{
+			for (int frame = 0; frame < sampleCount; ++frame)
+			{
+				double* frameSamples = &samples[frame * data.channels];
+				for (int channel = 0; channel < data.channels; ++channel)
+					frameSamples[channel] *= gain[frame];
 			}
-
-			sample *= adjust;
-
-			if (++currentChannel > data.channels)
-				currentChannel = 1;
-
-			if (currentChannel + 1 > data.channels)
-				sampleTime = sampleTime + sampleTimeLen;
 		}
 
 		ebur128_add_frames_double(loudnessState, &samples[0], sampleCount);
@@ -1254,6 +1320,21 @@ unsigned WINAPI BR_LoudnessObject::AnalyzeData (void* loudnessObject)
 	// Write analyze data
 	if (!_this->GetKillFlag())
 	{
+		WDL_FastString cacheKey = _this->GetCacheKey();
+		if (cacheKey.GetLength())
+		{
+			BR_LoudnessCache::Data cached;
+			cached.integrated      = integrated;
+			cached.range           = range;
+			cached.truePeak        = truePeak;
+			cached.truePeakPos     = truePeakPos;
+			cached.shortTermMax    = shortTermMax;
+			cached.momentaryMax    = momentaryMax;
+			cached.shortTermValues = shortTermValues;
+			cached.momentaryValues = momentaryValues;
+			g_analyzeCache.Store(cacheKey.Get(), cached);
+		}
+
 		_this->SetAnalyzeData(integrated, range, truePeak, truePeakPos, shortTermMax, momentaryMax, shortTermValues, momentaryValues);
 		_this->SetProgress(1);
 		_this->SetRunning(false);
@@ -1471,16 +1552,73 @@ bool BR_LoudnessObject::GetKillFlag ()
 	return m_killFlag;
 }
 
-void BR_LoudnessObject::SetProcess (HANDLE process)
+void BR_LoudnessObject::SetJob (int job)
+{
+	SWS_SectionLock lock(&m_mutex);
+	m_job = job;
+}
+
+int BR_LoudnessObject::GetJob ()
 {
 	SWS_SectionLock lock(&m_mutex);
-	m_process = process;
+	return m_job;
 }
 
-HANDLE BR_LoudnessObject::GetProcess ()
+bool BR_LoudnessObject::BuildCacheKey (WDL_FastString* key)
+{
+	key->Set("");
+
+	// Only takes get cached - their audio is fully determined by the source file and take/item properties below. Track
+	// audio depends on everything in the project (items, FX, routing...) so there is nothing to safely identify it with
+	MediaItem_Take* take = this->GetTake();
+	if (!take || !g_analyzeCache.IsEnabled())
+		return false;
+
+	char fileName[SNM_MAX_PATH] = "";
+	if (PCM_source* source = GetMediaItemTake_Source(take))
+		GetMediaSourceFileName(source, fileName, sizeof(fileName));
+	if (!*fileName)
+		return false;
+
+	struct stat fileStat;
+#ifdef _WIN32
+	if (statUTF8(fileName, &fileStat) != 0)
+#else
+	if (stat(fileName, &fileStat) != 0)
+#endif
+		return false;
+
+	BR_LoudnessObject::AudioData data = this->GetAudioData();
+	key->SetFormatted((int)strlen(fileName) + 512, "%s|%lld|%lld|%s|%.14g|%.14g|%d|%d|%d|%.14g|%.14g|%d%d%d%d",
+		fileName, (long long)fileStat.st_mtime, (long long)fileStat.st_size, data.audioHash,
+		data.audioStart, data.audioEnd, data.channels, data.channelMode, data.samplerate, data.volume, data.pan,
+		this->GetIntegratedOnly(), this->GetDoTruePeak(), this->GetDoHighPrecisionMode(), this->GetDoDualMonoMode()
+	);
+
+	// Take volume envelope gets evaluated in project time (see AnalyzeData()) so item position matters too
+	if (data.volEnv.CountPoints() && data.volEnv.IsActive())
+	{
+		key->AppendFormatted(128, "|%.14g", GetMediaItemInfo_Value(this->GetItem(), "D_POSITION"));
+		for (int i = 0; i < data.volEnv.CountPoints(); ++i)
+		{
+			double position, value, bezier; int shape;
+			data.volEnv.GetPoint(i, &position, &value, &shape, &bezier);
+			key->AppendFormatted(128, "|%.14g %.14g %d %.14g", position, value, shape, bezier);
+		}
+	}
+	return true;
+}
+
+void BR_LoudnessObject::SetCacheKey (const char* key)
+{
+	SWS_SectionLock lock(&m_mutex);
+	m_cacheKey.Set(key);
+}
+
+WDL_FastString BR_LoudnessObject::GetCacheKey ()
 {
 	SWS_SectionLock lock(&m_mutex);
-	return m_process;
+	return m_cacheKey;
 }
 
 WDL_FastString BR_LoudnessObject::GetTakeName ()
@@ -1590,6 +1728,263 @@ pan          (0)
 	memset(audioHash, 0, 128);
 }
 
+/******************************************************************************
+* Loudness analyze progress                                                   *
+******************************************************************************/
+BR_LoudnessProgress::BR_LoudnessProgress () :
+m_totalLength (0)
+{
+}
+
+void BR_LoudnessProgress::Add (BR_LoudnessObject* object)
+{
+	if (object && !m_lengths.count(object))
+	{
+		double length = max(object->GetAudioLength(), 0.0);
+		m_lengths[object] = length;
+		m_totalLength += length;
+	}
+}
+
+void BR_LoudnessProgress::Clear ()
+{
+	m_lengths.clear();
+	m_totalLength = 0;
+}
+
+double BR_LoudnessProgress::Get (WDL_PtrList<BR_LoudnessObject>* objects)
+{
+	if (m_totalLength <= 0)
+		return 0;
+
+	// Start from everything finished and subtract whatever is still left to analyze
+	double finishedLength = m_totalLength;
+	for (int i = 0; objects && i < objects->GetSize(); ++i)
+	{
+		BR_LoudnessObject* object = objects->Get(i);
+		map<BR_LoudnessObject*,double>::iterator it = m_lengths.find(object);
+		if (it != m_lengths.end() && object->IsRunning())
+			finishedLength -= it->second * (1 - object->GetProgress());
+	}
+	return finishedLength / m_totalLength;
+}
+
+/******************************************************************************
+* Loudness analysis cache                                                     *
+******************************************************************************/
+BR_LoudnessCache::BR_LoudnessCache () :
+m_maxSize      ((WDL_INT64)CACHE_SIZE_DEFAULT << 20),
+m_size         (0),
+m_lastUse      (0),
+m_indexLoaded  (false),
+m_indexChanged (false)
+{
+}
+
+void BR_LoudnessCache::SetMaxSize (int maxSizeMB)
+{
+	SWS_SectionLock lock(&m_mutex);
+	m_maxSize = (WDL_INT64)max(maxSizeMB, 0) << 20;
+	if (m_indexLoaded)
+		this->Evict();
+}
+
+bool BR_LoudnessCache::IsEnabled ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	return m_maxSize > 0;
+}
+
+bool BR_LoudnessCache::Load (const char* key, BR_LoudnessCache::Data* data)
+{
+	SWS_SectionLock lock(&m_mutex);
+	if (m_maxSize <= 0)
+		return false;
+	this->LoadIndex();
+
+	char hash[WDL_SHA1SIZE*2 + 1];
+	BR_LoudnessCache::HashKey(key, hash, sizeof(hash));
+	map<string,BR_LoudnessCache::Entry>::iterator it = m_entries.find(hash);
+	if (it == m_entries.end())
+		return false;
+
+	data->shortTermValues.clear();
+	data->momentaryValues.clear();
+	bool measurements = false;
+
+	if (FILE* f = fopenUTF8(this->GetPath(hash).Get(), "r"))
+	{
+		char line[SNM_MAX_CHUNK_LINE_LENGTH];
+		LineParser lp(false);
+		while (fgets(line, sizeof(line), f) && !lp.parse(line))
+		{
+			if (!strcmp(lp.gettoken_str(0), PROJ_OBJECT_KEY_MEASUREMENTS) && lp.getnumtokens() == 7)
+			{
+				data->integrated   = lp.gettoken_float(1);
+				data->range        = lp.gettoken_float(2);
+				data->truePeak     = lp.gettoken_float(3);
+				data->truePeakPos  = lp.gettoken_float(4);
+				data->shortTermMax = lp.gettoken_float(5);
+				data->momentaryMax = lp.gettoken_float(6);
+				measurements = true;
+			}
+			else if (!strcmp(lp.gettoken_str(0), PROJ_OBJECT_KEY_SHORT_TERM))
+			{
+				for (int i = 1; i < lp.getnumtokens(); ++i)
+					data->shortTermValues.push_back(lp.gettoken_float(i));
+			}
+			else if (!strcmp(lp.gettoken_str(0), PROJ_OBJECT_KEY_MOMENTARY))
+			{
+				for (int i = 1; i < lp.getnumtokens(); ++i)
+					data->momentaryValues.push_back(lp.gettoken_float(i));
+			}
+		}
+		fclose(f);
+	}
+
+	// File got deleted or damaged behind our back
+	if (!measurements)
+	{
+		m_size -= it->second.size;
+		m_entries.erase(it);
+		m_indexChanged = true;
+		return false;
+	}
+
+	it->second.lastUse = ++m_lastUse;
+	m_indexChanged = true;
+	return true;
+}
+
+void BR_LoudnessCache::Store (const char* key, const BR_LoudnessCache::Data& data)
+{
+	WDL_FastString buffer;
+	buffer.AppendFormatted(512, "%s %.10f %.10f %.10f %.10f %.10f %.10f\n", PROJ_OBJECT_KEY_MEASUREMENTS, data.integrated, data.range, data.truePeak, data.truePeakPos, data.shortTermMax, data.momentaryMax);
+	for (size_t i = 0; i < data.shortTermValues.size(); ++i)
+	{
+		if (i % 10 == 0) buffer.Append(PROJ_OBJECT_KEY_SHORT_TERM);
+		buffer.AppendFormatted(128, " %.10f", data.shortTermValues[i]);
+		if (i % 10 == 9 || i == data.shortTermValues.size() - 1) buffer.Append("\n");
+	}
+	for (size_t i = 0; i < data.momentaryValues.size(); ++i)
+	{
+		if (i % 10 == 0) buffer.Append(PROJ_OBJECT_KEY_MOMENTARY);
+		buffer.AppendFormatted(128, " %.10f", data.momentaryValues[i]);
+		if (i % 10 == 9 || i == data.momentaryValues.size() - 1) buffer.Append("\n");
+	}
+
+	SWS_SectionLock lock(&m_mutex);
+	if (m_maxSize <= 0 || buffer.GetLength() > m_maxSize)
+		return;
+	this->LoadIndex();
+
+	char hash[WDL_SHA1SIZE*2 + 1];
+	BR_LoudnessCache::HashKey(key, hash, sizeof(hash));
+
+	WDL_FastString path = this->GetPath();
+	CreateDirectory(path.Get(), NULL);
+
+	FILE* f = fopenUTF8(this->GetPath(hash).Get(), "w");
+	if (!f)
+		return;
+	fputs(buffer.Get(), f);
+	fclose(f);
+
+	BR_LoudnessCache::Entry& entry = m_entries[hash];
+	m_size += buffer.GetLength() - entry.size;
+	entry.size = buffer.GetLength();
+	entry.lastUse = ++m_lastUse;
+	m_indexChanged = true;
+
+	this->Evict();
+	this->SaveIndex();
+}
+
+void BR_LoudnessCache::SaveIndex ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	if (!m_indexChanged)
+		return;
+
+	WDL_FastString buffer;
+	for (map<string,BR_LoudnessCache::Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+		buffer.AppendFormatted(256, "%s %lld %u\n", it->first.c_str(), (long long)it->second.size, it->second.lastUse);
+
+	if (FILE* f = fopenUTF8(this->GetPath(CACHE_INDEX).Get(), "w"))
+	{
+		fputs(buffer.Get(), f);
+		fclose(f);
+		m_indexChanged = false;
+	}
+}
+
+void BR_LoudnessCache::LoadIndex ()
+{
+	if (m_indexLoaded)
+		return;
+	m_indexLoaded = true;
+
+	if (FILE* f = fopenUTF8(this->GetPath(CACHE_INDEX).Get(), "r"))
+	{
+		char line[256];
+		LineParser lp(false);
+		while (fgets(line, sizeof(line), f))
+		{
+			if (lp.parse(line) || lp.getnumtokens() != 3)
+				continue;
+
+			BR_LoudnessCache::Entry entry;
+			entry.size    = (WDL_INT64)lp.gettoken_float(1);
+			entry.lastUse = lp.gettoken_uint(2);
+			m_entries[lp.gettoken_str(0)] = entry;
+			m_size += entry.size;
+			m_lastUse = max(m_lastUse, entry.lastUse);
+		}
+		fclose(f);
+	}
+	this->Evict();
+}
+
+void BR_LoudnessCache::Evict ()
+{
+	// Remove least recently used entries until we're within limits
+	while (m_size > m_maxSize && !m_entries.empty())
+	{
+		map<string,BR_LoudnessCache::Entry>::iterator oldest = m_entries.begin();
+		for (map<string,BR_LoudnessCache::Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+		{
+			if (it->second.lastUse < oldest->second.lastUse)
+				oldest = it;
+		}
+
+		SNM_DeleteFile(this->GetPath(oldest->first.c_str()).Get(), false);
+		m_size -= oldest->second.size;
+		m_entries.erase(oldest);
+		m_indexChanged = true;
+	}
+}
+
+WDL_FastString BR_LoudnessCache::GetPath (const char* fileName /*=NULL*/)
+{
+	WDL_FastString path;
+	path.SetFormatted(SNM_MAX_PATH, "%s%c%s", GetResourcePath(), PATH_SLASH_CHAR, CACHE_DIR);
+	if (fileName)
+		path.AppendFormatted(SNM_MAX_PATH, "%c%s", PATH_SLASH_CHAR, fileName);
+	return path;
+}
+
+void BR_LoudnessCache::HashKey (const char* key, char* hash, int hashSz)
+{
+	WDL_SHA1 sha;
+	sha.add(key, (int)strlen(key));
+
+	char digest[WDL_SHA1SIZE];
+	sha.result(digest);
+
+	for (int i = 0; i < WDL_SHA1SIZE && (i+1)*2 < hashSz; ++i)
+		snprintf(hash + i*2, 3, "%02x", (unsigned char)digest[i]);
+}
+
 /******************************************************************************
 * Loudness preferences                                                        *
 ******************************************************************************/
@@ -2007,14 +2402,9 @@ static WDL_DLGRET NormalizeProgressProc (HWND hwnd, UINT uMsg, WPARAM wParam, LP
 	if (INT_PTR r = SNM_HookThemeColorsMessage(hwnd, uMsg, wParam, lParam))
 		return r;
 
-	static BR_NormalizeData* s_normalizeData = NULL;
-	static BR_LoudnessObject* s_currentItem  = NULL;
-
-	static int  s_currentItemId      = 0;
-	static bool s_analyzeInProgress  = false;
-	static double s_itemsLen         = 0;
-	static double s_currentItemLen   = 0;
-	static double s_finishedItemsLen = 0;
+	static BR_NormalizeData*   s_normalizeData = NULL;
+	static BR_LoudnessProgress s_progress;
+	static bool s_analyzeInProgress = false;
 
 	#ifndef _WIN32
 		static bool s_positionSet = false;
@@ -2032,21 +2422,12 @@ static WDL_DLGRET NormalizeProgressProc (HWND hwnd, UINT uMsg, WPARAM wParam, LP
 				return 0;
 			}
 
-			s_currentItem = NULL;
-			s_currentItemId = 0;
 			s_analyzeInProgress = false;
-			s_itemsLen = 0;
-			s_currentItemLen = 0;
-			s_finishedItemsLen = 0;
 
 			// Get progress data
+			s_progress.Clear();
 			for (int i = 0; i < s_normalizeData->items->GetSize(); ++i)
-			{
-				if (BR_LoudnessObject* item = s_normalizeData->items->Get(i))
-					s_itemsLen += item->GetAudioLength();
-			}
-			if (s_itemsLen == 0) s_itemsLen = 1; // to prevent division by zero
-
+				s_progress.Add(s_normalizeData->items->Get(i));
 
 			#ifdef _WIN32
 				CenterDialog(hwnd, g_hwndParent, HWND_TOPMOST);
@@ -2078,9 +2459,15 @@ static WDL_DLGRET NormalizeProgressProc (HWND hwnd, UINT uMsg, WPARAM wParam, LP
 				case IDCANCEL:
 				{
 					KillTimer(hwnd, 1);
+					if (s_normalizeData)
+					{
+						for (int i = 0; i < s_normalizeData->items->GetSize(); ++i)
+						{
+							if (BR_LoudnessObject* item = s_normalizeData->items->Get(i))
+								item->AbortAnalyze();
+						}
+					}
 					s_normalizeData = NULL;
-					if (s_currentItem)
-						s_currentItem->AbortAnalyze();
 					EndDialog(hwnd, 0);
 				}
 				break;
@@ -2093,88 +2480,80 @@ static WDL_DLGRET NormalizeProgressProc (HWND hwnd, UINT uMsg, WPARAM wParam, LP
 			if (!s_normalizeData)
 				return 0;
 
+			// Submit all objects at once, analyze thread pool takes care of how many of them actually run in parallel
 			if (!s_analyzeInProgress)
 			{
-				// No more objects to analyze, normalize them
-				if (s_currentItemId >= s_normalizeData->items->GetSize())
+				// check if user set high precision mode
+				bool doHighPrecisionMode = false;
+				if (!s_normalizeData->quickMode)
 				{
-					bool undoTrack = false;
-					bool undoItem  = false;
-					for (int i = 0; i < s_normalizeData->items->GetSize(); ++i)
-					{
-						if (BR_LoudnessObject* item = s_normalizeData->items->Get(i))
-						{
-							if (item->NormalizeIntegrated(s_normalizeData->targetLufs))
-							{
-								if (!undoTrack && item->IsTrack()) undoTrack = true;
-								if (!undoItem && !item->IsTrack()) undoItem = true;
-							}
-						}
-					}
+					doHighPrecisionMode = !!IsHighPrecisionOptionEnabled(NULL);
+				}
+				bool doDualMonoMode = !!IsDualMonoOptionEnabled(NULL);
 
-					if (undoTrack || undoItem)
-					{
-						if (undoTrack && !undoItem)
-							Undo_OnStateChangeEx2(NULL, __LOCALIZE("Normalize track loudness", "sws_undo"), UNDO_STATE_TRACKCFG, -1);
-						else if (!undoTrack && undoItem)
-							Undo_OnStateChangeEx2(NULL, __LOCALIZE("Normalize item loudness", "sws_undo"), UNDO_STATE_ITEMS, -1);
-						else
-							Undo_OnStateChangeEx2(NULL, __LOCALIZE("Normalize item and track loudness", "sws_undo"), UNDO_STATE_TRACKCFG | UNDO_STATE_ITEMS, -1);
-					}
+				for (int i = 0; i < s_normalizeData->items->GetSize(); ++i)
+				{
+					if (BR_LoudnessObject* item = s_normalizeData->items->Get(i))
+						item->Analyze(s_normalizeData->quickMode, false, doHighPrecisionMode, doDualMonoMode);
+				}
+				s_analyzeInProgress = true;
+			}
 
-					s_normalizeData->normalized = true;
-					UpdateTimeline();
-					EndDialog(hwnd, 0);
+			SendMessage(GetDlgItem(hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(s_progress.Get(s_normalizeData->items)*100), 0);
+
+			for (int i = 0; i < s_normalizeData->items->GetSize(); ++i)
+			{
+				BR_LoudnessObject* item = s_normalizeData->items->Get(i);
+				if (item && item->IsRunning())
 					return 0;
-				}
+			}
 
-				// Start analysis of the next item
-				if ((s_currentItem = s_normalizeData->items->Get(s_currentItemId)))
+			// No more objects to analyze, normalize them
+			bool undoTrack = false;
+			bool undoItem  = false;
+			for (int i = 0; i < s_normalizeData->items->GetSize(); ++i)
+			{
+				if (BR_LoudnessObject* item = s_normalizeData->items->Get(i))
 				{
-					s_currentItemLen = s_currentItem->GetAudioLength();
-
-					// check if user set high precision mode 
-					bool doHighPrecisionMode = false;
-					if (!s_normalizeData->quickMode) 
+					if (item->NormalizeIntegrated(s_normalizeData->targetLufs))
 					{
-						doHighPrecisionMode = !!IsHighPrecisionOptionEnabled(NULL);
-
+						if (!undoTrack && item->IsTrack()) undoTrack = true;
+						if (!undoItem && !item->IsTrack()) undoItem = true;
 					}
-
-					bool doDualMonoMode = !!IsDualMonoOptionEnabled(NULL);
-					s_currentItem->Analyze(s_normalizeData->quickMode, false, doHighPrecisionMode, doDualMonoMode);
-					s_analyzeInProgress = true;
 				}
-				else
-					++s_currentItemId;
 			}
-			else
+
+			if (undoTrack || undoItem)
 			{
-				if (s_currentItem->IsRunning())
-				{
-					double progress = (s_finishedItemsLen + s_currentItemLen * s_currentItem->GetProgress()) / s_itemsLen;
-					SendMessage(GetDlgItem(hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(progress*100), 0);
-				}
+				if (undoTrack && !undoItem)
+					Undo_OnStateChangeEx2(NULL, __LOCALIZE("Normalize track loudness", "sws_undo"), UNDO_STATE_TRACKCFG, -1);
+				else if (!undoTrack && undoItem)
+					Undo_OnStateChangeEx2(NULL, __LOCALIZE("Normalize item loudness", "sws_undo"), UNDO_STATE_ITEMS, -1);
 				else
-				{
-					s_finishedItemsLen += s_currentItemLen;
-					double progress = s_finishedItemsLen / s_itemsLen;
-					SendMessage(GetDlgItem(hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(progress*100), 0);
-
-					s_analyzeInProgress = false;
-					++s_currentItemId;
-				}
+					Undo_OnStateChangeEx2(NULL, __LOCALIZE("Normalize item and track loudness", "sws_undo"), UNDO_STATE_TRACKCFG | UNDO_STATE_ITEMS, -1);
 			}
+
+			s_normalizeData->normalized = true;
+			UpdateTimeline();
+			EndDialog(hwnd, 0);
+			return 0;
 		}
 		break;
 
 		case WM_DESTROY:
 		{
 			KillTimer(hwnd, 1);
+			if (s_normalizeData)
+			{
+				for (int i = 0; i < s_normalizeData->items->GetSize(); ++i)
+				{
+					if (BR_LoudnessObject* item = s_normalizeData->items->Get(i))
+						item->AbortAnalyze();
+				}
+			}
 			s_normalizeData = NULL;
-			if (s_currentItem)
-				s_currentItem->AbortAnalyze();
 			s_analyzeInProgress = false;
+			s_progress.Clear();
 		}
 		break;
 	}
@@ -2280,8 +2659,6 @@ void BR_AnalyzeLoudnessView::OnItemSortEnd ()
 ******************************************************************************/
 BR_AnalyzeLoudnessWnd::BR_AnalyzeLoudnessWnd () :
 SWS_DockWnd(IDD_BR_LOUDNESS_ANALYZER, __LOCALIZE("Loudness", "sws_DLG_174"), ""),
-m_objectsLen        (0),
-m_currentObjectId   (0),
 m_analyzeInProgress (false),
 m_list              (NULL),
 m_normalizeWnd      (NULL),
@@ -2377,24 +2754,27 @@ void BR_AnalyzeLoudnessWnd::AbortAnalyze ()
 {
 	SetAnalyzing(false, false);
 
-	// Make sure objects already in the list are NOT destroyed
+	// Make sure objects already in the list are NOT destroyed (but stop their analysis)
 	for (int i = 0; i < m_analyzeQueue.GetSize(); ++i)
 	{
 		if (g_analyzedObjects.Get()->Find(m_analyzeQueue.Get(i)) != -1)
+		{
+			m_analyzeQueue.Get(i)->AbortAnalyze();
 			m_analyzeQueue.Delete(i--, false);
+		}
 	}
 	m_analyzeQueue.Empty(true);
-	m_objectsLen      = 0;
-	m_currentObjectId = 0;
+	m_progress.Clear();
 }
 
 void BR_AnalyzeLoudnessWnd::AbortReanalyze ()
 {
 	SetAnalyzing(false, true);
 
+	for (int i = 0; i < m_reanalyzeQueue.GetSize(); ++i)
+		m_reanalyzeQueue.Get(i)->AbortAnalyze();
 	m_reanalyzeQueue.Empty(false);
-	m_objectsLen      = 0;
-	m_currentObjectId = 0;
+	m_progress.Clear();
 }
 
 void BR_AnalyzeLoudnessWnd::SetAnalyzing (const bool analyzing, const bool reanalyze)
@@ -3261,10 +3641,7 @@ void BR_AnalyzeLoudnessWnd::OnCommand (WPARAM wParam, LPARAM lParam)
 			if (m_analyzeQueue.GetSize())
 			{
 				for (int i = 0; i < m_analyzeQueue.GetSize(); ++i)
-					m_objectsLen += m_analyzeQueue.Get(i)->GetAudioLength();
-
-				// Prevent division by zero when calculating progress
-				if (m_objectsLen == 0) m_objectsLen = 1;
+					m_progress.Add(m_analyzeQueue.Get(i));
 
 				// Start timer which will analyze each object and finally update the list view
 				SetAnalyzing(true, false);
@@ -3285,10 +3662,7 @@ void BR_AnalyzeLoudnessWnd::OnCommand (WPARAM wParam, LPARAM lParam)
 			if (m_reanalyzeQueue.GetSize())
 			{
 				for (int i = 0; i < m_reanalyzeQueue.GetSize(); ++i)
-					m_objectsLen += m_reanalyzeQueue.Get(i)->GetAudioLength();
-
-				// Prevent division by zero when calculating progress
-				if (m_objectsLen == 0) m_objectsLen = 1;
+					m_progress.Add(m_reanalyzeQueue.Get(i));
 
 				// Start timer which will analyze each object and finally update the list view
 				SetAnalyzing(true, true);
@@ -3595,118 +3969,84 @@ void BR_AnalyzeLoudnessWnd::OnCommand (WPARAM wParam, LPARAM lParam)
 
 void BR_AnalyzeLoudnessWnd::OnTimer (WPARAM wParam)
 {
-	static BR_LoudnessObject* s_currentObject      = NULL;
-	static double             s_currentObjectLen   = 0;
-	static double             s_finishedObjectsLen = 0;
-
 	if (wParam == ANALYZE_TIMER)
 	{
+		// Submit all objects at once, analyze thread pool takes care of how many of them actually run in parallel
 		if (!m_analyzeInProgress)
 		{
-			// New analyze task began, reset variables
-			if (m_currentObjectId == 0)
-				s_finishedObjectsLen = 0;
-
-			if (!m_analyzeQueue.GetSize())
-			{
-				// Make sure list view isn't populated with invalid items (i.e. user could have deleted them during analysis)
-				for (int i = 0; i < g_analyzedObjects.Get()->GetSize(); ++i)
-				{
-					if (BR_LoudnessObject* object = g_analyzedObjects.Get()->Get(i))
-					{
-						if (!object->IsTargetValid())
-							g_analyzedObjects.Get()->Delete(i--, true);
-					}
-				}
-
-				this->Update();
-				SetAnalyzing(false, false);
-
-				return;
-			}
-			else
+			for (int i = 0; i < m_analyzeQueue.GetSize(); ++i)
 			{
-				if ((s_currentObject = m_analyzeQueue.Get(0)))
-				{
-					s_currentObjectLen = s_currentObject->GetAudioLength();
-					s_currentObject->Analyze(false, m_properties.doTruePeak, m_properties.doHighPrecisionMode, m_properties.doDualMonoMode);
-					m_analyzeInProgress = true;
-				}
+				if (BR_LoudnessObject* object = m_analyzeQueue.Get(i))
+					object->Analyze(false, m_properties.doTruePeak, m_properties.doHighPrecisionMode, m_properties.doDualMonoMode);
 				else
-					m_analyzeQueue.Delete(0, true);
-				++m_currentObjectId;
+					m_analyzeQueue.Delete(i--, true);
 			}
+			m_analyzeInProgress = true;
 		}
-		else
+
+		SendMessage(GetDlgItem(m_hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(m_progress.Get(&m_analyzeQueue)*100), 0);
+
+		// Move finished objects to the list view in the order they were queued in (even though they can finish in any order)
+		bool update = false;
+		while (m_analyzeQueue.GetSize() && !m_analyzeQueue.Get(0)->IsRunning())
 		{
-			// Make sure our object is still here
-			double progress = 1;
-			if (m_analyzeQueue.Find(s_currentObject) != -1 && s_currentObject->IsRunning())
-				progress = (s_finishedObjectsLen + s_currentObjectLen * s_currentObject->GetProgress()) / m_objectsLen;
-			else
+			// Sometimes the analyzed object can already be in the list (if option to clear list upon analyzing is disabled)
+			BR_LoudnessObject* object = m_analyzeQueue.Get(0);
+			if (g_analyzedObjects.Get()->Find(object) == -1)
+				g_analyzedObjects.Get()->Add(object);
+			m_analyzeQueue.Delete(0, false);
+			update = true;
+		}
+
+		if (!m_analyzeQueue.GetSize())
+		{
+			// Make sure list view isn't populated with invalid items (i.e. user could have deleted them during analysis)
+			for (int i = 0; i < g_analyzedObjects.Get()->GetSize(); ++i)
 			{
-				if (m_analyzeQueue.Find(s_currentObject) != -1)
+				if (BR_LoudnessObject* object = g_analyzedObjects.Get()->Get(i))
 				{
-					// Sometimes the analyzed object can already be in the list (if option to clear list upon analyzing is disabled)
-					if (g_analyzedObjects.Get()->Find(s_currentObject) == -1)
-						g_analyzedObjects.Get()->Add(s_currentObject);
-					m_analyzeQueue.Delete(m_analyzeQueue.Find(s_currentObject), false);
-					this->Update();
+					if (!object->IsTargetValid())
+						g_analyzedObjects.Get()->Delete(i--, true);
 				}
-
-				s_finishedObjectsLen += s_currentObjectLen;
-				progress = s_finishedObjectsLen / m_objectsLen;
-
-				m_analyzeInProgress = false;
 			}
-			SendMessage(GetDlgItem(m_hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(progress*100), 0);
+
+			this->Update();
+			SetAnalyzing(false, false);
+			m_progress.Clear();
+		}
+		else if (update)
+		{
+			this->Update();
 		}
 	}
 	else if (wParam == REANALYZE_TIMER)
 	{
 		if (!m_analyzeInProgress)
 		{
-			// New analyze task began, reset variables
-			if (m_currentObjectId == 0)
-				s_finishedObjectsLen = 0;
-
-			if (!m_reanalyzeQueue.GetSize())
+			for (int i = 0; i < m_reanalyzeQueue.GetSize(); ++i)
 			{
-				this->Update();
-				SetAnalyzing(false, true);
-				return;
-			}
-			else
-			{
-				if ((s_currentObject = m_reanalyzeQueue.Get(0)))
-				{
-					s_currentObjectLen = s_currentObject->GetAudioLength();
-					s_currentObject->Analyze(false, m_properties.doTruePeak, m_properties.doHighPrecisionMode, m_properties.doDualMonoMode);
-					m_analyzeInProgress = true;
-				}
+				if (BR_LoudnessObject* object = m_reanalyzeQueue.Get(i))
+					object->Analyze(false, m_properties.doTruePeak, m_properties.doHighPrecisionMode, m_properties.doDualMonoMode);
 				else
-					m_reanalyzeQueue.Delete(0, false);
-				++m_currentObjectId;
+					m_reanalyzeQueue.Delete(i--, false);
 			}
+			m_analyzeInProgress = true;
 		}
-		else
+
+		SendMessage(GetDlgItem(m_hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(m_progress.Get(&m_reanalyzeQueue)*100), 0);
+
+		// Objects are already in the list view, no need to keep the order here
+		for (int i = 0; i < m_reanalyzeQueue.GetSize(); ++i)
 		{
-			// Make sure our object is still here (user could have deleted it)
-			if (m_reanalyzeQueue.Find(s_currentObject) != -1 && s_currentObject->IsRunning())
-			{
-				double progress = (s_finishedObjectsLen + s_currentObjectLen * s_currentObject->GetProgress()) / m_objectsLen;
-				SendMessage(GetDlgItem(m_hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(progress*100), 0);
-			}
-			else
-			{
-				if (m_reanalyzeQueue.Find(s_currentObject) != -1)
-					m_reanalyzeQueue.Delete(m_reanalyzeQueue.Find(s_currentObject), false);
+			if (!m_reanalyzeQueue.Get(i)->IsRunning())
+				m_reanalyzeQueue.Delete(i--, false);
+		}
 
-				s_finishedObjectsLen += s_currentObjectLen;
-				double progress = s_finishedObjectsLen / m_objectsLen;
-				SendMessage(GetDlgItem(m_hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(progress*100), 0);
-				m_analyzeInProgress = false;
-			}
+		if (!m_reanalyzeQueue.GetSize())
+		{
+			this->Update();
+			SetAnalyzing(false, true);
+			m_progress.Clear();
 		}
 	}
 	else if (wParam == UPDATE_TIMER)
@@ -3966,12 +4306,15 @@ int LoudnessInitExit (bool init)
 	if (init)
 	{
 		g_pref.LoadGlobalPref();
+		g_analyzePool.SetMaxThreads(GetPrivateProfileInt("SWS", ANALYZE_THREADS_KEY, 0, get_ini_file()));
+		g_analyzeCache.SetMaxSize(GetPrivateProfileInt("SWS", CACHE_SIZE_KEY, CACHE_SIZE_DEFAULT, get_ini_file()));
 		g_loudnessWndManager.Init();
 		return plugin_register("projectconfig", &s_projectconfig);
 	}
 	else
 	{
 		g_pref.SaveGlobalPref();
+		g_analyzeCache.SaveIndex();
 		g_loudnessWndManager.Delete();
 		plugin_register("-projectconfig", &s_projectconfig);
 		return 1;
@@ -4266,13 +4609,8 @@ static WDL_DLGRET NFAnalyzeLUFSProgressProc(HWND hwnd, UINT uMsg, WPARAM wParam,
 		return r;
 
 	static BR_NormalizeData* s_normalizeData = NULL;
-	static BR_LoudnessObject* s_currentItem = NULL;
-
-	static int  s_currentItemId = 0;
+	static BR_LoudnessProgress s_progress;
 	static bool s_analyzeInProgress = false;
-	static double s_itemsLen = 0;
-	static double s_currentItemLen = 0;
-	static double s_finishedItemsLen = 0;
 
 #ifndef _WIN32
 	static bool s_positionSet = false;
@@ -4290,20 +4628,12 @@ static WDL_DLGRET NFAnalyzeLUFSProgressProc(HWND hwnd, UINT uMsg, WPARAM wParam,
 			return 0;
 		}
 
-		s_currentItemId = 0;
 		s_analyzeInProgress = false;
-		s_itemsLen = 0;
-		s_currentItemLen = 0;
-		s_finishedItemsLen = 0;
 
 		// Get progress data
+		s_progress.Clear();
 		for (int i = 0; i < s_normalizeData->items->GetSize(); ++i)
-		{
-			if (BR_LoudnessObject* item = s_normalizeData->items->Get(i))
-				s_itemsLen += item->GetAudioLength();
-		}
-		if (s_itemsLen == 0) s_itemsLen = 1; // to prevent division by zero
-
+			s_progress.Add(s_normalizeData->items->Get(i));
 
 #ifdef _WIN32
 		CenterDialog(hwnd, g_hwndParent, HWND_TOP);
@@ -4335,9 +4665,15 @@ static WDL_DLGRET NFAnalyzeLUFSProgressProc(HWND hwnd, UINT uMsg, WPARAM wParam,
 		case IDCANCEL:
 		{
 			KillTimer(hwnd, 1);
+			if (s_normalizeData)
+			{
+				for (int i = 0; i < s_normalizeData->items->GetSize(); ++i)
+				{
+					if (BR_LoudnessObject* item = s_normalizeData->items->Get(i))
+						item->AbortAnalyze();
+				}
+			}
 			s_normalizeData = NULL;
-			if (s_currentItem)
-				s_currentItem->AbortAnalyze();
 			EndDialog(hwnd, 0);
 		}
 		break;
@@ -4350,63 +4686,55 @@ static WDL_DLGRET NFAnalyzeLUFSProgressProc(HWND hwnd, UINT uMsg, WPARAM wParam,
 		if (!s_normalizeData)
 			return 0;
 
+		// Submit all objects at once, analyze thread pool takes care of how many of them actually run in parallel
 		if (!s_analyzeInProgress)
 		{
-			// No more objects to analyze, normalize them
-			if (s_currentItemId >= s_normalizeData->items->GetSize())
-
-			{
-				s_normalizeData->normalized = true;
-				UpdateTimeline();
-				EndDialog(hwnd, 0);
-				return 0;
-			}
-
-
-			// Start analysis of the next item
-			if ((s_currentItem = s_normalizeData->items->Get(s_currentItemId)))
+			for (int i = 0; i < s_normalizeData->items->GetSize(); ++i)
 			{
-				s_currentItemLen = s_currentItem->GetAudioLength();
-
-				// NF: only use high prec. mode in full analyzing mode (and user has set it in Options), disable in quick mode
-				bool wantHighPrecisionMode = false;
-				if (!s_normalizeData->quickMode)
-					wantHighPrecisionMode = true;
-
-				s_currentItem->Analyze(s_normalizeData->quickMode, s_normalizeData->items->Get(s_currentItemId)->GetDoTruePeak(), wantHighPrecisionMode ? s_normalizeData->items->Get(s_currentItemId)->GetDoHighPrecisionMode() : false, s_normalizeData->items->Get(s_currentItemId)->GetDoDualMonoMode());
+				if (BR_LoudnessObject* item = s_normalizeData->items->Get(i))
+				{
+					// NF: only use high prec. mode in full analyzing mode (and user has set it in Options), disable in quick mode
+					bool wantHighPrecisionMode = false;
+					if (!s_normalizeData->quickMode)
+						wantHighPrecisionMode = true;
 
-				s_analyzeInProgress = true;
+					item->Analyze(s_normalizeData->quickMode, item->GetDoTruePeak(), wantHighPrecisionMode ? item->GetDoHighPrecisionMode() : false, item->GetDoDualMonoMode());
+				}
 			}
-			else
-				++s_currentItemId;
+			s_analyzeInProgress = true;
 		}
-		else
-		{
-			if (s_currentItem->IsRunning())
-			{
-				double progress = (s_finishedItemsLen + s_currentItemLen * s_currentItem->GetProgress()) / s_itemsLen;
-				SendMessage(GetDlgItem(hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(progress * 100), 0);
-			}
-			else
-			{
-				s_finishedItemsLen += s_currentItemLen;
-				double progress = s_finishedItemsLen / s_itemsLen;
-				SendMessage(GetDlgItem(hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(progress * 100), 0);
 
-				s_analyzeInProgress = false;
-				++s_currentItemId;
-			}
+		SendMessage(GetDlgItem(hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(s_progress.Get(s_normalizeData->items) * 100), 0);
+
+		for (int i = 0; i < s_normalizeData->items->GetSize(); ++i)
+		{
+			BR_LoudnessObject* item = s_normalizeData->items->Get(i);
+			if (item && item->IsRunning())
+				return 0;
 		}
+
+		// No more objects to analyze
+		s_normalizeData->normalized = true;
+		UpdateTimeline();
+		EndDialog(hwnd, 0);
+		return 0;
 	}
 	break;
 
 	case WM_DESTROY:
 	{
 		KillTimer(hwnd, 1);
+		if (s_normalizeData)
+		{
+			for (int i = 0; i < s_normalizeData->items->GetSize(); ++i)
+			{
+				if (BR_LoudnessObject* item = s_normalizeData->items->Get(i))
+					item->AbortAnalyze();
+			}
+		}
 		s_normalizeData = NULL;
-		if (s_currentItem)
-			s_currentItem->AbortAnalyze();
 		s_analyzeInProgress = false;
+		s_progress.Clear();
 	}
 	break;
 	}
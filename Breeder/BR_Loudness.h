@@ -114,8 +114,11 @@ private:
 	bool GetTruePeakAnalyzeStatus ();
 	void SetKillFlag (bool killFlag);
 	bool GetKillFlag ();
-	void SetProcess (HANDLE process);
-	HANDLE GetProcess ();
+	void SetJob (int job);
+	int GetJob ();
+	bool BuildCacheKey (WDL_FastString* key); // call from the main thread only, returns false if object can't be cached
+	void SetCacheKey (const char* key);
+	WDL_FastString GetCacheKey ();
 	WDL_FastString GetTakeName ();
 	WDL_FastString GetTrackName ();
 	MediaItem* GetItem ();
@@ -135,12 +138,68 @@ private:
 	double m_integrated, m_truePeak, m_truePeakPos, m_shortTermMax, m_momentaryMax, m_range;
 	double m_progress;
 	bool m_running, m_analyzed, m_killFlag, m_integratedOnly, m_doTruePeak, m_truePeakAnalyzed, m_doHighPrecisionMode, m_doDualMonoMode;
-	HANDLE m_process;
+	int m_job; // id of the job in analyze thread pool
+	WDL_FastString m_cacheKey;
 	SWS_Mutex m_mutex;
 	vector<double> m_shortTermValues;
 	vector<double> m_momentaryValues;
 };
 
+/******************************************************************************
+* Loudness analyze progress                                                   *
+******************************************************************************/
+class BR_LoudnessProgress
+{
+public:
+	BR_LoudnessProgress ();
+	void Add (BR_LoudnessObject* object); // call prior to analyzing (caches audio length used for weighting)
+	void Clear ();
+	double Get (WDL_PtrList<BR_LoudnessObject>* objects); // objects that aren't running or can't be found in the list count as finished
+
+private:
+	map<BR_LoudnessObject*,double> m_lengths;
+	double m_totalLength;
+};
+
+/******************************************************************************
+* Loudness analysis cache                                                     *
+******************************************************************************/
+class BR_LoudnessCache
+{
+public:
+	struct Data
+	{
+		double integrated, range, truePeak, truePeakPos, shortTermMax, momentaryMax;
+		vector<double> shortTermValues;
+		vector<double> momentaryValues;
+	};
+
+	BR_LoudnessCache ();
+	void SetMaxSize (int maxSizeMB); // 0 -> cache disabled
+	bool IsEnabled ();
+	bool Load (const char* key, BR_LoudnessCache::Data* data);
+	void Store (const char* key, const BR_LoudnessCache::Data& data);
+	void SaveIndex ();
+
+private:
+	struct Entry
+	{
+		WDL_INT64 size;
+		unsigned int lastUse;
+	};
+
+	void LoadIndex ();
+	void Evict ();
+	WDL_FastString GetPath (const char* fileName = NULL);
+	static void HashKey (const char* key, char* hash, int hashSz);
+
+	SWS_Mutex m_mutex;
+	map<string,BR_LoudnessCache::Entry> m_entries; // file name -> entry
+	WDL_INT64 m_maxSize, m_size;
+	unsigned int m_lastUse;
+	bool m_indexLoaded, m_indexChanged;
+};
+
 /******************************************************************************
 * Loudness preferences                                                        *
 ******************************************************************************/
@@ -288,8 +347,7 @@ protected:
 		void Load ();
 		void Save ();
 	} m_properties;
-	double m_objectsLen;
-	int m_currentObjectId;
+	BR_LoudnessProgress m_progress;
 	bool m_analyzeInProgress;
 	BR_AnalyzeLoudnessView* m_list;
 	HWND m_normalizeWnd, m_exportFormatWnd;                                          // never delete objects in reanalyzeQueue when removing them from list!!
@@ -525,6 +525,7 @@ pianoRollMode   (-1)
 void BR_MouseInfo::GetContext (const POINT& p)
 {
 	HWND hwnd = WindowFromPoint(p);
+	BR_Envelope::PointCacheScope pointCache; // envelopes are only read here and mouse context gets polled constantly
 
 	BR_MouseInfo::MouseInfo mouseInfo;
 	if (hwnd)
@@ -1239,7 +1240,7 @@ int BR_MouseInfo::IsMouseOverEnvelopeLine (BR_Envelope& envelope, int drawableEn
 		// Not over points, check segment
 		if (!found)
 		{
-			double mouseValue = envelope.ValueAtPosition(mousePos);
+			double mouseValue = (aiId >= 0) ? envelope.ValueAtPosition(mousePos) : envelope.HitTestValue(mousePos); // inside automation items only the native API knows the drawn curve
 			int x = RoundToInt(arrangeZoom * (mousePos - arrangeStart));
 			int y = yOffset + drawableEnvHeight - RoundToInt(envelope.NormalizedDisplayValue(mouseValue) * drawableEnvHeight);
 			if (CheckBounds(mouseDisplayX, x - ENV_HIT_POINT, x + ENV_HIT_POINT) && CheckBounds(mouseY, y - ENV_HIT_POINT, y + ENV_HIT_POINT_DOWN))
@@ -292,8 +292,18 @@ bool BR_GetMediaItemImageResource (MediaItem* item, char* imageOut, int imageOut
 		char image[SNM_MAX_PATH]      = "";
 		char imageFlags[SNM_MAX_PATH] = "0";
 
-		resourceFound =  !!p.Parse(SNM_GET_CHUNK_CHAR, 1, "ITEM", "RESOURCEFN",       0, 1, image,      NULL, "VOLPAN");
-		if (resourceFound) p.Parse(SNM_GET_CHUNK_CHAR, 1, "ITEM", "IMGRESOURCEFLAGS", 0, 1, imageFlags, NULL, "VOLPAN");
+		SNM_ChunkQuery queries[2] = {
+			SNM_ChunkQuery(1, "ITEM", "RESOURCEFN",       0, 1, "VOLPAN"),
+			SNM_ChunkQuery(1, "ITEM", "IMGRESOURCEFLAGS", 0, 1, "VOLPAN")
+		};
+		p.ParseQueries(queries, 2);
+
+		resourceFound = queries[0].Found();
+		if (resourceFound)
+		{
+			queries[0].GetToken(p.GetChunk()->Get(), image,      sizeof(image));
+			queries[1].GetToken(p.GetChunk()->Get(), imageFlags, sizeof(imageFlags));
+		}
 
 		if (imageOut && imageOut_sz > 0) snprintf(imageOut, imageOut_sz, "%s", image);
 		WritePtr(imageFlagsOut, atoi(imageFlags));
@@ -323,12 +333,8 @@ MediaTrack* BR_GetMediaTrackByGUID (ReaProject* proj, const char* guidStringIn)
 	{
 		GUID guid;
 		stringToGuid(guidStringIn, &guid);
-		for (int i = 0; i < CountTracks(proj); ++i)
-		{
-			MediaTrack* track = GetTrack(proj, i);
-			if (GuidsEqual(&guid, TrackToGuid(proj, track)))
-				return track;
-		}
+		if (!GuidsEqual(&guid, &GUID_NULL)) // GUID_NULL would return the master track
+			return GuidToTrack(proj, &guid);
 	}
 	return NULL;
 }
@@ -35,6 +35,7 @@
 #include "../SnM/SnM_Util.h"
 
 #include <../cfillion/flat_set.hpp>
+#include <unordered_map>
 #include <WDL/localize/localize.h>
 #include <WDL/projectcontext.h>
 
@@ -719,7 +720,223 @@ void OpenAutoColor(COMMAND_T*)
 	g_pACWnd->Show(true, true);
 }
 
-void ApplyColorRuleToTrack(FlatSet<SWS_RuleTrack> *activeRules, SWS_RuleItem* rule, bool bDoColors, bool bDoIcons, bool bDoLayout, bool bForce)
+// Track rule compiled for a pass (filter type resolved once instead of strcmp() per track)
+struct SWS_CompiledRule
+{
+	SWS_RuleItem* rule;
+	int iKind;              // AC_* filter type, -1 for name filters
+	std::string sLCFilter;  // lowercase name filter
+
+	// Copy of the rule definition as of the pass
+	int iColor;
+	std::string sIcon, sLayout[2];
+
+	// Same rule definition (an equal pass with equal tracks is a no-op)
+	bool operator==(const SWS_CompiledRule& o) const
+	{
+		return rule == o.rule && iKind == o.iKind && sLCFilter == o.sLCFilter && iColor == o.iColor &&
+			sIcon == o.sIcon && sLayout[0] == o.sLayout[0] && sLayout[1] == o.sLayout[1];
+	}
+};
+
+// Track attributes read once per pass, index 0 is the master track
+struct SWS_TrackAttr
+{
+	SWS_TrackAttr() : tr(NULL), iFolder(0), iRecArm(0), iRecInput(-1), iMidiHwOut(-1), iColor(0), iVis(0),
+		bChild(false), bReceive(false), bVcaMaster(false), bHwOut(false), bInstrument(false) {}
+
+	MediaTrack* tr;
+	std::string sLCName;
+	int iFolder, iRecArm, iRecInput, iMidiHwOut;
+	int iColor, iVis;                 // iVis: &1=tcp, &2=mcp
+	std::string sIcon, sLayout[2];
+	bool bChild, bReceive, bVcaMaster, bHwOut, bInstrument;
+
+	// Attributes rules are matched against
+	bool SameFilterAttrs(const SWS_TrackAttr& o) const
+	{
+		return tr == o.tr && sLCName == o.sLCName && iFolder == o.iFolder && bChild == o.bChild && bReceive == o.bReceive &&
+			iRecArm == o.iRecArm && bVcaMaster == o.bVcaMaster && iRecInput == o.iRecInput && bHwOut == o.bHwOut &&
+			bInstrument == o.bInstrument && iMidiHwOut == o.iMidiHwOut;
+	}
+	// Attributes rules are applied to
+	bool SameState(const SWS_TrackAttr& o) const
+	{
+		return iColor == o.iColor && iVis == o.iVis && sIcon == o.sIcon && sLayout[0] == o.sLayout[0] && sLayout[1] == o.sLayout[1];
+	}
+};
+
+// Last pass, per project
+class SWS_AutoColorPass
+{
+public:
+	SWS_AutoColorPass() : m_bValid(false), m_iFlags(0), m_crGradStart(0), m_crGradEnd(0) { memset(m_custColors, 0, sizeof(m_custColors)); }
+
+	bool m_bValid;
+	int m_iFlags; // &1=colors, &2=icons, &4=layouts
+	std::vector<SWS_CompiledRule> m_rules;
+	std::vector<SWS_TrackAttr> m_tracks;
+	std::vector<char> m_matches; // rule major: m_matches[rule*m_tracks.size()+track]
+	COLORREF m_custColors[16], m_crGradStart, m_crGradEnd;
+};
+
+static SWSProjConfig<SWS_AutoColorPass> g_pACPass;
+
+static void CompileTrackRules(std::vector<SWS_CompiledRule>* rules, int* iFilterMask)
+{
+	*iFilterMask = 0;
+	rules->clear();
+	for (int i = 0; i < g_pACItems.GetSize(); i++)
+	{
+		SWS_RuleItem* rule = g_pACItems.Get(i);
+		if (rule->m_type != AC_TRACK)
+			continue;
+
+		SWS_CompiledRule cr;
+		cr.rule = rule;
+		cr.iKind = -1;
+		for (int j = 0; j < NUM_FILTERTYPES; j++)
+			if (!strcmp(rule->m_str_filter.Get(), cFilterTypes[j]))
+			{
+				cr.iKind = j;
+				break;
+			}
+		// (master) is a name filter for other tracks, see MatchTrackRule()
+		if (cr.iKind < 0 || cr.iKind == AC_MASTER)
+		{
+			cr.sLCFilter.assign(rule->m_str_filter.Get());
+			for (size_t j = 0; j < cr.sLCFilter.size(); j++)
+				cr.sLCFilter[j] = (char)tolower((unsigned char)cr.sLCFilter[j]);
+		}
+		cr.iColor = rule->m_color;
+		cr.sIcon.assign(rule->m_icon.Get());
+		cr.sLayout[0].assign(rule->m_layout[0].Get());
+		cr.sLayout[1].assign(rule->m_layout[1].Get());
+		*iFilterMask |= 1 << (cr.iKind < 0 || cr.iKind == AC_MASTER ? NUM_FILTERTYPES : cr.iKind);
+		rules->push_back(cr);
+	}
+}
+
+// Reads the track attributes rules are applied to (iFlags: &1=colors, &2=icons, &4=layouts)
+static void GetTrackState(SWS_TrackAttr* t, int iFlags)
+{
+	t->iColor = (iFlags & 1) ? *(int*)GetSetMediaTrackInfo(t->tr, "I_CUSTOMCOLOR", NULL) : 0;
+	const char* cur = (iFlags & 2) ? (const char*)GetSetMediaTrackInfo(t->tr, "P_ICON", NULL) : NULL;
+	t->sIcon.assign(cur ? cur : "");
+	t->iVis = 0;
+	for (int k = 0; k < 2; k++)
+	{
+		cur = (iFlags & 4) ? (const char*)GetSetMediaTrackInfo(t->tr, k ? "P_MCP_LAYOUT" : "P_TCP_LAYOUT", NULL) : NULL;
+		t->sLayout[k].assign(cur ? cur : "");
+		if ((iFlags & 4) && IsTrackVisible(t->tr, k ? true : false))
+			t->iVis |= 1 << k;
+	}
+}
+
+// Reads the track attributes needed by rules (iFilterMask, see CompileTrackRules()) and the ones they're applied to
+static void GetTrackAttrs(std::vector<SWS_TrackAttr>* tracks, int iFilterMask, int iFlags)
+{
+	const int numTracks = GetNumTracks();
+	tracks->resize(numTracks + 1);
+	int iDepth = 0;
+	for (int i = 0; i <= numTracks; i++)
+	{
+		SWS_TrackAttr& t = (*tracks)[i];
+		t = SWS_TrackAttr();
+		t.tr = i ? GetTrack(nullptr, i - 1) : GetMasterTrack(nullptr);
+		GetTrackState(&t, iFlags);
+
+		if (!i) // ignore master for most things
+			continue;
+
+		// Folder depth before this track, as GetFolderDepth()
+		t.iFolder = *(int*)GetSetMediaTrackInfo(t.tr, "I_FOLDERDEPTH", NULL);
+		t.bChild = iDepth >= 1;
+		iDepth += t.iFolder;
+
+		if (iFilterMask & ((1 << AC_UNNAMED) | (1 << NUM_FILTERTYPES)))
+		{
+			const char* cName = (const char*)GetSetMediaTrackInfo(t.tr, "P_NAME", NULL);
+			t.sLCName.assign(cName ? cName : "");
+			for (size_t j = 0; j < t.sLCName.size(); j++)
+				t.sLCName[j] = (char)tolower((unsigned char)t.sLCName[j]);
+		}
+		if (iFilterMask & (1 << AC_RECEIVE))
+			t.bReceive = GetSetTrackSendInfo(t.tr, -1, 0, "P_SRCTRACK", NULL) != NULL;
+		if (iFilterMask & (1 << AC_REC_ARM))
+		{
+			int* ra = (int*)GetSetMediaTrackInfo(t.tr, "I_RECARM", NULL);
+			t.iRecArm = ra ? *ra : 0;
+		}
+		if (iFilterMask & (1 << AC_VCA_MASTER)) // check newly added groups 33 - 64 too
+			t.bVcaMaster = GetSetTrackGroupMembership(t.tr, "VOLUME_VCA_MASTER", 0, 0) || GetSetTrackGroupMembershipHigh(t.tr, "VOLUME_VCA_MASTER", 0, 0);
+		if (iFilterMask & ((1 << AC_AUDIOIN) | (1 << AC_MIDIIN)))
+			t.iRecInput = *(int*)GetSetMediaTrackInfo(t.tr, "I_RECINPUT", NULL);
+		if (iFilterMask & (1 << AC_AUDIOOUT))
+			t.bHwOut = GetTrackNumSends(t.tr, 1) != 0;
+		if (iFilterMask & (1 << AC_INSTRUMENT))
+			t.bInstrument = TrackFX_GetInstrument(t.tr) >= 0;
+		if (iFilterMask & (1 << AC_MIDIOUT))
+			t.iMidiHwOut = *(int*)GetSetMediaTrackInfo(t.tr, "I_MIDIHWOUT", NULL);
+	}
+}
+
+static bool MatchTrackRule(const SWS_CompiledRule& rule, const SWS_TrackAttr& t, bool bMaster)
+{
+	if (bMaster)
+		return rule.iKind == AC_MASTER;
+
+	switch (rule.iKind)
+	{
+		case AC_FOLDER:     return t.iFolder == 1;
+		case AC_CHILDREN:   return t.bChild;
+		case AC_RECEIVE:    return t.bReceive;
+		case AC_UNNAMED:    return t.sLCName.empty();
+		case AC_REC_ARM:    return t.iRecArm != 0;
+		case AC_VCA_MASTER: return t.bVcaMaster;
+		case AC_AUDIOIN:    return t.iRecInput >= 0 && !(t.iRecInput & 4096); // !none && !MIDI
+		case AC_AUDIOOUT:   return t.bHwOut;
+		case AC_INSTRUMENT: return t.bInstrument;
+		case AC_MIDIIN:     return t.iRecInput >= 0 && (t.iRecInput & 4096); // !none && MIDI
+		case AC_MIDIOUT:    return (t.iMidiHwOut >> 5) >= 0;
+		case AC_ANY:        return true;
+		default:            return strstr(t.sLCName.c_str(), rule.sLCFilter.c_str()) != NULL; // name match
+	}
+}
+
+// Matches all rules against all tracks, reusing the last pass' results for tracks with unchanged attributes
+static void MatchTrackRules(const SWS_AutoColorPass* last, const std::vector<SWS_CompiledRule>& rules, const std::vector<SWS_TrackAttr>& tracks, std::vector<char>* matches)
+{
+	const size_t nbTracks = tracks.size();
+	matches->assign(rules.size() * nbTracks, 0);
+
+	bool bSameRules = last->m_bValid && last->m_rules.size() == rules.size();
+	for (size_t r = 0; bSameRules && r < rules.size(); r++)
+		bSameRules = last->m_rules[r].rule == rules[r].rule && last->m_rules[r].iKind == rules[r].iKind && last->m_rules[r].sLCFilter == rules[r].sLCFilter;
+
+	std::unordered_map<MediaTrack*, size_t> lastTracks;
+	if (bSameRules)
+		for (size_t t = 0; t < last->m_tracks.size(); t++)
+			lastTracks[last->m_tracks[t].tr] = t;
+
+	for (size_t t = 0; t < nbTracks; t++)
+	{
+		std::unordered_map<MediaTrack*, size_t>::const_iterator it = lastTracks.find(tracks[t].tr);
+		if (it != lastTracks.end() && last->m_tracks[it->second].SameFilterAttrs(tracks[t]))
+		{
+			for (size_t r = 0; r < rules.size(); r++)
+				(*matches)[r * nbTracks + t] = last->m_matches[r * last->m_tracks.size() + it->second];
+		}
+		else
+		{
+			for (size_t r = 0; r < rules.size(); r++)
+				(*matches)[r * nbTracks + t] = MatchTrackRule(rules[r], tracks[t], t == 0) ? 1 : 0;
+		}
+	}
+}
+
+// bMatches: rule matches, one per track (see MatchTrackRules())
+void ApplyColorRuleToTrack(FlatSet<SWS_RuleTrack> *activeRules, SWS_RuleItem* rule, const std::vector<SWS_TrackAttr>& tracks, const char* bMatches, bool bDoColors, bool bDoIcons, bool bDoLayout, bool bForce)
 {
 	if(rule->m_type == AC_TRACK)
 	{
@@ -735,12 +952,10 @@ void ApplyColorRuleToTrack(FlatSet<SWS_RuleTrack> *activeRules, SWS_RuleItem* ru
 			UpdateCustomColors();
 
 		// Check all tracks for matching strings/properties
-		MediaTrack* temp = NULL;
-		const int numTracks = GetNumTracks();
-		activeRules->reserve(numTracks);
-		for (int i = 0; i <= numTracks; i++)
+		activeRules->reserve(tracks.size());
+		for (size_t i = 0; i < tracks.size(); i++)
 		{
-			MediaTrack* tr = i ? GetTrack(nullptr, i - 1) : GetMasterTrack(nullptr);
+			MediaTrack* tr = tracks[i].tr;
 			bool bColor = bDoColors;
 			bool bIcon  = bDoIcons;
 			bool bLayout[2] = { bDoLayout, bDoLayout };
@@ -766,103 +981,7 @@ void ApplyColorRuleToTrack(FlatSet<SWS_RuleTrack> *activeRules, SWS_RuleItem* ru
 			// Do the track rule matching
 			if (bColor || bIcon || bLayout[0] || bLayout[1])
 			{
-				bool bMatch = false;
-
-				if (i) // ignore master for most things
-				{
-					// Check "special" rules first:
-					if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_FOLDER]) == 0)
-					{
-						int iType;
-						GetFolderDepth(tr, &iType, &temp);
-						if (iType == 1)
-							bMatch = true;
-					}
-					else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_CHILDREN]) == 0)
-					{
-						temp = CSurf_TrackFromID(0, false); // JFB fix: 'temp' could be out of sync
-						if (GetFolderDepth(tr, NULL, &temp) >= 1)
-							bMatch = true;
-					}
-					else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_RECEIVE]) == 0)
-					{
-						if (GetSetTrackSendInfo(tr, -1, 0, "P_SRCTRACK", NULL))
-							bMatch = true;
-					}
-					else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_UNNAMED]) == 0)
-					{
-						char* cName = (char*)GetSetMediaTrackInfo(tr, "P_NAME", NULL);
-						if (!cName || !cName[0])
-							bMatch = true;
-					}
-					else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_REC_ARM]) == 0)
-					{
-						int* ra = (int*)GetSetMediaTrackInfo(tr, "I_RECARM", NULL);
-						if (ra && *ra)
-							bMatch = true;
-					}
-					else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_VCA_MASTER]) == 0)
-					{
-						int iVcaMaster = GetSetTrackGroupMembership(tr, "VOLUME_VCA_MASTER", 0, 0);
-
-						// check newly added groups 33 - 64
-						int iVcaMasterHigh = GetSetTrackGroupMembershipHigh(tr, "VOLUME_VCA_MASTER", 0, 0);
-
-						if (iVcaMaster || iVcaMasterHigh)
-							bMatch = true;
-					}
-					else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_AUDIOIN]) == 0)
-					{
-						int input = *(int*)GetSetMediaTrackInfo(tr, "I_RECINPUT", NULL);
-						if (input >= 0 && !(input & 4096)) { // !none && !MIDI
-							bMatch = true;
-						}
-					}
-					else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_AUDIOOUT]) == 0)
-					{
-						int hwouts = GetTrackNumSends(tr, 1);
-						if (hwouts) {
-							bMatch = true;
-						}
-					}
-					else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_INSTRUMENT]) == 0)
-					{
-						if (TrackFX_GetInstrument(tr) >= 0)
-							bMatch = true;
-					}
-					else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_MIDIIN]) == 0)
-					{
-						int input = *(int*)GetSetMediaTrackInfo(tr, "I_RECINPUT", NULL);
-						if (input >= 0 && (input & 4096)) { // !none && MIDI
-							bMatch = true;
-						}
-					}
-					else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_MIDIOUT]) == 0)
-					{
-						int midihw = *(int*)GetSetMediaTrackInfo(tr, "I_MIDIHWOUT", NULL);
-						int mididv = midihw >> 5;
-						// int midich = midihw & 0xF;
-						if (mididv >= 0) {
-							bMatch = true;
-						}
-					}
-					else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_ANY]) == 0)
-					{
-						bMatch = true;
-					}
-					else // Check for name match
-					{
-						char* cName = (char*)GetSetMediaTrackInfo(tr, "P_NAME", NULL);
-						if (cName && stristr(cName, rule->m_str_filter.Get()))
-							bMatch = true;
-					}
-				}
-				else if (strcmp(rule->m_str_filter.Get(), cFilterTypes[AC_MASTER]) == 0)
-				{	// Check master rule
-					bMatch = true;
-				}
-
-				if (bMatch)
+				if (bMatches[i])
 				{
 					// Set the color
 					if (bColor)
@@ -995,6 +1114,43 @@ void AutoColorTrack(bool bForce)
 	bRecurse = true;
 
 	auto *activeRules = g_pACTracks.Get();
+	SWS_AutoColorPass* lastPass = g_pACPass.Get();
+
+	bool bDoColors  = g_bACEnabled || bForce;
+	bool bDoIcons   = g_bAIEnabled || bForce;
+	bool bDoLayouts = g_bALEnabled || bForce;
+	const int iFlags = (bDoColors ? 1 : 0) | (bDoIcons ? 2 : 0) | (bDoLayouts ? 4 : 0);
+
+	// Compile rules and read track attributes once for all rules
+	int iFilterMask;
+	std::vector<SWS_CompiledRule> rules;
+	CompileTrackRules(&rules, &iFilterMask);
+	for (size_t i = 0; i < rules.size(); i++)
+		if (rules[i].iColor == -AC_CUSTOM-1)
+		{
+			UpdateCustomColors();
+			break;
+		}
+
+	std::vector<SWS_TrackAttr> tracks;
+	GetTrackAttrs(&tracks, iFilterMask, iFlags);
+
+	// Nothing changed since the last pass (rules, tracks and what they've been set to)? Then it would be a no-op
+	if (!bForce && lastPass->m_bValid && lastPass->m_iFlags == iFlags && lastPass->m_rules == rules && lastPass->m_tracks.size() == tracks.size() &&
+		!memcmp(lastPass->m_custColors, g_custColors, sizeof(g_custColors)) && lastPass->m_crGradStart == g_crGradStart && lastPass->m_crGradEnd == g_crGradEnd)
+	{
+		bool bSame = true;
+		for (size_t i = 0; bSame && i < tracks.size(); i++)
+			bSame = lastPass->m_tracks[i].SameFilterAttrs(tracks[i]) && lastPass->m_tracks[i].SameState(tracks[i]);
+		if (bSame)
+		{
+			bRecurse = false;
+			return;
+		}
+	}
+
+	std::vector<char> matches;
+	MatchTrackRules(lastPass, rules, tracks, &matches);
 
 	// If forcing, start over with the saved track list
 	if (bForce)
@@ -1017,14 +1173,10 @@ void AutoColorTrack(bool bForce)
 	}
 
 	// Apply the rules
-	bool bDoColors  = g_bACEnabled || bForce;
-	bool bDoIcons   = g_bAIEnabled || bForce;
-	bool bDoLayouts = g_bALEnabled || bForce;
-
 	PreventUIRefresh(1);
 
-	for (int i = 0; i < g_pACItems.GetSize(); i++)
-		ApplyColorRuleToTrack(activeRules, g_pACItems.Get(i), bDoColors, bDoIcons, bDoLayouts, bForce);
+	for (size_t i = 0; i < rules.size(); i++)
+		ApplyColorRuleToTrack(activeRules, rules[i].rule, tracks, matches.data() + i * tracks.size(), bDoColors, bDoIcons, bDoLayouts, bForce);
 
 	// Remove colors/icons if necessary
 	for (auto pACTrack = activeRules->begin(); pACTrack != activeRules->end(); ++pACTrack)
@@ -1082,6 +1234,18 @@ void AutoColorTrack(bool bForce)
 		Undo_OnStateChangeEx(__LOCALIZE("Apply auto color/icon/layout","sws_undo"), UNDO_STATE_TRACKCFG | UNDO_STATE_MISCCFG, -1);
 	PreventUIRefresh(-1);
 
+	// Remember this pass with the state it left tracks in
+	for (size_t i = 0; i < tracks.size(); i++)
+		GetTrackState(&tracks[i], iFlags);
+	lastPass->m_bValid = true;
+	lastPass->m_tracks.swap(tracks);
+	lastPass->m_iFlags = iFlags;
+	lastPass->m_rules.swap(rules);
+	lastPass->m_matches.swap(matches);
+	memcpy(lastPass->m_custColors, g_custColors, sizeof(g_custColors));
+	lastPass->m_crGradStart = g_crGradStart;
+	lastPass->m_crGradEnd = g_crGradEnd;
+
 	bRecurse = false;
 }
 
@@ -128,6 +128,13 @@ void DumpItems(COMMAND_T* = NULL)
 	}
 }
 
+void PrintObjStateCacheStats(COMMAND_T* = NULL)
+{
+	WDL_FastString str;
+	SWS_GetObjectStateCacheStats(&str, true);
+	OutputDebugString(str.Get());
+}
+
 #endif
 
 static bool ProcessExtensionLine(const char *line, ProjectStateContext *ctx, bool isUndo, struct project_config_extension_t *reg)
@@ -339,6 +346,7 @@ static COMMAND_T g_commandTable[] =
 	{ { DEFACCEL, "SWS: [Internal] Print menu tree" }, "SWS_PRINTMENU",  PrintMenu, },
 	{ { DEFACCEL, "SWS: [Internal] Run action..." }, "SWS_RUNACTION",  RunAction, },
 	{ { DEFACCEL, "SWS: [Internal] Print sel items' times" }, "SWS_DUMPITEMS",  DumpItems, },
+	{ { DEFACCEL, "SWS: [Internal] Print object state cache statistics" }, "SWS_PRINTOBJSTATESTATS",  PrintObjStateCacheStats, },
 
 #endif
 
@@ -86,7 +86,7 @@ void SelItems::Add(MediaTrack* tr)
 
 // bUsed is an array of bools with size == m_selItems.GetSize(), used to "check off" when an item from that list is used
 // caller initializes bUsed
-void SelItems::Match(MediaTrack* tr, bool* bUsed)
+void SelItems::Match(MediaTrack* tr, bool* bUsed, const GuidIndexes& indexes)
 {
 	PreventUIRefresh(1);
 	int nbitems=GetTrackNumMediaItems(tr);
@@ -95,7 +95,11 @@ void SelItems::Match(MediaTrack* tr, bool* bUsed)
 		MediaItem* mi = GetTrackMediaItem(tr, i);
 		GetSetMediaItemInfo(mi, "B_UISEL", &g_bFalse);
 		GUID* g = (GUID*)GetSetMediaItemInfo(mi, "GUID", NULL);
-		for (int j = 0; j < m_selItems.GetSize(); j++)
+		GuidIndexes::const_iterator it = g ? indexes.find(*g) : indexes.end();
+		if (it == indexes.end())
+			continue;
+		// duplicate GUIDs in the list (unlikely): look for the next unused one
+		for (int j = it->second; j < m_selItems.GetSize(); j++)
 			if (!bUsed[j] && GuidsEqual(m_selItems.Get(j), g))
 			{
 				bUsed[j] = true;
@@ -115,15 +119,20 @@ void SelItems::Restore(MediaTrack* tr)
 		memset(bUsed, 0, sizeof(bool) * m_selItems.GetSize());
 	}
 
+	GuidIndexes indexes;
+	indexes.reserve(m_selItems.GetSize());
+	for (int i = 0; i < m_selItems.GetSize(); i++)
+		indexes.emplace(*m_selItems.Get(i), i); // no overwrite: 1st one wins
+
 	if (tr == NULL)
 	{
 		PreventUIRefresh(1);
 		for (int i = 1; i <= GetNumTracks(); i++)
-			Match(CSurf_TrackFromID(i, false), bUsed);
+			Match(CSurf_TrackFromID(i, false), bUsed, indexes);
 		PreventUIRefresh(-1);
 	}
 	else
-		Match(tr, bUsed);
+		Match(tr, bUsed, indexes);
 
 	// Delete unused items
 	for (int i = m_selItems.GetSize()-1; i >= 0 ; i--)
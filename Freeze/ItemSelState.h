@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <unordered_map>
+
 #define SEL_SLOTS 5
 
 class SelItems
@@ -44,7 +46,8 @@ public:
 
 private:
 	void Add(MediaTrack* tr);
-	void Match(MediaTrack* tr, bool* bUsed);
+	typedef std::unordered_map<GUID, int, GuidHash, GuidEqual> GuidIndexes; // GUID -> 1st index in m_selItems
+	void Match(MediaTrack* tr, bool* bUsed, const GuidIndexes& indexes);
 	WDL_PtrList<GUID> m_selItems;
 };
 
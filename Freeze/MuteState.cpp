@@ -29,6 +29,8 @@
 #include "stdafx.h"
 #include "MuteState.h"
 
+#include <unordered_map>
+
 //*****************************************************
 //Globals
 SWSProjConfig<WDL_PtrList_DOD<MuteState> > g_muteStates;
@@ -51,23 +53,16 @@ MuteItem::MuteItem(LineParser* lp)
 // MuteState class
 MuteState::MuteState(MediaTrack* tr)
 {	// Remember states of this track
-	int iType;
-	MediaTrack* gfd = NULL;
-	int iFolder = GetFolderDepth(tr, &iType, &gfd);
-	if (iType == 1)
+	const SWS_FolderTree* tree = SWS_FolderTree::Get();
+	const int id = tree->GetId(tr);
+	if (tree->GetType(id) == 1)
 	{
-		int iChild = CSurf_TrackToID(tr, false) + 1;
-		while(true)
+		for (int iChild = id + 1; iChild <= tree->GetLastDescendant(id); iChild++)
 		{
-			MediaTrack* trChild = CSurf_TrackFromID(iChild++, false);
-			if (!trChild)
-				break;
-			int iChildFolder = GetFolderDepth(trChild, &iType, &gfd);
+			MediaTrack* trChild = tree->GetTrack(iChild);
 			GUID* guid = (GUID*)GetSetMediaTrackInfo(trChild, "GUID", NULL);
 			bool bMute = *(bool*)GetSetMediaTrackInfo(trChild, "B_MUTE", NULL);
 			m_children.Add(new MuteItem(guid, bMute));
-			if (iChildFolder + iType <= iFolder)
-				break;
 		}
 	}
 
@@ -108,23 +103,25 @@ void MuteState::Restore(MediaTrack* tr)
 	}
 	if (m_children.GetSize())
 	{
-		int iType;
-		MediaTrack* gfd = NULL;
-		int iFolder = GetFolderDepth(tr, &iType, &gfd);
-		if (iType == 1)
+		const SWS_FolderTree* tree = SWS_FolderTree::Get();
+		const int id = tree->GetId(tr);
+		if (tree->GetType(id) == 1)
 		{
-			int iChild = CSurf_TrackToID(tr, false) + 1;
-			while(true)
+			// GUID -> child state (last one wins, as with the previous linear scans)
+			std::unordered_map<GUID, MuteItem*, GuidHash, GuidEqual> children;
+			children.reserve(m_children.GetSize());
+			for (int i = 0; i < m_children.GetSize(); i++)
+				children[m_children.Get(i)->m_guid] = m_children.Get(i);
+
+			for (int iChild = id + 1; iChild <= tree->GetLastDescendant(id); iChild++)
 			{
-				MediaTrack* trChild = CSurf_TrackFromID(iChild++, false);
-				if (!trChild)
-					break;
-				int iChildFolder = GetFolderDepth(trChild, &iType, &gfd);
-				for (int i = 0; i < m_children.GetSize(); i++)
-					if (TrackMatchesGuid(trChild, &m_children.Get(i)->m_guid))
-						GetSetMediaTrackInfo(trChild, "B_MUTE", &m_children.Get(i)->m_bState);
-				if (iChildFolder + iType <= iFolder)
-					break;
+				MediaTrack* trChild = tree->GetTrack(iChild);
+				if (const GUID* g = TrackToGuid(trChild))
+				{
+					auto it = children.find(*g);
+					if (it != children.end())
+						GetSetMediaTrackInfo(trChild, "B_MUTE", &it->second->m_bState);
+				}
 			}
 		}
 	}
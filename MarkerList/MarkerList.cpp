@@ -55,6 +55,7 @@ static SWS_LVColumn g_cols[] = { { 75, 0, "Time" }, { 45, 0, "Type" }, { 30, 0,
 SWS_MarkerListView::SWS_MarkerListView(HWND hwndList, HWND hwndEdit, SWS_MarkerListWnd* pList)
 :SWS_ListView(hwndList, hwndEdit, 5, g_cols, "MarkerList View State", false, "sws_DLG_102"), m_pMarkerList(pList)
 {
+	SetTextOnDemand(true);
 }
 
 void SWS_MarkerListView::GetItemText(SWS_ListItem* item, int iCol, char* str, int iStrMax)
@@ -214,6 +215,12 @@ int SWS_MarkerListView::GetItemState(SWS_ListItem* item)
 	return GetCursorPosition() == mi->GetPos() ? 1 : 0;
 }
 
+int SWS_MarkerListView::GetItemGeneration(SWS_ListItem* item)
+{
+	MarkerItem* mi = (MarkerItem*)item;
+	return mi->GetGeneration();
+}
+
 SWS_MarkerListWnd::SWS_MarkerListWnd()
 :SWS_DockWnd(IDD_MARKERLIST, __LOCALIZE("Marker List","sws_DLG_102"), "SWSMarkerList"), m_dCurPos(DBL_MAX)
 {
@@ -223,6 +230,11 @@ SWS_MarkerListWnd::SWS_MarkerListWnd()
 
 void SWS_MarkerListWnd::Update(bool bForce)
 {
+	// texts are pulled on demand: list view rows must not outlive g_curList's items,
+	// so don't rebuild while the list view can't follow (retried on next update)
+	if (g_curList && m_pLists.GetSize() && (m_pLists.Get(0)->GetEditingItem() != -1 || m_pLists.Get(0)->UpdatesDisabled()))
+		return;
+
 	// Change the time string if the project time mode changes
 	static int prevTimeMode = -1;
 	bool bChanged = bForce;
@@ -230,6 +242,8 @@ void SWS_MarkerListWnd::Update(bool bForce)
 	{
 		prevTimeMode = *ConfigVar<int>("projtimemode");
 		bChanged = true;
+		if (m_pLists.GetSize())
+			m_pLists.Get(0)->InvalidateItemGenerations(); // position texts
 	}
 
 	double dCurPos = GetCursorPosition();
@@ -44,6 +44,7 @@ protected:
 	int  OnItemSort(SWS_ListItem* item1, SWS_ListItem* item2);
 	void GetItemList(SWS_ListItemList* pList);
 	int  GetItemState(SWS_ListItem* item);
+	int  GetItemGeneration(SWS_ListItem* item);
 
 private:
 	SWS_MarkerListWnd* m_pMarkerList;
@@ -36,6 +36,8 @@
 #include <WDL/localize/localize.h>
 #include <WDL/projectcontext.h>
 
+int MarkerItem::s_lastGen = 0;
+
 MarkerItem::MarkerItem(bool bReg, double dPos, double dRegEnd, const char* cName, int num, int color)
 {
 	m_bReg = bReg;
@@ -54,6 +56,7 @@ MarkerItem::MarkerItem(LineParser* lp)
 	m_bReg    = lp->gettoken_int(3) ? true : false;
 	m_dRegEnd = lp->gettoken_float(4);
 	m_iColor  = lp->gettoken_int(5);
+	Touch();
 }
 
 char* MarkerItem::ItemString(char* str, int iSize)
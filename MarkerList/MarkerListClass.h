@@ -42,25 +42,30 @@ public:
 
 	// Member access	
 	char* GetName() { return m_name.Get(); }
-	void SetName(const char* newname) { m_name.Set(!newname ? "" : newname); }
+	void SetName(const char* newname) { m_name.Set(!newname ? "" : newname); Touch(); }
 	double GetPos() { return m_dPos; }
-	void SetPos(double dPos) { m_dPos = dPos; }
+	void SetPos(double dPos) { m_dPos = dPos; Touch(); }
 	double GetRegEnd() { return m_dRegEnd; }
-	void SetRegEnd(double dEnd) { m_dRegEnd = dEnd; }
+	void SetRegEnd(double dEnd) { m_dRegEnd = dEnd; Touch(); }
 	bool IsRegion() { return m_bReg; }
-	void SetReg(bool bIsReg) {  m_bReg = bIsReg; }
+	void SetReg(bool bIsReg) {  m_bReg = bIsReg; Touch(); }
 	int GetNum() { return m_num; }
-	void SetNum(int num) { m_num = num; }
+	void SetNum(int num) { m_num = num; Touch(); }
 	int GetColor() { return m_iColor; }
-	void SetColor(int iColor) { m_iColor = iColor; }
+	void SetColor(int iColor) { m_iColor = iColor; Touch(); }
+	int GetGeneration() { return m_gen; } // changes with any member, never shared by other items
 
 protected:
+	void Touch() { m_gen = ++s_lastGen; }
+
 	WDL_String m_name;
 	double m_dPos;
 	bool m_bReg;
 	double m_dRegEnd;
 	int m_num;
 	int m_iColor;
+	int m_gen;
+	static int s_lastGen;
 };
 
 class MarkerList
@@ -29,36 +29,203 @@
 
 #include "Analysis.h"
 #include "../sws_waitdlg.h"
+#include "../Utility/ThreadPool.h"
 
 #include <WDL/localize/localize.h>
 
 static void GetRMSOptions(double *target, double *windowSize);
 
-static bool AnalyzePCMSource(ANALYZE_PCM* a)
+SWS_LevelAnalyzer::SWS_LevelAnalyzer(int nch, int windowLen)
+:m_nch(max(nch, 0)), m_windowLen(max(windowLen, 0)), m_windowPos(0), m_sampleCount(0)
 {
-	// Init local transfer block "t" and sum of squares
-	PCM_source_transfer_t t={0,};
-	t.samplerate = a->pcm->GetSampleRate();
-	t.nch = a->pcm->GetNumChannels();
-	t.length = a->dWindowSize == 0.0 ? 16384 : (int)(a->dWindowSize * t.samplerate);
-	t.samples = new (nothrow) ReaSample[t.length * t.nch];
+	m_sumSquares.Resize(m_nch, false);
+	m_peaks.Resize(m_nch, false);
+	m_peakPos.Resize(m_nch, false);
+	if (m_windowLen)
+	{
+		m_window.Resize(m_nch * m_windowLen, false);
+		m_maxSumSquares.Resize(m_nch, false);
+		m_maxSumSquaresPos.Resize(m_nch, false);
+	}
 
-	if(!t.samples)
+	if (this->IsValid())
+	{
+		memset(m_sumSquares.Get(), 0, m_sumSquares.GetSize() * sizeof(double));
+		memset(m_peaks.Get(), 0, m_peaks.GetSize() * sizeof(double));
+		memset(m_peakPos.Get(), 0, m_peakPos.GetSize() * sizeof(INT64));
+		if (m_windowLen)
+		{
+			memset(m_window.Get(), 0, m_window.GetSize() * sizeof(ReaSample));
+			memset(m_maxSumSquares.Get(), 0, m_maxSumSquares.GetSize() * sizeof(double));
+			memset(m_maxSumSquaresPos.Get(), 0, m_maxSumSquaresPos.GetSize() * sizeof(INT64));
+		}
+	}
+}
+
+bool SWS_LevelAnalyzer::IsValid()
+{
+	if (!m_nch || m_sumSquares.GetSize() != m_nch || m_peaks.GetSize() != m_nch || m_peakPos.GetSize() != m_nch)
 		return false;
+	return !m_windowLen || (m_window.GetSize() == m_nch * m_windowLen && m_maxSumSquares.GetSize() == m_nch && m_maxSumSquaresPos.GetSize() == m_nch);
+}
+
+void SWS_LevelAnalyzer::Process(const ReaSample* buf, int frames)
+{
+	if (!this->IsValid() || frames <= 0)
+		return;
 
-	ReaSample* prevBuf = NULL;
-	INT64 tempPeakRMSsample = 0;
-	if (a->dWindowSize != 0.0)
+	double* sumSquares = m_sumSquares.Get();
+	double* peaks = m_peaks.Get();
+	for (int chan = 0; chan < m_nch; chan++)
 	{
-		if((prevBuf = new (nothrow) ReaSample[t.length * t.nch]))
-			memset(prevBuf, 0, t.length * t.nch * sizeof(*prevBuf));
+		const ReaSample* in = buf + chan;
+
+		// Block peak first (no branches, vectorizable), the position is searched for only if it's a new maximum
+		double blockPeak0 = 0.0, blockPeak1 = 0.0;
+		int i = 0;
+		for (; i + 1 < frames; i += 2)
+		{
+			const double x0 = fabs(in[i*m_nch]), x1 = fabs(in[(i+1)*m_nch]);
+			blockPeak0 = x0 > blockPeak0 ? x0 : blockPeak0;
+			blockPeak1 = x1 > blockPeak1 ? x1 : blockPeak1;
+		}
+		if (i < frames)
+		{
+			const double x0 = fabs(in[i*m_nch]);
+			blockPeak0 = x0 > blockPeak0 ? x0 : blockPeak0;
+		}
+		const double blockPeak = max(blockPeak0, blockPeak1);
+		if (blockPeak > peaks[chan])
+		{
+			for (i = 0; i < frames; i++)
+			{
+				if (fabs(in[i*m_nch]) == blockPeak)
+				{
+					m_peakPos.Get()[chan] = m_sampleCount + i;
+					break;
+				}
+			}
+			peaks[chan] = blockPeak;
+		}
+
+		if (!m_windowLen)
+		{
+			double ss0 = 0.0, ss1 = 0.0;
+			for (i = 0; i + 1 < frames; i += 2)
+			{
+				ss0 += in[i*m_nch] * in[i*m_nch];
+				ss1 += in[(i+1)*m_nch] * in[(i+1)*m_nch];
+			}
+			if (i < frames)
+				ss0 += in[i*m_nch] * in[i*m_nch];
+			sumSquares[chan] += ss0 + ss1;
+		}
 		else
-			return false;
+		{
+			// Sliding window: add incoming and subtract outgoing sample. Squared sums get compared directly,
+			// sqrt happens only once in GetRMS()
+			ReaSample* window = m_window.Get() + chan * m_windowLen;
+			double ss = sumSquares[chan];
+			double maxSS = m_maxSumSquares.Get()[chan];
+			INT64 maxPos = m_maxSumSquaresPos.Get()[chan];
+			int pos = m_windowPos;
+			for (i = 0; i < frames; i++)
+			{
+				const double x = in[i*m_nch];
+				const double old = window[pos];
+				window[pos] = in[i*m_nch];
+				if (++pos == m_windowLen)
+					pos = 0;
+
+				ss += x * x;
+				ss -= old * old;
+				if (ss < 0.0) // Unlikely but possible with rounding errors
+					ss = 0.0;
+				if (ss > maxSS)
+				{
+					maxSS = ss;
+					maxPos = m_sampleCount + i;
+				}
+			}
+			sumSquares[chan] = ss;
+			m_maxSumSquares.Get()[chan] = maxSS;
+			m_maxSumSquaresPos.Get()[chan] = maxPos;
+		}
+	}
+
+	if (m_windowLen)
+		m_windowPos = (int)((m_windowPos + frames) % m_windowLen);
+	m_sampleCount += frames;
+}
+
+double SWS_LevelAnalyzer::GetPeak(int chan, INT64* pos)
+{
+	if (!this->IsValid() || chan >= m_nch)
+		return 0.0;
+
+	// Overall peak is the first sample of any channel reaching the max
+	int first = chan < 0 ? 0 : chan, last = chan < 0 ? m_nch - 1 : chan, peakChan = first;
+	for (int i = first + 1; i <= last; i++)
+	{
+		if (m_peaks.Get()[i] > m_peaks.Get()[peakChan] || (m_peaks.Get()[i] == m_peaks.Get()[peakChan] && m_peakPos.Get()[i] < m_peakPos.Get()[peakChan]))
+			peakChan = i;
+	}
+	if (pos)
+		*pos = m_peakPos.Get()[peakChan];
+	return m_peaks.Get()[peakChan];
+}
+
+double SWS_LevelAnalyzer::GetRMS(int chan, INT64* pos)
+{
+	if (!this->IsValid() || chan >= m_nch)
+		return 0.0;
+
+	if (!m_windowLen)
+	{
+		if (pos)
+			*pos = -666;
+		if (!m_sampleCount)
+			return 0.0;
+		if (chan >= 0)
+			return sqrt(m_sumSquares.Get()[chan] / m_sampleCount);
+
+		double ss = 0.0;
+		for (int i = 0; i < m_nch; i++)
+			ss += m_sumSquares.Get()[i];
+		return sqrt(ss / (m_sampleCount * m_nch));
 	}
 
-	double* dSumSquares = new double[t.nch];
-	for (int i = 0; i < t.nch; i++)
-		dSumSquares[i] = 0.0;
+	int first = chan < 0 ? 0 : chan, last = chan < 0 ? m_nch - 1 : chan, maxChan = first;
+	for (int i = first + 1; i <= last; i++)
+	{
+		if (m_maxSumSquares.Get()[i] > m_maxSumSquares.Get()[maxChan] || (m_maxSumSquares.Get()[i] == m_maxSumSquares.Get()[maxChan] && m_maxSumSquaresPos.Get()[i] < m_maxSumSquaresPos.Get()[maxChan]))
+			maxChan = i;
+	}
+	if (pos)
+		*pos = m_maxSumSquaresPos.Get()[maxChan] - m_windowLen;
+	return sqrt(m_maxSumSquares.Get()[maxChan] / m_windowLen);
+}
+
+static SWS_ThreadPool g_analyzePool; // one thread per CPU core
+
+static bool AnalyzePCMSource(ANALYZE_PCM* a)
+{
+	// Init local transfer block "t", window history is kept by the analyzer so block size doesn't depend on it
+	PCM_source_transfer_t t={0,};
+	t.samplerate = a->pcm->GetSampleRate();
+	t.nch = a->pcm->GetNumChannels();
+	t.length = 16384;
+
+	WDL_TypedBuf<ReaSample> samples;
+	samples.Resize(t.length * t.nch, false);
+	if (samples.GetSize() != t.length * t.nch)
+		return false;
+	t.samples = samples.Get();
+
+	const int windowLen = a->dWindowSize == 0.0 ? 0 : max((int)(a->dWindowSize * t.samplerate), 1);
+	SWS_LevelAnalyzer analyzer(t.nch, windowLen);
+	if (!analyzer.IsValid())
+		return false;
 
 	// Init output variables.  Note can have different channel count.
 	for (int i = 0; i < a->iChannels; i++)
@@ -76,259 +243,352 @@ static bool AnalyzePCMSource(ANALYZE_PCM* a)
 	a->sampleCount = 0;
 
 	INT64 totalSamples = (INT64)(a->pcm->GetLength() * t.samplerate);
-	int iFrame = 0;
 
 	a->pcm->GetSamples(&t);
 	while (t.samples_out)
 	{
-		for (int samp = 0; samp < t.samples_out; samp++)
-		{
-			for (int chan = 0; chan < t.nch; chan++)
-			{
-				int i = samp*t.nch + chan;
-				dSumSquares[chan] += t.samples[i] * t.samples[i];
-				double absamp = fabs(t.samples[i]);
-				if (absamp > a->dPeakVal)
-				{
-					a->dPeakVal = absamp;
-					a->peakSample = a->sampleCount;
-				}
-
-				if (a->dPeakVals && chan < a->iChannels && absamp > a->dPeakVals[chan])
-				{
-					a->dPeakVals[chan] = absamp;
-					if (a->peakSamples)
-						a->peakSamples[chan] = a->sampleCount;
-				}
-				if (a->dWindowSize != 0.0)
-				{
-					dSumSquares[chan] -= prevBuf[i] * prevBuf[i];
-					if (dSumSquares[chan] < 0.0) // Unlikely but possible with rounding errors
-						dSumSquares[chan] = 0.0;
-					double curRMS = sqrt(dSumSquares[chan] / t.length);
-					if (curRMS > a->dRMS) // Overall
-					{ 
-						a->dRMS = curRMS;
-						tempPeakRMSsample = a->sampleCount;
-					}
-					if (a->dRMSs && curRMS > a->dRMSs[chan]) // Single channel, if enabled
-					{ 
-						a->dRMSs[chan] = curRMS;
-						if (a->peakRMSsamples)
-							a->peakRMSsamples[chan] = a->sampleCount;
-					}
-						
-				}
-			}
-			a->sampleCount++;
-		}
-		if (a->dWindowSize != 0.0)
-		{	// Swap buffers in windowed mode for history
-			ReaSample* temp = t.samples;
-			t.samples = prevBuf;
-			prevBuf = temp;
-		}
+		if (a->pCancel && *a->pCancel)
+			return false;
 
+		analyzer.Process(t.samples, t.samples_out);
+		a->sampleCount = analyzer.GetSampleCount();
 		a->dProgress = (double)a->sampleCount / totalSamples;
 
-		iFrame++;
-		t.time_s = (double)t.length * iFrame / t.samplerate;
 		// Get next block
+		t.time_s = (double)a->sampleCount / t.samplerate;
 		t.samples_out = 0;
 		a->pcm->GetSamples(&t);
 	}
 
-	if (a->dWindowSize == 0.0)
+	for (int i = 0; i < a->iChannels && i < t.nch; i++)
 	{
-		// Non-windowed mode.  Calculate the RMS for the entire item
-		// First per channel
-		if (a->dRMSs && a->sampleCount)
-			for (int i = 0; i < a->iChannels && i < t.nch; i++)
-				a->dRMSs[i] = sqrt(dSumSquares[i] / a->sampleCount);
-
-		// Then for all channels combined
-		double dSS = 0.0;
-		for (int i = 0; i < t.nch; i++)
-			dSS += dSumSquares[i];
-		a->dRMS = sqrt(dSS / (a->sampleCount * t.nch));
-	}
-	else // calculate pos. of peak RMS samples
-	{	
-		a->peakRMSsample = tempPeakRMSsample - t.length;
-
-		if (a->peakRMSsamples) {
-			for (int chan = 0; chan < t.nch; chan++) {
-				a->peakRMSsamples[chan] -= t.length;
-			}
-		}
-
+		if (a->dPeakVals)
+			a->dPeakVals[i] = analyzer.GetPeak(i, a->peakSamples ? &a->peakSamples[i] : NULL);
+		if (a->dRMSs)
+			a->dRMSs[i] = analyzer.GetRMS(i, (windowLen && a->peakRMSsamples) ? &a->peakRMSsamples[i] : NULL);
 	}
-
-	delete[] t.samples;
-	delete[] prevBuf;
-	delete[] dSumSquares;
+	a->dPeakVal = analyzer.GetPeak(-1, &a->peakSample);
+	a->dRMS = analyzer.GetRMS(-1, windowLen ? &a->peakRMSsample : NULL);
 
 	return true;
 }
 
-unsigned int WINAPI AnalyzePCMThread(void* pAnalyze)
+static unsigned WINAPI AnalyzePCMJob(void* pAnalyze)
 {
 	ANALYZE_PCM *a = static_cast<ANALYZE_PCM *>(pAnalyze);
 	a->success = AnalyzePCMSource(a);
-	a->dProgress = 1.0; // closes the wait dialog
+	a->dProgress = 1.0;
 	return 0;
 }
 
+// Data passing to/from AnalyzeItemsThread()
+typedef struct ANALYZE_ITEMS
+{
+	ANALYZE_PCM* a;
+	double* weights;  // share of each item in overall progress
+	int count;
+	double dProgress; // overall progress, closes the wait dialog when it reaches 1.0
+	bool bCancel;     // set by the wait dialog
+} ANALYZE_ITEMS;
+
+// Runs analysis of every item on the thread pool and keeps overall progress for the wait dialog
+static unsigned WINAPI AnalyzeItemsThread(void* pItems)
+{
+	ANALYZE_ITEMS* items = static_cast<ANALYZE_ITEMS *>(pItems);
+
+	WDL_TypedBuf<int> jobs;
+	jobs.Resize(items->count, false);
+	for (int i = 0; i < items->count; i++)
+		jobs.Get()[i] = items->a[i].pcm ? g_analyzePool.Submit(AnalyzePCMJob, &items->a[i]) : -1;
+
+	while (true)
+	{
+		// Queued jobs can simply be dropped, running ones check the cancel flag
+		if (items->bCancel)
+		{
+			for (int i = 0; i < items->count; i++)
+				if (jobs.Get()[i] != -1 && g_analyzePool.Cancel(jobs.Get()[i]))
+					jobs.Get()[i] = -1;
+		}
+
+		bool bPending = false;
+		double dProgress = 0.0;
+		for (int i = 0; i < items->count; i++)
+		{
+			if (jobs.Get()[i] == -1)
+				continue;
+			if (g_analyzePool.IsPending(jobs.Get()[i]))
+				bPending = true;
+			dProgress += items->weights[i] * min(items->a[i].dProgress, 1.0);
+		}
+		if (!bPending)
+			break;
+
+		items->dProgress = min(dProgress, 0.99);
+		Sleep(10);
+	}
+
+	items->dProgress = 1.0; // closes the wait dialog
+	return 0;
+}
+
+// Returns duplicated zero-based PCM source of the item that's safe to read from another thread, NULL if it can't be analyzed
+static PCM_source* DuplicateItemSource(MediaItem* item)
+{
+	PCM_source* pcm = (PCM_source*)item;
+	if (!pcm || strcmp(pcm->GetType(), "MIDI") == 0 || strcmp(pcm->GetType(), "MIDIPOOL") == 0)
+		return NULL;
+
+	pcm = pcm->Duplicate();
+	if (pcm && !pcm->GetNumChannels())
+	{
+		delete pcm;
+		pcm = NULL;
+	}
+
+	if (pcm)
+	{
+		double dZero = 0.0;
+		GetSetMediaItemInfo((MediaItem*)pcm, "D_POSITION", &dZero);
+	}
+	return pcm;
+}
+
 // return true for successful analysis
-// wraps AnalyzePCM to check item validity and create a wait dialog
+// wraps AnalyzeItems() to analyze a single item
 bool AnalyzeItem(MediaItem* item, ANALYZE_PCM* a)
 {
-	a->dProgress = 0.0;
-	a->pcm = (PCM_source*)item;
+	return AnalyzeItems(&item, a, 1);
+}
 
-	if (!a->pcm || strcmp(a->pcm->GetType(), "MIDI") == 0 || strcmp(a->pcm->GetType(), "MIDIPOOL") == 0)
-		return false;
+// return true if at least one item was analyzed successfully (check a[i].success for each item), false if user cancelled
+// prepares PCM sources on the main thread, analyzes them in parallel and shows one wait dialog for all of them
+bool AnalyzeItems(MediaItem** items, ANALYZE_PCM* a, int count)
+{
+	WDL_TypedBuf<double> oldWinSizes, weights;
+	oldWinSizes.Resize(count, false);
+	weights.Resize(count, false);
 
-	a->pcm = a->pcm->Duplicate();
-	if (!a->pcm || !a->pcm->GetNumChannels())
+	int iValid = 0;
+	double dTotalLength = 0.0;
+	for (int i = 0; i < count; i++)
+	{
+		a[i].dProgress = 0.0;
+		a[i].success = false;
+		a[i].pCancel = NULL;
+		a[i].pcm = DuplicateItemSource(items[i]);
+
+		oldWinSizes.Get()[i] = a[i].dWindowSize;
+		weights.Get()[i] = 0.0;
+		if (a[i].pcm)
+		{
+			if (a[i].dWindowSize > a[i].pcm->GetLength())
+				a[i].dWindowSize = 0.0;
+			weights.Get()[i] = max(a[i].pcm->GetLength(), 0.0);
+			dTotalLength += weights.Get()[i];
+			iValid++;
+		}
+	}
+	if (!iValid)
 		return false;
 
-	double dZero = 0.0;
-	GetSetMediaItemInfo((MediaItem*)a->pcm, "D_POSITION", &dZero);
-
-	const char* cName = NULL;
-	MediaItem_Take* take = GetMediaItemTake(item, -1);
-	if (take)
-		cName = (const char*)GetSetMediaItemTakeInfo(take, "P_NAME", NULL);
+	for (int i = 0; i < count; i++)
+	{
+		if (a[i].pcm)
+			weights.Get()[i] = dTotalLength > 0.0 ? weights.Get()[i] / dTotalLength : 1.0 / iValid;
+	}
 
-	const double oldWinSize = a->dWindowSize;
-	if (a->dWindowSize > a->pcm->GetLength())
-		a->dWindowSize = 0.0;
+	ANALYZE_ITEMS analyzeItems = { a, weights.Get(), count, 0.0, false };
+	for (int i = 0; i < count; i++)
+		a[i].pCancel = &analyzeItems.bCancel;
 
-	HANDLE hThread = (HANDLE)_beginthreadex(NULL, 0, AnalyzePCMThread, a, 0, NULL);
+	HANDLE hThread = (HANDLE)_beginthreadex(NULL, 0, AnalyzeItemsThread, &analyzeItems, 0, NULL);
 
 	WDL_String title;
-	title.AppendFormatted(100, __LOCALIZE_VERFMT("Please wait, analyzing %s...","sws_analysis"), cName ? cName : __LOCALIZE("item","sws_analysis"));
-	SWS_WaitDlg wait(title.Get(), &a->dProgress);
+	if (count == 1)
+	{
+		const char* cName = NULL;
+		MediaItem_Take* take = GetMediaItemTake(items[0], -1);
+		if (take)
+			cName = (const char*)GetSetMediaItemTakeInfo(take, "P_NAME", NULL);
+		title.AppendFormatted(100, __LOCALIZE_VERFMT("Please wait, analyzing %s...","sws_analysis"), cName ? cName : __LOCALIZE("item","sws_analysis"));
+	}
+	else
+		title.AppendFormatted(100, __LOCALIZE_VERFMT("Please wait, analyzing %d items...","sws_analysis"), iValid);
+	SWS_WaitDlg wait(title.Get(), &analyzeItems.dProgress, NULL, &analyzeItems.bCancel);
 
 	CloseHandle(hThread);
 
-	// restore original window if it was larger than the item's length
-	a->dWindowSize = oldWinSize;
-
-	delete a->pcm;
-	return a->success;
+	bool bSuccess = false;
+	for (int i = 0; i < count; i++)
+	{
+		// restore original window if it was larger than the item's length
+		a[i].dWindowSize = oldWinSizes.Get()[i];
+
+		delete a[i].pcm;
+		a[i].pcm = NULL;
+		a[i].pCancel = NULL;
+		if (analyzeItems.bCancel)
+			a[i].success = false;
+		bSuccess |= a[i].success;
+	}
+	return bSuccess;
 }
 
 void DoAnalyzeItem(COMMAND_T*)
 {
-	WDL_TypedBuf<MediaItem*> items;
-	SWS_GetSelectedMediaItems(&items);
-	bool bDidWork = false;
+	WDL_TypedBuf<MediaItem*> selItems, items;
+	SWS_GetSelectedMediaItems(&selItems);
+	for (int i = 0; i < selItems.GetSize(); i++)
+		if (((PCM_source*)selItems.Get()[i])->GetNumChannels())
+			items.Add(selItems.Get()[i]);
+
+	if (!items.GetSize())
+	{
+		MessageBox(NULL, __LOCALIZE("No items selected to analyze.","sws_analysis"), __LOCALIZE("SWS - Error","sws_analysis"), MB_OK);
+		return;
+	}
+
+	ANALYZE_PCM* a = new ANALYZE_PCM[items.GetSize()];
+	memset(a, 0, sizeof(ANALYZE_PCM) * items.GetSize());
 	for (int i = 0; i < items.GetSize(); i++)
 	{
-		MediaItem* item = items.Get()[i];
-		int iChannels = ((PCM_source*)item)->GetNumChannels();
-		if (iChannels)
-		{
-			bDidWork = true;
-			ANALYZE_PCM a;
-			memset(&a, 0, sizeof(a));
-			a.iChannels = iChannels;
-			a.dPeakVals = new double[iChannels];
-			a.dRMSs     = new double[iChannels];
+		a[i].iChannels = ((PCM_source*)items.Get()[i])->GetNumChannels();
+		a[i].dPeakVals = new double[a[i].iChannels];
+		a[i].dRMSs     = new double[a[i].iChannels];
+	}
 
-			if (AnalyzeItem(item, &a))
-			{
-				WDL_String str;
-				str.Set(__LOCALIZE("Peak level:","sws_analysis"));
-				for (int i = 0; i < iChannels; i++) {
-					str.Append(" ");
-					str.AppendFormatted(50, __LOCALIZE_VERFMT("Channel %d = %.2f dB","sws_analysis"), i+1, VAL2DB(a.dPeakVals[i]));
-				}
-				str.Append("\n");
-				str.Append(__LOCALIZE("RMS level:","sws_analysis"));
-				for (int i = 0; i < iChannels; i++) {
-					str.Append(" ");
-					str.AppendFormatted(50, __LOCALIZE_VERFMT("Channel %d = %.2f dB","sws_analysis"), i+1, VAL2DB(a.dRMSs[i]));
-				}
-				MessageBox(g_hwndParent, str.Get(), __LOCALIZE("Item analysis","sws_analysis"), MB_OK);
+	if (AnalyzeItems(items.Get(), a, items.GetSize()))
+	{
+		for (int i = 0; i < items.GetSize(); i++)
+		{
+			if (!a[i].success)
+				continue;
+
+			WDL_String str;
+			str.Set(__LOCALIZE("Peak level:","sws_analysis"));
+			for (int j = 0; j < a[i].iChannels; j++) {
+				str.Append(" ");
+				str.AppendFormatted(50, __LOCALIZE_VERFMT("Channel %d = %.2f dB","sws_analysis"), j+1, VAL2DB(a[i].dPeakVals[j]));
+			}
+			str.Append("\n");
+			str.Append(__LOCALIZE("RMS level:","sws_analysis"));
+			for (int j = 0; j < a[i].iChannels; j++) {
+				str.Append(" ");
+				str.AppendFormatted(50, __LOCALIZE_VERFMT("Channel %d = %.2f dB","sws_analysis"), j+1, VAL2DB(a[i].dRMSs[j]));
 			}
-			delete [] a.dPeakVals;
-			delete [] a.dRMSs;
+			MessageBox(g_hwndParent, str.Get(), __LOCALIZE("Item analysis","sws_analysis"), MB_OK);
 		}
 	}
-	if (!bDidWork)
+
+	for (int i = 0; i < items.GetSize(); i++)
 	{
-		MessageBox(NULL, __LOCALIZE("No items selected to analyze.","sws_analysis"), __LOCALIZE("SWS - Error","sws_analysis"), MB_OK);
-		return;
+		delete [] a[i].dPeakVals;
+		delete [] a[i].dRMSs;
 	}
+	delete [] a;
 }
 
 void FindItemPeak(COMMAND_T*)
 {
-	// Just use the first item
-	MediaItem* item = GetSelectedMediaItem(NULL, 0);
-	if (item)
+	// Analyze all selected items, cursor goes to the highest peak (first item wins on equal peaks)
+	WDL_TypedBuf<MediaItem*> items;
+	SWS_GetSelectedMediaItems(&items);
+	if (!items.GetSize())
 	{
-		ANALYZE_PCM a;
-		memset(&a, 0, sizeof(a));
-		if (AnalyzeItem(item, &a))
+		MessageBox(NULL, __LOCALIZE("No items selected to analyze.","sws_analysis"), __LOCALIZE("SWS - Error","sws_analysis"), MB_OK);
+		return;
+	}
+
+	ANALYZE_PCM* a = new ANALYZE_PCM[items.GetSize()];
+	memset(a, 0, sizeof(ANALYZE_PCM) * items.GetSize());
+	if (AnalyzeItems(items.Get(), a, items.GetSize()))
+	{
+		int iPeakItem = -1;
+		for (int i = 0; i < items.GetSize(); i++)
+			if (a[i].success && (iPeakItem == -1 || a[i].dPeakVal > a[iPeakItem].dPeakVal))
+				iPeakItem = i;
+
+		if (iPeakItem != -1)
 		{
+			MediaItem* item = items.Get()[iPeakItem];
 			double dSrate = ((PCM_source*)item)->GetSampleRate();
 			double dPos = *(double*)GetSetMediaItemInfo(item, "D_POSITION", NULL);
-			dPos += a.peakSample / dSrate;
+			dPos += a[iPeakItem].peakSample / dSrate;
 			SetEditCurPos(dPos, true, false);
 		}
 	}
-	else
-		MessageBox(NULL, __LOCALIZE("No items selected to analyze.","sws_analysis"), __LOCALIZE("SWS - Error","sws_analysis"), MB_OK);
+	delete [] a;
 }
 
 void OrganizeByVol(COMMAND_T* ct)
 {
+	// Gather items of all tracks first so they can get analyzed in one go
+	WDL_TypedBuf<MediaItem*> items;
+	WDL_TypedBuf<int> trackStarts; // index of the first item of each track in items, last entry is the end
 	for (int iTrack = 1; iTrack <= GetNumTracks(); iTrack++)
 	{
-		WDL_TypedBuf<MediaItem*> items;
-		SWS_GetSelectedMediaItemsOnTrack(&items, CSurf_TrackFromID(iTrack, false));
-		if (items.GetSize() > 1)
+		WDL_TypedBuf<MediaItem*> trackItems;
+		SWS_GetSelectedMediaItemsOnTrack(&trackItems, CSurf_TrackFromID(iTrack, false));
+		if (trackItems.GetSize() > 1)
 		{
-			double dStart = *(double*)GetSetMediaItemInfo(items.Get()[0], "D_POSITION", NULL);
-			double* pVol = new double[items.GetSize()];
-			ANALYZE_PCM a;
-			memset(&a, 0, sizeof(a));
-			if (ct->user == 2)
-			{	// Windowed mode, set the window size
-				GetRMSOptions(NULL, &a.dWindowSize);
-			}
-			for (int i = 0; i < items.GetSize(); i++)
-			{
-				pVol[i] = -1.0;
-				if (AnalyzeItem(items.Get()[i], &a))
-					pVol[i] = ct->user ? a.dRMS : a.dPeakVal;
-			}
-			// Sort and arrange items from min to max RMS
-			while (true)
-			{
-				int iItem = -1;
-				double dMinVol = 1e99;
-				for (int i = 0; i < items.GetSize(); i++)
-					if (pVol[i] >= 0.0 && pVol[i] < dMinVol)
-					{
-						dMinVol = pVol[i];
-						iItem = i;
-					}
-				if (iItem == -1)
-					break;
-				pVol[iItem] = -1.0;
-				GetSetMediaItemInfo(items.Get()[iItem], "D_POSITION", &dStart);
-				dStart += *(double*)GetSetMediaItemInfo(items.Get()[iItem], "D_LENGTH", NULL);
-			}
-			delete [] pVol;
-			UpdateTimeline();
-			Undo_OnStateChangeEx(SWS_CMD_SHORTNAME(ct), UNDO_STATE_ITEMS, -1);
+			trackStarts.Add(items.GetSize());
+			for (int i = 0; i < trackItems.GetSize(); i++)
+				items.Add(trackItems.Get()[i]);
 		}
 	}
+	if (!items.GetSize())
+		return;
+	trackStarts.Add(items.GetSize());
+
+	ANALYZE_PCM* a = new ANALYZE_PCM[items.GetSize()];
+	memset(a, 0, sizeof(ANALYZE_PCM) * items.GetSize());
+	if (ct->user == 2)
+	{	// Windowed mode, set the window size
+		double dWindowSize;
+		GetRMSOptions(NULL, &dWindowSize);
+		for (int i = 0; i < items.GetSize(); i++)
+			a[i].dWindowSize = dWindowSize;
+	}
+	if (!AnalyzeItems(items.Get(), a, items.GetSize()))
+	{
+		delete [] a;
+		return;
+	}
+
+	double* pVol = new double[items.GetSize()];
+	for (int i = 0; i < items.GetSize(); i++)
+		pVol[i] = a[i].success ? (ct->user ? a[i].dRMS : a[i].dPeakVal) : -1.0;
+
+	for (int iTrack = 0; iTrack < trackStarts.GetSize() - 1; iTrack++)
+	{
+		const int iFirst = trackStarts.Get()[iTrack];
+		const int iLast = trackStarts.Get()[iTrack + 1];
+		double dStart = *(double*)GetSetMediaItemInfo(items.Get()[iFirst], "D_POSITION", NULL);
+
+		// Sort and arrange items from min to max RMS
+		while (true)
+		{
+			int iItem = -1;
+			double dMinVol = 1e99;
+			for (int i = iFirst; i < iLast; i++)
+				if (pVol[i] >= 0.0 && pVol[i] < dMinVol)
+				{
+					dMinVol = pVol[i];
+					iItem = i;
+				}
+			if (iItem == -1)
+				break;
+			pVol[iItem] = -1.0;
+			GetSetMediaItemInfo(items.Get()[iItem], "D_POSITION", &dStart);
+			dStart += *(double*)GetSetMediaItemInfo(items.Get()[iItem], "D_LENGTH", NULL);
+		}
+	}
+	delete [] pVol;
+	delete [] a;
+
+	UpdateTimeline();
+	Undo_OnStateChangeEx(SWS_CMD_SHORTNAME(ct), UNDO_STATE_ITEMS, -1);
 }
 
 void RMSNormalize(double dTargetDb, double dWindowSize)
@@ -336,22 +596,35 @@ void RMSNormalize(double dTargetDb, double dWindowSize)
 	WDL_TypedBuf<MediaItem*> items;
 	SWS_GetSelectedMediaItems(&items);
 	bool bDidWork = false;
-	ANALYZE_PCM a;
-	memset(&a, 0, sizeof(a));
-	a.dWindowSize = dWindowSize;
+	if (!items.GetSize())
+		return;
 
+	ANALYZE_PCM* a = new ANALYZE_PCM[items.GetSize()];
+	memset(a, 0, sizeof(ANALYZE_PCM) * items.GetSize());
+	for (int i = 0; i < items.GetSize(); i++)
+		a[i].dWindowSize = dWindowSize;
+	if (!AnalyzeItems(items.Get(), a, items.GetSize()))
+	{
+		delete [] a;
+		return;
+	}
+
+	PreventUIRefresh(1);
 	for (int i = 0; i < items.GetSize(); i++)
 	{
 		MediaItem* item = items.Get()[i];
 		MediaItem_Take* take = GetMediaItemTake(item, -1);
-		if (take && AnalyzeItem(item, &a) && a.dRMS != 0.0)
+		if (take && a[i].success && a[i].dRMS != 0.0)
 		{
 			bDidWork = true;
 			double dVol = *(double*)GetSetMediaItemTakeInfo(take, "D_VOL", NULL);
-			dVol *= DB2VAL(dTargetDb) / a.dRMS;
+			dVol *= DB2VAL(dTargetDb) / a[i].dRMS;
 			GetSetMediaItemTakeInfo(take, "D_VOL", &dVol);
 		}
 	}
+	PreventUIRefresh(-1);
+	delete [] a;
+
 	if (bDidWork)
 	{
 		UpdateTimeline();
@@ -364,20 +637,31 @@ void RMSNormalizeAll(double dTargetDb, double dWindowSize)
 	WDL_TypedBuf<MediaItem*> items;
 	SWS_GetSelectedMediaItems(&items);
 	double dMaxRMS = -DBL_MAX;
-	ANALYZE_PCM a;
-	memset(&a, 0, sizeof(a));
-	a.dWindowSize = dWindowSize;
+	if (!items.GetSize())
+		return;
+
+	ANALYZE_PCM* a = new ANALYZE_PCM[items.GetSize()];
+	memset(a, 0, sizeof(ANALYZE_PCM) * items.GetSize());
+	for (int i = 0; i < items.GetSize(); i++)
+		a[i].dWindowSize = dWindowSize;
+	if (!AnalyzeItems(items.Get(), a, items.GetSize()))
+	{
+		delete [] a;
+		return;
+	}
 
 	for (int i = 0; i < items.GetSize(); i++)
 	{
 		MediaItem* item = items.Get()[i];
 		MediaItem_Take* take = GetMediaItemTake(item, -1);
-		if (take && AnalyzeItem(item, &a) && a.dRMS != 0.0 && a.dRMS > dMaxRMS)
-			dMaxRMS = a.dRMS;
+		if (take && a[i].success && a[i].dRMS != 0.0 && a[i].dRMS > dMaxRMS)
+			dMaxRMS = a[i].dRMS;
 	}
+	delete [] a;
 
 	if (dMaxRMS > -DBL_MAX)
 	{
+		PreventUIRefresh(1);
 		for (int i = 0; i < items.GetSize(); i++)
 		{
 			MediaItem* item = items.Get()[i];
@@ -389,6 +673,7 @@ void RMSNormalizeAll(double dTargetDb, double dWindowSize)
 				GetSetMediaItemTakeInfo(take, "D_VOL", &dVol);
 			}
 		}
+		PreventUIRefresh(-1);
 		UpdateTimeline();
 		Undo_OnStateChangeEx(__LOCALIZE("Normalize items to RMS","sws_undo"), UNDO_STATE_ITEMS, -1);
 	}
@@ -46,12 +46,38 @@ typedef struct ANALYZE_PCM
 	double dProgress;       // out Analysis progress, 0.0-1.0 for 0-100%
 	INT64 sampleCount;      // out # of samples analyzed
 	double dWindowSize;     // RMS window in seconds.  If this is != 0.0, then RMS is calculated/returned as max within window
+	bool* pCancel;          // in  Analysis stops (unsuccessfully) as soon as this is set to true (optional, set by AnalyzeItems)
 	bool success;
 } ANALYZE_PCM;
 
+// Streaming peak/RMS analyzer, feed it interleaved blocks of any size.
+// windowLen == 0 gets RMS of everything processed, otherwise max RMS within windowLen samples.
+// Positions of windowed RMS point to the window start (can be negative while the window is filling up).
+class SWS_LevelAnalyzer
+{
+public:
+	SWS_LevelAnalyzer(int nch, int windowLen);
+	bool IsValid();
+	void Process(const ReaSample* buf, int frames);
+	INT64 GetSampleCount() { return m_sampleCount; }
+	double GetPeak(int chan, INT64* pos = NULL); // chan < 0 for max of all channels
+	double GetRMS(int chan, INT64* pos = NULL);  // chan < 0 for all channels combined (max of all channels in windowed mode)
+
+private:
+	int m_nch, m_windowLen, m_windowPos;
+	INT64 m_sampleCount;
+	WDL_TypedBuf<ReaSample> m_window; // windowed mode history, channel after channel
+	WDL_TypedBuf<double> m_sumSquares;
+	WDL_TypedBuf<double> m_maxSumSquares;
+	WDL_TypedBuf<INT64> m_maxSumSquaresPos;
+	WDL_TypedBuf<double> m_peaks;
+	WDL_TypedBuf<INT64> m_peakPos;
+};
+
 int AnalysisInit();
 
 bool AnalyzeItem(MediaItem* mi, ANALYZE_PCM* a);
+bool AnalyzeItems(MediaItem** items, ANALYZE_PCM* a, int count); // a[i] is set up like for AnalyzeItem(), analyzes all items in parallel, false if nothing succeeded or user cancelled
 
 // #781 Export to ReaScript
 void NF_GetRMSOptions(double *targetOut, double *winSizeOut);
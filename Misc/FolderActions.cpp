@@ -63,23 +63,37 @@ void TogMuteChildren(COMMAND_T* = NULL)
 // Set selected track(s) folder depth to the same folder depth as the previous track(s)
 void FolderLikePrev(COMMAND_T* = NULL)
 {
-	MediaTrack* prevTr = CSurf_TrackFromID(1, false);
+	const SWS_FolderTree* tree = SWS_FolderTree::Get();
+	MediaTrack* prevTr = tree->GetTrack(1);
+	int prevType, prevDepth = tree->GetDepth(1, &prevType);
+	int iLastFolder = prevType <= 1 ? prevType : 0; // depths are updated here as in SWS_FolderTree::Build()
 	bool bUndo = false;
-	MediaTrack* gfd = NULL;
-	for (int i = 2; i <= GetNumTracks(); i++)
+	for (int i = 2; i < tree->GetCount(); i++)
 	{
-		MediaTrack* tr = CSurf_TrackFromID(i, false);
-		int iDelta;
-		if (*(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL) && GetFolderDepth(prevTr, NULL, &gfd) != GetFolderDepth(tr, &iDelta, &gfd))
+		MediaTrack* tr = tree->GetTrack(i);
+		int iType = tree->GetType(i);
+		int iDepth = iType <= 1 ? iLastFolder : -1;
+		if (*(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL) && prevDepth != iDepth)
 		{
-			GetSetMediaTrackInfo(tr, "I_FOLDERDEPTH", GetSetMediaTrackInfo(prevTr, "I_FOLDERDEPTH", NULL));
+			GetSetMediaTrackInfo(tr, "I_FOLDERDEPTH", &prevType);
 			GetSetMediaTrackInfo(prevTr, "I_FOLDERDEPTH", &g_i0);
+			if (prevType <= 1)
+				iLastFolder -= prevType; // the previous track is not a parent anymore
+			iType = prevType;
+			iDepth = iType <= 1 ? iLastFolder : -1;
 			bUndo = true;
 		}
+		if (iType <= 1)
+			iLastFolder += iType;
 		prevTr = tr;
+		prevType = iType;
+		prevDepth = iDepth;
 	}
 	if (bUndo)
+	{
+		SWS_FolderTree::Invalidate(); // once for all changed tracks, no undo point yet
 		Undo_OnStateChangeEx(__LOCALIZE("Set selected track(s) to same folder as previous track","sws_undo"), UNDO_STATE_TRACKCFG | UNDO_STATE_MISCCFG, -1);
+	}
 }
 
 void MakeFolder(COMMAND_T* = NULL)
@@ -162,14 +176,12 @@ void IndentTracks(COMMAND_T *cmd)
 
 void CollapseFolder(COMMAND_T* ct)
 {
-	MediaTrack* gfd = NULL;
+	const SWS_FolderTree* tree = SWS_FolderTree::Get();
 	int iCompact = (int)ct->user;
-	for (int i = 1; i <= GetNumTracks(); i++)
+	for (int i = 1; i < tree->GetCount(); i++)
 	{
-		MediaTrack* tr = CSurf_TrackFromID(i, false);
-		int iType;
-		GetFolderDepth(tr, &iType, &gfd);
-		if (*(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL) && iType == 1)
+		MediaTrack* tr = tree->GetTrack(i);
+		if (*(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL) && tree->GetType(i) == 1)
 			GetSetMediaTrackInfo(tr, "I_FOLDERCOMPACT", &iCompact);
 	}
 	UpdateTimeline();
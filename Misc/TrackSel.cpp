@@ -435,25 +435,18 @@ int RoutedTracks(MediaTrack* tr, WDL_PtrList<void>* pTracks)
 		}
 
 	// Then check folders
-	int iType;
-	MediaTrack* pNext = NULL;
-	int iDepth = GetFolderDepth(tr, &iType, &pNext);
-	if (iType == 1)
+	const SWS_FolderTree* tree = SWS_FolderTree::Get();
+	const int id = tree->GetId(tr);
+	if (tree->GetType(id) == 1)
 	{
-		int iChild = CSurf_TrackToID(tr, false)+1;
-		while(true)
+		const int iDepth = tree->GetDepth(id);
+		for (int iChild = id + 1; iChild <= tree->GetLastDescendant(id); iChild++)
 		{
-			MediaTrack* pChild = CSurf_TrackFromID(iChild, false);
-			if (!pChild)
-				break;
-			int iChildDepth = GetFolderDepth(pChild, NULL, &pNext);
-			if (iChildDepth == iDepth + 1 &&
+			MediaTrack* pChild = tree->GetTrack(iChild);
+			if (tree->GetDepth(iChild) == iDepth + 1 &&
 				*(bool*)GetSetMediaTrackInfo(pChild, "B_MAINSEND", NULL) &&
 				!*(bool*)GetSetMediaTrackInfo(pChild, "B_MUTE", NULL))
 				pTracks->Add(pChild);
-			if (iChildDepth <= iDepth)
-				break;
-			iChild++;
 		}
 	}
 
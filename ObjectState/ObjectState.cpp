@@ -38,6 +38,13 @@
 
 //#define GOS_DEBUG
 
+// Counters of all caches, see SWS_GetObjectStateCacheStats()
+static struct
+{
+	int iHits, iMisses, iWrites, iSkippedWrites;
+	double dBytesWritten;
+} g_objStateStats;
+
 ObjectStateCache::ObjectStateCache():m_iUseCount(1)
 {
 }
@@ -52,17 +59,22 @@ void ObjectStateCache::WriteCache()
 #ifdef GOS_DEBUG
 	int iCount = 0;
 #endif
-	for (int i = 0; i < m_obj.GetSize(); i++)
+	for (int i = 0; i < m_entries.GetSize(); i++)
 	{
-		if (m_str.Get(i)->GetLength() && m_orig.Get(i) && strcmp(m_str.Get(i)->Get(), m_orig.Get(i)))
+		Entry* e = m_entries.Get(i);
+		if (e->dirty)
 		{
-			int fxstate = SNM_PreObjectState(m_str.Get(i), false);
-			GetSetObjectState(m_obj.Get(i), m_str.Get(i)->Get());
+			int fxstate = SNM_PreObjectState(&e->str, false);
+			GetSetObjectState(e->obj, e->str.Get());
 			SNM_PostObjectState(fxstate);
+			g_objStateStats.iWrites++;
+			g_objStateStats.dBytesWritten += e->str.GetLength();
 #ifdef GOS_DEBUG
 			iCount++;
 #endif
 		}
+		else if (e->str.GetLength())
+			g_objStateStats.iSkippedWrites++;
 	}
 #ifdef GOS_DEBUG
 	dprintf("ObjectStateCache::WriteCache applied %d chunks.\n", iCount);
@@ -73,39 +85,58 @@ void ObjectStateCache::WriteCache()
 
 void ObjectStateCache::EmptyCache()
 {
-	m_obj.Empty();
-	m_str.Empty(true);
-	m_orig.Empty(true, FreeHeapPtr);
+	for (int i = 0; i < m_entries.GetSize(); i++)
+	{
+		Entry* e = m_entries.Get(i);
+		if (e->orig)
+			FreeHeapPtr(e->orig);
+		delete e;
+	}
+	m_entries.Empty();
+	m_objs.clear();
 }
 
 const char* ObjectStateCache::GetSetObjState(void* obj, const char* str, bool wantsMinimalState)
 {
-	int i = m_obj.Find(obj);
-	if (i < 0)
+	Entry* e;
+	std::unordered_map<void*, Entry*>::iterator it = m_objs.find(obj);
+	if (it != m_objs.end())
 	{
-		i = m_obj.GetSize();
-		m_obj.Add(obj);
-		m_str.Add(new WDL_FastString);
-		if (str && str[0])
-			m_orig.Add(NULL);
-		else
+		e = it->second;
+		g_objStateStats.iHits++;
+	}
+	else
+	{
+		e = new Entry;
+		e->obj = obj;
+		e->orig = NULL;
+		e->origLen = 0;
+		e->dirty = false;
+		if (!str || !str[0])
 		{
 			int fxstate = SNM_PreObjectState(NULL, wantsMinimalState);
-			char* p = GetSetObjectState(obj, NULL);
+			e->orig = GetSetObjectState(obj, NULL);
 			SNM_PostObjectState(fxstate);
-			m_orig.Add(p);
+			e->origLen = e->orig ? (int)strlen(e->orig) : 0;
+			g_objStateStats.iMisses++;
 		}
+		m_entries.Add(e);
+		m_objs[obj] = e;
 	}
+
 	if (str && str[0])
 	{
-		m_str.Get(i)->Set(str);
+		// Only compare the contents when the lengths match, edits usually change them
+		const int len = (int)strlen(str);
+		e->str.Set(str, len);
+		e->dirty = !e->orig || len != e->origLen || memcmp(str, e->orig, len);
 		return NULL;
 	}
 
-	if (m_str.Get(i)->GetLength())
-		return m_str.Get(i)->Get();
+	if (e->str.GetLength())
+		return e->str.Get();
 	else
-		return m_orig.Get(i);
+		return e->orig;
 }
 
 ObjectStateCache* g_objStateCache = NULL;
@@ -172,6 +203,16 @@ void SWS_CacheObjectState(bool bStart)
 	}
 }
 
+// Hits: states read from a cache, misses: states read from REAPER
+// Skipped writes: cached states set but identical to the original ones
+void SWS_GetObjectStateCacheStats(WDL_FastString* str, bool bReset)
+{
+	str->SetFormatted(512, "Object state cache: %d hits, %d misses, %d writes (%.0f bytes), %d skipped writes\n",
+		g_objStateStats.iHits, g_objStateStats.iMisses, g_objStateStats.iWrites, g_objStateStats.dBytesWritten, g_objStateStats.iSkippedWrites);
+	if (bReset)
+		memset(&g_objStateStats, 0, sizeof(g_objStateStats));
+}
+
 // Helper function for parsing object "chunks" into more useful lines
 // newlines are retained.  Caller allocates the WDL_FastString necessary for the output
 // pos stores the state of the line parsing, set to zero to return the first line
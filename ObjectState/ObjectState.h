@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <unordered_map>
+
 class ObjectStateCache
 {
 public:
@@ -38,15 +40,23 @@ public:
 	const char* GetSetObjState(void* obj, const char* str, bool wantsMinimalState = false);
 	int m_iUseCount;
 private:
-	WDL_PtrList<void> m_obj;
-	WDL_PtrList<WDL_FastString> m_str;
-	WDL_PtrList<char> m_orig;
+	struct Entry
+	{
+		void* obj;
+		WDL_FastString str; // modified state, empty if none
+		char* orig;         // original state (NULL if never read)
+		int origLen;
+		bool dirty;         // str differs from orig
+	};
+	WDL_PtrList<Entry> m_entries; // in order of first access
+	std::unordered_map<void*, Entry*> m_objs;
 };
 
 const char* SWS_GetSetObjectState(void* obj, WDL_FastString* str, bool wantsMinimalState = false);
 void SWS_FreeHeapPtr(void* ptr);
 void SWS_FreeHeapPtr(const char* ptr);
 void SWS_CacheObjectState(bool bStart);
+void SWS_GetObjectStateCacheStats(WDL_FastString* str, bool bReset = false);
 
 bool GetChunkLine(const char* chunk, char* line, int iLineMax, int* pos, bool bNewLine);
 void AppendChunkLine(WDL_FastString* chunk, const char* line);
@@ -60,6 +60,7 @@ void SNM_CSurfRun()
 	StopTrackPreviewsRun();
 	UpdateMarkerRegionRun();
 	AutoRefreshToolbarRun();
+	SNM_OscCSurfFlushAll();
 
 	sRecurseCheck = false;
 }
@@ -114,67 +115,157 @@ int SNM_CSurfExtended(int _call, void* _parm1, void* _parm2, void* _parm3)
 // OSC feedtack
 ///////////////////////////////////////////////////////////////////////////////
 
-bool SNM_OscCSurf::SendStr(const char* _msg, const char* _oscArg, int _msgArg)
+// csurfs with queued messages (sockets remain open when not listed here)
+static WDL_PtrList<SNM_OscCSurf> g_oscSenders;
+
+// called from SNM_CSurfRun(): one bundle (or more when exceeding m_maxOut) per tick
+void SNM_OscCSurfFlushAll()
 {
-	if (_msg && *_msg && _oscArg)
+	for (int i=g_oscSenders.GetSize()-1; i>=0; i--) // Flush() can unlist csurfs
+		if (SNM_OscCSurf* osc = g_oscSenders.Get(i))
+			osc->Flush();
+}
+
+SNM_OscCSurf::~SNM_OscCSurf()
+{
+	Disconnect();
+	if (m_pending.GetSize())
+		g_oscSenders.Delete(g_oscSenders.Find(this), false);
+}
+
+bool SNM_OscCSurf::Connect()
+{
+	if (m_sock && m_sock->isOk())
+		return true;
+
+	Disconnect();
+	m_sock = new oscpkt::UdpSocket;
+	m_sock->connectTo(m_ipOut.Get(), m_portOut);
+	if (m_sock->isOk())
+		return true;
+
+	Disconnect(); // retried on next flush
+	return false;
+}
+
+void SNM_OscCSurf::Disconnect()
+{
+	DELETE_NULL(m_sock);
+}
+
+// a newer value for an already queued address replaces the older one
+// (in place, so that the sending order of addresses is preserved)
+void SNM_OscCSurf::Queue(const char* _msg, const char* _oscArg)
+{
+	for (int i=0; i<m_pending.GetSize(); i+=2)
 	{
-		oscpkt::UdpSocket sock;
-		sock.connectTo(m_ipOut.Get(), m_portOut);
-		if (sock.isOk())
+		if (!strcmp(m_pending.Get(i)->Get(), _msg))
 		{
-			WDL_FastString msg(_msg);
-			if (_msgArg>=0)
-				msg.SetFormatted(SNM_MAX_OSC_MSG_LEN, _msg, _msgArg);
-
-			oscpkt::Message oscMsg(msg.Get());
-			oscMsg.pushStr(_oscArg);
-			oscpkt::PacketWriter pw;
-			pw.startBundle();
-			pw.addMessage(oscMsg);
-			pw.endBundle();
-			if ((int)pw.packetSize() < m_maxOut) // C4018
-				return sock.sendPacket(pw.packetData(), pw.packetSize());
+			m_pending.Get(i+1)->Set(_oscArg);
+			return;
 		}
 	}
+	m_pending.Add(new WDL_FastString(_msg));
+	m_pending.Add(new WDL_FastString(_oscArg));
+
+	if (g_oscSenders.Find(this) < 0)
+		g_oscSenders.Add(this);
+}
+
+bool SNM_OscCSurf::SendStr(const char* _msg, const char* _oscArg, int _msgArg)
+{
+	if (_msg && *_msg && _oscArg)
+	{
+		WDL_FastString msg(_msg);
+		if (_msgArg>=0)
+			msg.SetFormatted(SNM_MAX_OSC_MSG_LEN, _msg, _msgArg);
+		Queue(msg.Get(), _oscArg);
+		return true;
+	}
 	return false;
 }
 
+// _strs: msg/arg pairs
 bool SNM_OscCSurf::SendStrBundle(WDL_PtrList<WDL_FastString> * _strs)
 {
 	if (_strs && _strs->GetSize())
 	{
-		oscpkt::UdpSocket sock;
-		sock.connectTo(m_ipOut.Get(), m_portOut);
-		if (sock.isOk())
+		for (int i=0; i<_strs->GetSize(); i+=2)
 		{
-			// build osc messages
-			WDL_PtrList_DeleteOnDestroy<oscpkt::Message> msgs; // for "auto-deletion"
-			for (int i=0; i<_strs->GetSize(); i+=2)
+			WDL_FastString* msg = _strs->Get(i);
+			WDL_FastString* oscArg = _strs->Get(i+1);
+			if (!msg || !oscArg)
+				return false;
+			if (msg->GetLength())
+				Queue(msg->Get(), oscArg->Get());
+		}
+		return true;
+	}
+	return false;
+}
+
+// sends queued messages, split into several bundles of less than m_maxOut bytes
+// if needed (a single message exceeding m_maxOut is dropped, as it always was).
+// with m_waitOut > 0, at most one bundle is sent every m_waitOut ms: remaining
+// messages stay queued (and can still be superseded) until the next tick
+bool SNM_OscCSurf::Flush()
+{
+	if (!m_pending.GetSize())
+		return true;
+
+	if (m_waitOut>0 && (GetTickCount()-m_lastSendTime) < (DWORD)m_waitOut)
+		return true;
+
+	if (!Connect())
+		return false;
+
+	const int bundleHeaderSize = 16; // "#bundle\0" + time tag
+	bool ok = true;
+	int sent = 0; // number of msg/arg pairs consumed
+	while (sent < m_pending.GetSize())
+	{
+		oscpkt::PacketWriter pw;
+		pw.startBundle();
+		int size = bundleHeaderSize, i = sent;
+		for (; i<m_pending.GetSize(); i+=2)
+		{
+			oscpkt::Message oscMsg(m_pending.Get(i)->Get());
+			oscMsg.pushStr(m_pending.Get(i+1)->Get());
+
+			oscpkt::PacketWriter one;
+			one.startBundle().addMessage(oscMsg).endBundle();
+			const int msgSize = (int)one.packetSize() - bundleHeaderSize;
+			if (size + msgSize >= m_maxOut)
 			{
-				if (WDL_FastString* msg = _strs->Get(i))
-				{
-					oscpkt::Message* oscMsg = msgs.Add(new oscpkt::Message(msg->Get()));
-					if (WDL_FastString* oscArg = _strs->Get(i+1))
-						oscMsg->pushStr(oscArg->Get());
-					else
-						return false;
-				}
+				if (i == sent) i += 2; // too big on its own: drop it
+				break;
 			}
+			size += msgSize;
+			pw.addMessage(oscMsg);
+		}
+		pw.endBundle();
 
-			// bundle & send osc messages
-			if (msgs.GetSize())
+		sent = i;
+		if (size > bundleHeaderSize)
+		{
+			if (!m_sock->sendPacket(pw.packetData(), pw.packetSize()))
 			{
-				oscpkt::PacketWriter pw;
-				pw.startBundle();
-				for (int i=0; i<msgs.GetSize(); i++)
-					pw.addMessage(*msgs.Get(i));
-				pw.endBundle();
-				if ((int)pw.packetSize() < m_maxOut) // C4018
-					return sock.sendPacket(pw.packetData(), pw.packetSize());
+				ok = false; // bundle lost, like before
+				Disconnect(); // reconnect on next flush
+				break;
 			}
+			m_lastSendTime = GetTickCount();
 		}
+
+		if (m_waitOut>0)
+			break;
 	}
-	return false;
+
+	for (int i=sent-1; i>=0; i--)
+		m_pending.Delete(i, true);
+	if (!m_pending.GetSize())
+		g_oscSenders.Delete(g_oscSenders.Find(this), false);
+	return ok;
 }
 
 bool SNM_OscCSurf::Equals(SNM_OscCSurf* _osc)
@@ -40,17 +40,24 @@ int SNM_CSurfExtended(int _call, void* _parm1, void* _parm2, void* _parm3);
 
 
 // osc csurf feedback
+// messages are queued and sent as bundles on the next SNM_CSurfRun() tick
+// through a socket that stays open for the lifetime of the csurf
+namespace oscpkt { struct UdpSocket; }
+
 class SNM_OscCSurf {
 public:
 	SNM_OscCSurf(const char* _name, int _flags, int _portIn, const char* _ipOut, int _portOut, int _maxOut, int _waitOut, const char* _layout)
 		: m_name(_name), m_flags(_flags), m_portIn(_portIn), 
-		m_ipOut(_ipOut), m_portOut(_portOut), m_maxOut(_maxOut), m_waitOut(_waitOut), m_layout(_layout) {}
+		m_ipOut(_ipOut), m_portOut(_portOut), m_maxOut(_maxOut), m_waitOut(_waitOut), m_layout(_layout),
+		m_sock(NULL), m_lastSendTime(0) {}
 	SNM_OscCSurf(SNM_OscCSurf* _osc)
 		: m_name(&_osc->m_name), m_flags(_osc->m_flags), m_portIn(_osc->m_portIn), 
-		m_ipOut(&_osc->m_ipOut), m_portOut(_osc->m_portOut), m_maxOut(_osc->m_maxOut), m_waitOut(_osc->m_waitOut), m_layout(&_osc->m_layout) {}
-	~SNM_OscCSurf() {}
+		m_ipOut(&_osc->m_ipOut), m_portOut(_osc->m_portOut), m_maxOut(_osc->m_maxOut), m_waitOut(_osc->m_waitOut), m_layout(&_osc->m_layout),
+		m_sock(NULL), m_lastSendTime(0) {}
+	~SNM_OscCSurf();
 	bool SendStr(const char* _msg, const char* _oscArg, int _msgArg = -1);
 	bool SendStrBundle(WDL_PtrList<WDL_FastString> * _strs);
+	bool Flush();
 	bool Equals(SNM_OscCSurf* _osc);
 
 	WDL_FastString m_name;
@@ -59,8 +66,21 @@ public:
 	WDL_FastString m_ipOut;
 	int m_portOut, m_maxOut, m_waitOut;
 	WDL_FastString m_layout;
+
+private:
+	SNM_OscCSurf(const SNM_OscCSurf&); // no copy: owns a socket
+	SNM_OscCSurf& operator=(const SNM_OscCSurf&);
+	void Queue(const char* _msg, const char* _oscArg);
+	bool Connect();
+	void Disconnect();
+
+	oscpkt::UdpSocket* m_sock;
+	WDL_PtrList_DeleteOnDestroy<WDL_FastString> m_pending; // msg/arg pairs, one per address
+	DWORD m_lastSendTime;
 };
 
+void SNM_OscCSurfFlushAll();
+
 SNM_OscCSurf* LoadOscCSurfs(WDL_PtrList<SNM_OscCSurf>* _out, const char* _name = NULL);
 void AddOscCSurfMenu(HMENU _menu, SNM_OscCSurf* _activeOsc, int _startMsg, int _endMsg);
 
@@ -546,6 +546,7 @@ WDL_FastString* SNM_TakeParserPatcher::GetChunk()
 // GetChunk() comments. Also see important comments for SNM_ChunkParserPatcher::Commit()
 bool SNM_TakeParserPatcher::Commit(bool _force)
 {
+	EndEdits();
 	if (m_reaObject && (m_updates || _force) && m_chunk->GetLength() && !(GetPlayStateEx(NULL) & 4))
 	{
 // SNM_ChunkParserPatcher::Commit() mod ----->
@@ -1,5 +1,5 @@
 /******************************************************************************
-/ SnM_ChunkParserPatcher.h - v1.34
+/ SnM_ChunkParserPatcher.h - v2.0
 /
 / Copyright (c) 2008 and later Jeffos
 /
@@ -40,7 +40,15 @@
 // Important: 
 // - Chunks can be HUGE! e.g. 4Mb+ is an usual case
 // - The code assumes RPP chunks are consistent, left trimmed, with Unix EOL
-// - A v2.0 with major refactoring is on the way
+//
+// v2.0:
+// - Read-only lookups (GetSubChunk(), GetLinePos(), SNM_GET_CHUNK_CHAR, etc..)
+//   are served by an index of the chunk (SNM_ChunkIndex) when a same chunk
+//   is looked up several times, instead of re-parsing it for each lookup
+// - Line edits can be batched (see BeginEdits()) and applied with a single
+//   copy of the chunk
+// - Several lookups can be answered with a single pass, as spans in the
+//   cached chunk (see ParseQueries())
 
 
 #ifndef _SNM_CHUNKPARSERPATCHER_H_
@@ -111,6 +119,357 @@ static int RemoveAllIds(WDL_FastString* _chunk) {
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// SNM_ChunkIndex
+// Line index of a chunk, built in a single pass with the very same rules as
+// SNM_ChunkParserPatcher::ParsePatchCore() (skipped base64/MIDI/FREEZE data,
+// LineParser keywords, truncated lines, depths, parents) so that read-only
+// lookups can be answered without re-parsing the whole chunk
+///////////////////////////////////////////////////////////////////////////////
+
+class SNM_ChunkIndex
+{
+public:
+
+enum {
+	LINE_SKIPPED = 1, // skipped data (base64, in-project MIDI, FREEZE), recopied as is
+	LINE_PIPE    = 2, // line starting with '|', see ParsePatchCore()
+	LINE_KEYWORD = 4  // line with a valid LineParser keyword
+};
+
+struct Entry {
+	int pos, len;   // line start & length ('\n' excluded), or skipped data start & length
+	int depth;      // parsed depth, i.e. number of parents (incl. the line itself for "<..." lines)
+	int parent;     // entry of the parent "<..." line (-1 if none)
+	int end;        // "<..." lines: entry of the matching ">" line (-1 if none)
+	int keyword;    // offset of the line's keyword in m_keywords (-1 if none)
+	int flags;
+};
+
+SNM_ChunkIndex() : m_chunk(NULL), m_buf(NULL), m_len(-1), m_updates(-1), m_revision(-1), m_flags(-1), m_built(false), m_ok(false) {}
+
+// returns true if the index was last updated for _chunk (built or not)
+bool IsFor(const WDL_FastString* _chunk, int _updates, int _revision, bool _processBase64, bool _processInProjectMIDI, bool _processFreeze)
+{
+	const int flags = (_processBase64?1:0) | (_processInProjectMIDI?2:0) | (_processFreeze?4:0);
+	return m_chunk == _chunk && m_buf == _chunk->Get() && m_len == _chunk->GetLength() &&
+		m_updates == _updates && m_revision == _revision && m_flags == flags;
+}
+
+// returns true if the index can be used for _chunk, (re)building it if needed
+// note: the index is only built on the 2nd lookup of a same (unaltered) chunk,
+//       single lookups are faster with ParsePatchCore() that stops on the 1st match
+// _updates, _revision: any update of the chunk must be reflected by these
+bool Update(const WDL_FastString* _chunk, int _updates, int _revision, bool _processBase64, bool _processInProjectMIDI, bool _processFreeze)
+{
+	if (IsFor(_chunk, _updates, _revision, _processBase64, _processInProjectMIDI, _processFreeze))
+	{
+		if (!m_built)
+			Build();
+		return m_ok;
+	}
+
+	m_chunk = _chunk;
+	m_buf = _chunk->Get();
+	m_len = _chunk->GetLength();
+	m_updates = _updates;
+	m_revision = _revision;
+	m_flags = (_processBase64?1:0) | (_processInProjectMIDI?2:0) | (_processFreeze?4:0);
+	m_built = m_ok = false;
+	return m_ok;
+}
+
+// returns true if the index is already built and usable for _chunk (never builds it)
+bool IsBuiltFor(const WDL_FastString* _chunk, int _updates, int _revision, bool _processBase64, bool _processInProjectMIDI, bool _processFreeze) {
+	return m_built && m_ok && IsFor(_chunk, _updates, _revision, _processBase64, _processInProjectMIDI, _processFreeze);
+}
+
+int GetSize() { return (int)m_entries.size(); }
+const Entry* Get(int _entry) { return (_entry>=0 && _entry<(int)m_entries.size()) ? &m_entries[_entry] : NULL; }
+
+const char* GetKeyword(int _entry) {
+	const Entry* e = Get(_entry);
+	return (e && e->keyword>=0) ? &m_keywords[e->keyword] : "";
+}
+
+// as ParsePatchCore(): parents are named after their "<..." keyword, '<' excluded
+const char* GetParent(int _entry) {
+	const Entry* e = Get(_entry);
+	return (e && e->parent>=0) ? GetKeyword(e->parent)+1 : "";
+}
+
+// strict match, see IsMatchingParsedLine()
+bool IsMatching(int _entry, int _depth, const char* _parent, const char* _keyword) {
+	const Entry* e = Get(_entry);
+	return e && e->depth>0 && e->depth == _depth && !(e->flags & LINE_PIPE) &&
+		!strcmp(GetParent(_entry), _parent) && !strcmp(GetKeyword(_entry), _keyword);
+}
+
+// returns the entry of the 1st line where ParsePatchCore() would stop because of _breakKeyword
+// (GetSize() if none): lines with a depth, that do not match _depth/_parent/_keyword
+int FindBreak(int _depth, const char* _parent, const char* _keyword, const char* _breakKeyword)
+{
+	if (_breakKeyword)
+	{
+		const unsigned int h = Hash(_breakKeyword);
+		for (std::vector<std::pair<unsigned int,int> >::const_iterator it = LowerBound(h); it != m_lookup.end() && it->first == h; ++it)
+		{
+			const Entry* e = Get(it->second);
+			if (e->depth>0 && !strcmp(GetKeyword(it->second), _breakKeyword) && !IsMatching(it->second, _depth, _parent, _keyword))
+				return it->second;
+		}
+	}
+	return GetSize();
+}
+
+// returns the entry of the _occurence-th matching line before _before (-1 if not found)
+// _count: optional, number of matching lines before _before
+int Find(int _depth, const char* _parent, const char* _keyword, int _occurence, int _before, int* _count = NULL)
+{
+	int occurence = 0;
+	const unsigned int h = Hash(_keyword);
+	for (std::vector<std::pair<unsigned int,int> >::const_iterator it = LowerBound(h); it != m_lookup.end() && it->first == h && it->second < _before; ++it)
+	{
+		if (IsMatching(it->second, _depth, _parent, _keyword))
+		{
+			if (occurence == _occurence)
+				return it->second;
+			occurence++;
+		}
+	}
+	if (_count)
+		*_count = occurence;
+	return -1;
+}
+
+// appends an entry to _out as ParsePatchCore() does in SNM_GET_SUBCHUNK_OR_LINE* modes
+void AppendEntry(int _entry, WDL_FastString* _out)
+{
+	if (const Entry* e = Get(_entry))
+	{
+		if (e->flags & LINE_SKIPPED)
+			_out->Insert(m_buf+e->pos, _out->GetLength(), e->len);
+		else {
+			// (line lengths are > 0 here, i.e. there is a keyword or a '|')
+			_out->Append(m_buf+e->pos, e->len >= SNM_MAX_CHUNK_LINE_LENGTH ? SNM_MAX_CHUNK_LINE_LENGTH-1 : e->len);
+			_out->Append("\n");
+		}
+	}
+}
+
+private:
+
+// single pass, keep in sync with ParsePatchCore()
+void Build()
+{
+	const bool processBase64 = (m_flags&1) != 0, processInProjectMIDI = (m_flags&2) != 0, processFreeze = (m_flags&4) != 0;
+	m_built = m_ok = true;
+	m_entries.clear();
+	m_lookup.clear();
+	m_keywords.clear();
+
+	const char* cData = m_buf;
+	LineParser lp(false);
+	char curLine[SNM_MAX_CHUNK_LINE_LENGTH] = "";
+	std::vector<int> parents; // entries of the parsed "<..." lines
+	bool isParsingSource = false;
+	const char* pEOL = cData-1, *pLine, *pEOSkippedChunk;
+	int curLineLen;
+
+	for(;;)
+	{
+		pLine = pEOL+1;
+		pEOL = strchr(pLine, '\n');
+		if (!pEOL)
+			break;
+
+		curLineLen = (int)(pEOL-pLine);
+
+		pEOSkippedChunk = NULL;
+		if (!processBase64 &&
+			curLineLen>2 && *(pEOL-1)=='=' && *(pEOL-2)=='=')
+		{
+			pEOSkippedChunk = strstr(pLine, ">\n");
+		}
+		else if (!processInProjectMIDI && isParsingSource && (
+			(curLineLen>2 && !_strnicmp(pLine, "E ", 2)) ||
+			(curLineLen>3 && !_strnicmp(pLine, "Em ", 3))))
+		{
+			pEOSkippedChunk = strstr(pLine, "GUID {");
+		}
+		else if (!processFreeze && parents.size()==1 &&
+			curLineLen>8 && !strncmp(pLine, "<FREEZE ", 8))
+		{
+			int skippedLen = FindEndOfSubChunk(pLine, 0);
+			while (skippedLen >= 0)
+			{
+				pEOSkippedChunk = (char*)(pLine+skippedLen);
+				if (!strncmp(pEOSkippedChunk, "<FREEZE ", 8))
+					skippedLen = FindEndOfSubChunk(pLine, skippedLen);
+				else
+					skippedLen = -1;
+			}
+		}
+
+		if (pEOSkippedChunk)
+		{
+			AddEntry((int)(pLine-cData), (int)(pEOSkippedChunk-pLine), &parents, -1, LINE_SKIPPED);
+			pLine = pEOSkippedChunk;
+			pEOL = strchr(pEOSkippedChunk, '\n');
+			if (!pEOL) { // inconsistent chunk
+				m_ok = false;
+				break;
+			}
+			curLineLen = (int)(pEOL-pLine);
+		}
+
+		const int len = curLineLen >= SNM_MAX_CHUNK_LINE_LENGTH ? SNM_MAX_CHUNK_LINE_LENGTH-1 : curLineLen;
+		memcpy(curLine, pLine, len);
+		curLine[len] = '\0';
+
+		// pipe lines are not parsed in SNM_GET_SUBCHUNK_OR_LINE* modes, they are
+		// indexed in any case (their keywords start with '|': no impact on depths)
+		int flags = (*curLine == '|') ? LINE_PIPE : 0;
+		const char* keyword = NULL;
+		if (!lp.parse(curLine) && lp.getnumtokens() && *lp.gettoken_str(0)) {
+			keyword = lp.gettoken_str(0);
+			flags |= LINE_KEYWORD;
+		}
+		if (!flags)
+			continue;
+
+		const int entry = (int)m_entries.size();
+		int keywordPos = -1;
+		if (keyword)
+		{
+			keywordPos = (int)m_keywords.size();
+			m_keywords.insert(m_keywords.end(), keyword, keyword+strlen(keyword)+1);
+			if (!(flags & LINE_PIPE))
+				m_lookup.push_back(std::make_pair(Hash(keyword), entry));
+		}
+
+		if (keyword && *keyword == '<')
+		{
+			isParsingSource |= (lp.getnumtokens()==2 && curLineLen>9 /* e.g. <SOURCE MIDI*/ && !strcmp(keyword+1, "SOURCE"));
+			parents.push_back(entry);
+			AddEntry((int)(pLine-cData), curLineLen, &parents, keywordPos, flags);
+		}
+		else if (keyword && *keyword == '>')
+		{
+			if (parents.size())
+			{
+				if (isParsingSource)
+					isParsingSource = !!strcmp(GetKeyword(parents.back())+1, "SOURCE");
+				m_entries[parents.back()].end = entry;
+				parents.pop_back();
+			}
+			AddEntry((int)(pLine-cData), curLineLen, &parents, keywordPos, flags);
+		}
+		else
+			AddEntry((int)(pLine-cData), curLineLen, &parents, keywordPos, flags);
+	}
+
+	std::stable_sort(m_lookup.begin(), m_lookup.end(), LookupLess);
+}
+
+void AddEntry(int _pos, int _len, std::vector<int>* _parents, int _keyword, int _flags)
+{
+	Entry e;
+	e.pos = _pos;
+	e.len = _len;
+	e.depth = (int)_parents->size();
+	e.parent = _parents->size() ? _parents->back() : -1;
+	e.end = -1;
+	e.keyword = _keyword;
+	e.flags = _flags;
+	m_entries.push_back(e);
+}
+
+// FNV-1a
+static unsigned int Hash(const char* _str) {
+	unsigned int h = 2166136261u;
+	while (*_str) { h ^= (unsigned char)*_str++; h *= 16777619u; }
+	return h;
+}
+
+static bool LookupLess(const std::pair<unsigned int,int>& _a, const std::pair<unsigned int,int>& _b) {
+	return _a.first < _b.first;
+}
+
+std::vector<std::pair<unsigned int,int> >::const_iterator LowerBound(unsigned int _hash) {
+	return std::lower_bound(m_lookup.begin(), m_lookup.end(), std::make_pair(_hash, 0), LookupLess);
+}
+
+	const WDL_FastString* m_chunk;
+	const char* m_buf;
+	int m_len, m_updates, m_revision, m_flags;
+	bool m_built, m_ok;
+	std::vector<Entry> m_entries;
+	std::vector<std::pair<unsigned int,int> > m_lookup; // keyword hash -> entry, sorted by hash (then entry)
+	std::vector<char> m_keywords;                        // null terminated keywords
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SNM_ChunkEdit
+// Pending edit of a chunk, see SNM_ChunkParserPatcher::BeginEdits()
+///////////////////////////////////////////////////////////////////////////////
+
+struct SNM_ChunkEdit {
+	int pos, len; // replaced characters (len==0: insertion)
+	WDL_FastString str;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SNM_ChunkQuery
+// Read-only lookup, see SNM_ChunkParserPatcher::ParseQueries()
+///////////////////////////////////////////////////////////////////////////////
+
+struct SNM_ChunkQuery
+{
+	// in: same as Parse(SNM_GET_CHUNK_CHAR, ...)
+	int depth;
+	const char* parent;
+	const char* keyword;
+	int occurence;            // 0-based
+	int tokenPos;             // 0-based, -1: ignored
+	const char* breakKeyword; // for optimization, optional
+
+	// out: spans in the cached chunk (no copy), valid until the chunk is altered
+	int linePos, lineLen;     // found line, trailing '\n' excluded (-1 if not found)
+	int tokenStart, tokenLen; // token _tokenPos of the found line, quotes excluded (-1 if not found)
+
+	SNM_ChunkQuery(int _depth=1, const char* _parent=NULL, const char* _keyword=NULL, int _occurence=0, int _tokenPos=-1, const char* _breakKeyword=NULL)
+		: depth(_depth), parent(_parent), keyword(_keyword), occurence(_occurence), tokenPos(_tokenPos), breakKeyword(_breakKeyword),
+		  linePos(-1), lineLen(0), tokenStart(-1), tokenLen(0) {}
+
+	bool Found() const { return linePos >= 0; }
+
+	// copies the found token into _buf, returns false if the line was not found
+	// note: as with Parse(SNM_GET_CHUNK_CHAR, ...), a missing token gives ""
+	bool GetToken(const char* _chunk, char* _buf, int _bufSize) const
+	{
+		if (linePos < 0 || !_buf || _bufSize <= 0)
+			return false;
+		const int len = tokenStart < 0 ? 0 : tokenLen < _bufSize ? tokenLen : _bufSize-1;
+		if (len)
+			memcpy(_buf, _chunk+tokenStart, len);
+		_buf[len] = '\0';
+		return true;
+	}
+
+	// copies the found line (incl. trailing '\n') into _str, returns false if not found
+	bool GetLine(const char* _chunk, WDL_FastString* _str) const
+	{
+		if (linePos < 0 || !_str)
+			return false;
+		_str->Set(_chunk+linePos, lineLen+1);
+		return true;
+	}
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // SNM_ChunkParserPatcher
 ///////////////////////////////////////////////////////////////////////////////
@@ -133,6 +492,8 @@ SNM_ChunkParserPatcher(void* _reaObject, bool _autoCommit=true,
 	m_updates = 0;
 	m_autoCommit = _autoCommit;
 	m_breakParsePatch = false;
+	m_editing = false;
+	m_indexRevision = 0;
 	m_processBase64 = _processBase64;
 	m_processInProjectMIDI = _processInProjectMIDI;
 	m_processFreeze = _processFreeze;
@@ -153,6 +514,8 @@ SNM_ChunkParserPatcher(WDL_FastString* _chunk, bool _autoCommit=true,
 	m_updates = 0;
 	m_autoCommit = _autoCommit;
 	m_breakParsePatch = false;
+	m_editing = false;
+	m_indexRevision = 0;
 	m_processBase64 = _processBase64;
 	m_processInProjectMIDI = _processInProjectMIDI;
 	m_processFreeze = _processFreeze;
@@ -229,31 +592,54 @@ virtual WDL_FastString* GetChunk()
 //    the cached chunk directly (or 'manually' alter m_updates)
 
 // clearing the cache is allowed
+// note: pending edits are lost, see BeginEdits()
 void SetChunk(const char* _newChunk, int _updates=1) {
+	m_edits.Empty(true);
 	m_updates = _updates;
+	m_indexRevision++;
 	GetChunk()->Set(_newChunk ? _newChunk : "");
 }
 
+// includes pending edits, see BeginEdits()
 int GetUpdates() {
-	return m_updates;
+	return m_updates + m_edits.GetSize();
 }
 
 int IncUpdates() {
 	m_updates++;
+	m_indexRevision++;
 	return m_updates; // for facility
 }
 
 int SetUpdates(int _updates) {
 	m_updates = _updates;
+	m_indexRevision++;
 	return m_updates; // for facility
 }
 
+// batch edits: ReplaceLine(int,) and InsertAfterBefore() are deferred until
+// EndEdits() and applied with a single copy of the chunk (instead of one
+// memmove of the chunk tail per edit)
+// => positions and lookups keep on referring to the unaltered chunk in between
+//    (e.g. no need to adjust positions or occurrences when removing lines)
+// note: automatically applied by ParsePatch(), Commit() and RemoveLines()
+void BeginEdits() {
+	m_editing = true;
+}
+
+// returns the number of applied edits
+int EndEdits() {
+	m_editing = false;
+	return ApplyEdits();
+}
+
 // no-op if no updates: commit only if needed.
 // when attached to a reaThing*, global protections apply:
 // - no patch while recording 
 // - remove all ids before patching, see SNM_GetSetObjectState()
 virtual bool Commit(bool _force = false)
 {
+	EndEdits();
 	if ((m_updates || _force) && GetChunk()->GetLength())
 	{
 		if (m_reaObject) {
@@ -272,7 +658,7 @@ virtual bool Commit(bool _force = false)
 }
 
 const char* GetInfo() {
-	return "SNM_ChunkParserPatcher - v1.34";
+	return "SNM_ChunkParserPatcher - v2.0";
 }
 
 void SetProcessBase64(bool _enable) {
@@ -343,6 +729,7 @@ bool RemoveSubChunk(const char* _keyword, int _depth, int _occurence, const char
 
 // replace characters in the chunk from _pos to the next eol
 // _str: the replacing string or NULL to remove characters
+// note: deferred when batching edits (returns false if it overlaps a pending edit), see BeginEdits()
 bool ReplaceLine(int _pos, const char* _str = NULL)
 {
 	if (_pos >=0 && GetChunk()->GetLength() > _pos) // + indirectly cache chunk if needed
@@ -352,6 +739,8 @@ bool ReplaceLine(int _pos, const char* _str = NULL)
 		while (pChunk[pos] && pChunk[pos] != '\n') pos++;
 		if (pChunk[pos] == '\n')
 		{
+			if (m_editing)
+				return AddEdit(_pos, (pos+1) - _pos, _str);
 			m_chunk->DeleteSub(_pos, (pos+1) - _pos);
 			if (_str && *_str)
 				m_chunk->Insert(_str, _pos);
@@ -379,6 +768,7 @@ bool RemoveLine(const char* _parent, const char* _keyword, int _depth, int _occu
 // this one is faster but it does not check depth, parent, etc.. 
 // => beware of nested data! (FREEZE sub-chunks, for example)
 int RemoveLines(const char* _removedKeyword, bool _checkBOL = true, int _checkEOLChar = 0) {
+	ApplyEdits();
 	return SetUpdates(RemoveChunkLines(GetChunk(), _removedKeyword, _checkBOL, _checkEOLChar));
 }
 
@@ -386,16 +776,20 @@ int RemoveLines(const char* _removedKeyword, bool _checkBOL = true, int _checkEO
 // this one is faster but it does not check depth, parent, etc.. 
 // => beware of nested data! (FREEZE sub-chunks, for example)
 int RemoveLines(WDL_PtrList<const char>* _removedKeywords, bool _checkBOL = true, int _checkEOLChar = 0) {
+	ApplyEdits();
 	return SetUpdates(RemoveChunkLines(GetChunk(), _removedKeywords, _checkBOL, _checkEOLChar));
 }
 
 //inserts _str either after (_dir=1) or before (_dir=0) _keyword (i.e. at next/previous start of line)
+// note: deferred when batching edits, see BeginEdits()
 bool InsertAfterBefore(int _dir, const char* _str, const char* _parent, const char* _keyword, int _depth, int _occurence, const char* _breakKeyword = NULL)
 {
 	if (_str && *_str && _keyword)
 	{
 		int pos = GetLinePos(_dir, _parent, _keyword, _depth, _occurence, _breakKeyword);
 		if (pos >= 0) {
+			if (m_editing)
+				return AddEdit(pos, 0, _str);
 			m_chunk->Insert(_str, pos);
 			m_updates++;
 			return true;
@@ -427,6 +821,164 @@ int GetLinePos(int _dir, const char* _parent, const char* _keyword, int _depth,
 	return -1;
 }
 
+// answers several read-only lookups with a single pass on the chunk
+// (instead of one Parse(SNM_GET_CHUNK_CHAR, ...) pass per lookup)
+// the pass stops as soon as all queries are found or broken (see SNM_ChunkQuery::breakKeyword)
+// so that lookups at the start of big chunks remain cheap, an already built index is used instead
+// results are spans in the cached chunk, see SNM_ChunkQuery
+// returns the number of found queries
+int ParseQueries(SNM_ChunkQuery* _queries, int _nbQueries)
+{
+	if (!_queries || _nbQueries <= 0)
+		return 0;
+
+	const char* cData = GetChunk() ? GetChunk()->Get() : NULL; // + indirectly cache chunk if needed
+	if (!cData)
+		return 0;
+
+	const bool indexed = m_index.IsBuiltFor(m_chunk, m_updates, m_indexRevision, m_processBase64, m_processInProjectMIDI, m_processFreeze);
+
+	WDL_TypedBuf<int> occurences; // -1: done with this query (found, broken or invalid)
+	int* occ = occurences.Resize(_nbQueries, false);
+	int pending = 0;
+	for (int i=0; i < _nbQueries; i++)
+	{
+		SNM_ChunkQuery* q = &_queries[i];
+		q->linePos = q->tokenStart = -1;
+		q->lineLen = q->tokenLen = 0;
+		occ[i] = -1;
+		if (!q->keyword || !q->parent || q->depth < 1)
+			continue;
+
+		if (indexed && *q->keyword != '|' && !(q->breakKeyword && *q->breakKeyword == '|'))
+		{
+			const int breakEntry = m_index.FindBreak(q->depth, q->parent, q->keyword, q->breakKeyword);
+			if (const SNM_ChunkIndex::Entry* e = m_index.Get(m_index.Find(q->depth, q->parent, q->keyword, q->occurence<0 ? 0 : q->occurence, breakEntry)))
+			{
+				q->linePos = e->pos;
+				q->lineLen = e->len;
+			}
+		}
+		else
+		{
+			occ[i] = 0;
+			pending++;
+		}
+	}
+
+	// single pass for the remaining queries, same matching rules as ParsePatchCore(SNM_GET_CHUNK_CHAR)
+	if (pending)
+	{
+		LineParser lp(false);
+		char curLine[SNM_MAX_CHUNK_LINE_LENGTH] = "";
+		WDL_PtrList_DeleteOnDestroy<WDL_FastString> parents;
+		bool isParsingSource = false;
+		const char* pEOL = cData-1, *pLine, *pEOSkippedChunk, *keyword;
+		while (pending)
+		{
+			pLine = pEOL+1;
+			pEOL = strchr(pLine, '\n');
+			if (!pEOL)
+				break;
+			int curLineLen = (int)(pEOL-pLine);
+
+			// skip data like ParsePatchCore() does
+			pEOSkippedChunk = NULL;
+			if (!m_processBase64 && curLineLen>2 && *(pEOL-1)=='=' && *(pEOL-2)=='=')
+				pEOSkippedChunk = strstr(pLine, ">\n");
+			else if (!m_processInProjectMIDI && isParsingSource && (
+				(curLineLen>2 && !_strnicmp(pLine, "E ", 2)) ||
+				(curLineLen>3 && !_strnicmp(pLine, "Em ", 3))))
+				pEOSkippedChunk = strstr(pLine, "GUID {");
+			else if (!m_processFreeze && parents.GetSize()==1 && curLineLen>8 && !strncmp(pLine, "<FREEZE ", 8))
+			{
+				int skippedLen = FindEndOfSubChunk(pLine, 0);
+				while (skippedLen >= 0)
+				{
+					pEOSkippedChunk = (char*)(pLine+skippedLen);
+					if (!strncmp(pEOSkippedChunk, "<FREEZE ", 8))
+						skippedLen = FindEndOfSubChunk(pLine, skippedLen);
+					else
+						skippedLen = -1;
+				}
+			}
+			if (pEOSkippedChunk)
+			{
+				pLine = pEOSkippedChunk;
+				pEOL = strchr(pEOSkippedChunk, '\n');
+				if (!pEOL)
+					break;
+				curLineLen = (int)(pEOL-pLine);
+			}
+
+			const int len = curLineLen >= SNM_MAX_CHUNK_LINE_LENGTH ? SNM_MAX_CHUNK_LINE_LENGTH-1 : curLineLen;
+			memcpy(curLine, pLine, len);
+			curLine[len] = '\0';
+			if (lp.parse(curLine) || !lp.getnumtokens())
+				continue;
+			keyword = lp.gettoken_str(0);
+			if (!*keyword)
+				continue;
+
+			if (*keyword == '<')
+			{
+				isParsingSource |= (lp.getnumtokens()==2 && curLineLen>9 && !strcmp(keyword+1, "SOURCE"));
+				parents.Add(new WDL_FastString(keyword+1));
+			}
+			else if (*keyword == '>')
+			{
+				if (isParsingSource)
+					isParsingSource = !!strcmp(GetParent(&parents), "SOURCE");
+				parents.Delete(parents.GetSize()-1, true);
+			}
+
+			if (!parents.GetSize())
+				continue;
+
+			const char* parent = parents.Get(parents.GetSize()-1)->Get();
+			for (int i=0; i < _nbQueries; i++)
+			{
+				if (occ[i] < 0)
+					continue;
+
+				SNM_ChunkQuery* q = &_queries[i];
+				bool tolerantMatch, strictMatch;
+				IsMatchingParsedLine(&tolerantMatch, &strictMatch, q->depth, parents.GetSize(), q->parent, parent, q->keyword, keyword);
+				if (strictMatch)
+				{
+					if (occ[i]++ == (q->occurence<0 ? 0 : q->occurence))
+					{
+						q->linePos = (int)(pLine-cData);
+						q->lineLen = curLineLen;
+						occ[i] = -1;
+						pending--;
+					}
+				}
+				else if (q->breakKeyword && !strcmp(keyword, q->breakKeyword))
+				{
+					occ[i] = -1;
+					pending--;
+				}
+			}
+		}
+	}
+
+	int found = 0;
+	for (int i=0; i < _nbQueries; i++)
+	{
+		SNM_ChunkQuery* q = &_queries[i];
+		if (q->linePos >= 0)
+		{
+			found++;
+			if (q->tokenPos >= 0)
+				FindToken(cData+q->linePos, q->lineLen, q->tokenPos, &q->tokenStart, &q->tokenLen);
+			if (q->tokenStart >= 0)
+				q->tokenStart += q->linePos;
+		}
+	}
+	return found;
+}
+
 const char* GetParent(WDL_PtrList<WDL_FastString>* _parents, int _ancestor=1) {
 	int sz = _parents ? _parents->GetSize() : 0;
 	if (sz >= _ancestor)
@@ -467,6 +1019,15 @@ protected:
 	// can be enabled to break parsing (+ bulk recopy when patching)
 	bool m_breakParsePatch;
 
+	// read-only lookups, see IndexedParse()
+	// m_indexRevision must be incremented when the cached chunk is altered
+	SNM_ChunkIndex m_index;
+	int m_indexRevision;
+
+	// pending edits (sorted by position, non overlapping), see BeginEdits()
+	WDL_PtrList_DeleteOnDestroy<SNM_ChunkEdit> m_edits;
+	bool m_editing;
+
 
 const char* SNM_GetSetObjectState(void* _obj, WDL_FastString* _str)
 {
@@ -531,6 +1092,8 @@ bool WriteChunkLine(WDL_FastString* _chunkLine, const char* _value, int _tokenPo
 // Those callbacks are *always* triggered, except NotifyChunkLine() that 
 // is triggered depending on Parse() or ParsePatch() parameters/criteria 
 // => for optimization: the more criteria, the less calls!
+// Exception: read-only lookups served by the chunk index do not trigger any
+// callback (SNM_GET_CHUNK_CHAR, SNM_GET_SUBCHUNK_OR_LINE*, SNM_COUNT_KEYWORD)
 ///////////////////////////////////////////////////////////////////////////////
 
 virtual void NotifyStartChunk(int _mode) {}
@@ -561,6 +1124,192 @@ virtual bool NotifySkippedSubChunk(int _mode,
 ///////////////////////////////////////////////////////////////////////////////
 private:
 
+// adds a pending edit, see BeginEdits()
+// returns false if it overlaps another edit
+bool AddEdit(int _pos, int _len, const char* _str)
+{
+	// insertion point: after edits at the same position (edits order is preserved),
+	// except insertions that go before a replacement at the same position
+	int lo=0, hi=m_edits.GetSize();
+	while (lo < hi)
+	{
+		const int mid = (lo+hi)/2;
+		const SNM_ChunkEdit* edit = m_edits.Get(mid);
+		if (edit->pos < _pos || (edit->pos == _pos && (_len > 0 || !edit->len))) lo = mid+1;
+		else hi = mid;
+	}
+	SNM_ChunkEdit* prev = lo>0 ? m_edits.Get(lo-1) : NULL;
+	SNM_ChunkEdit* next = m_edits.Get(lo);
+	if ((prev && _pos < prev->pos+prev->len) || (next && next->pos < _pos+_len))
+		return false;
+
+	SNM_ChunkEdit* edit = new SNM_ChunkEdit;
+	edit->pos = _pos;
+	edit->len = _len;
+	if (_str && *_str)
+		edit->str.Set(_str);
+	m_edits.Insert(lo, edit);
+	return true;
+}
+
+// applies pending edits with a single copy of the chunk
+// returns the number of applied edits
+int ApplyEdits()
+{
+	const int nb = m_edits.GetSize();
+	if (!nb)
+		return 0;
+
+	const char* cData = m_chunk->Get();
+	int len = m_chunk->GetLength();
+	for (int i=0; i < nb; i++)
+		len += m_edits.Get(i)->str.GetLength() - m_edits.Get(i)->len;
+
+	WDL_FastString* newChunk = new WDL_FastString(len > SNM_HEAPBUF_GRANUL ? len : SNM_HEAPBUF_GRANUL);
+	int pos = 0;
+	for (int i=0; i < nb; i++)
+	{
+		SNM_ChunkEdit* edit = m_edits.Get(i);
+		if (edit->pos > pos)
+			newChunk->Append(cData+pos, edit->pos-pos);
+		if (edit->str.GetLength())
+			newChunk->Append(&edit->str);
+		pos = edit->pos + edit->len;
+	}
+	if (m_chunk->GetLength() > pos)
+		newChunk->Append(cData+pos, m_chunk->GetLength()-pos);
+
+	// avoids buffer re-copy
+	WDL_FastString* oldChunk = m_chunk;
+	m_chunk = newChunk;
+	delete oldChunk;
+
+	m_edits.Empty(true);
+	m_updates += nb;
+	m_indexRevision++;
+	return nb;
+}
+
+// read-only lookups served by the chunk index, see SNM_ChunkIndex
+// returns false if the lookup has to be done by ParsePatchCore(), e.g.
+// unsupported modes/parameters or first lookup of the chunk
+// note: as opposed to ParsePatchCore(), no Notify*() callback is triggered
+bool IndexedParse(int _mode, int _depth, const char* _expectedParent, const char* _keyWord, 
+		int _occurence, int _tokenPos, void* _value, const char* _breakKeyword, int* _retVal)
+{
+	if (_mode != SNM_GET_CHUNK_CHAR && _mode != SNM_GET_SUBCHUNK_OR_LINE && 
+		_mode != SNM_GET_SUBCHUNK_OR_LINE_EOL && _mode != SNM_COUNT_KEYWORD)
+		return false;
+	// strict matches only, pipe lines are parsed differently depending on _mode
+	if (!_expectedParent || !_keyWord || _depth < 1 || *_keyWord == '|' || (_breakKeyword && *_breakKeyword == '|'))
+		return false;
+	if (_mode == SNM_GET_CHUNK_CHAR && _tokenPos < 0)
+		return false;
+	if (!m_index.Update(GetChunk(), m_updates, m_indexRevision, m_processBase64, m_processInProjectMIDI, m_processFreeze))
+		return false;
+
+	const int breakEntry = m_index.FindBreak(_depth, _expectedParent, _keyWord, _breakKeyword);
+	if (_mode == SNM_COUNT_KEYWORD)
+	{
+		m_index.Find(_depth, _expectedParent, _keyWord, -1, breakEntry, _retVal);
+		return true;
+	}
+
+	const int found = m_index.Find(_depth, _expectedParent, _keyWord, _occurence<0 ? 0 : _occurence, breakEntry);
+	const SNM_ChunkIndex::Entry* e = m_index.Get(found);
+	if (!e) {
+		*_retVal = 0; // not found
+		return true;
+	}
+
+	const char* cData = m_chunk->Get();
+	const char* pKeyword = strstr(cData+e->pos, _keyWord);
+	const int keywordPos = pKeyword ? ((int)(pKeyword-cData+1)) : -1; // *KEYWORD* position + 1 (0 reserved for "not found")
+	switch (_mode)
+	{
+		case SNM_GET_CHUNK_CHAR:
+			if (_value)
+			{
+				char curLine[SNM_MAX_CHUNK_LINE_LENGTH] = "";
+				const int len = e->len >= SNM_MAX_CHUNK_LINE_LENGTH ? SNM_MAX_CHUNK_LINE_LENGTH-1 : e->len;
+				memcpy(curLine, cData+e->pos, len);
+				curLine[len] = '\0';
+				LineParser lp(false);
+				lp.parse(curLine);
+				strcpy((char*)_value, lp.gettoken_str(_tokenPos));
+			}
+			*_retVal = keywordPos;
+			break;
+		case SNM_GET_SUBCHUNK_OR_LINE:
+		case SNM_GET_SUBCHUNK_OR_LINE_EOL:
+		{
+			WDL_FastString* value = (WDL_FastString*)_value;
+			if (*_keyWord == '<' && (value || _mode == SNM_GET_SUBCHUNK_OR_LINE_EOL))
+			{
+				const SNM_ChunkIndex::Entry* eEnd = m_index.Get(e->end);
+				if (!eEnd) // unbalanced chunk
+					return false;
+				if (value)
+				{
+					for (int i=found; i < e->end; i++)
+						m_index.AppendEntry(i, value);
+					value->Append(">\n",2);
+				}
+				*_retVal = (_mode == SNM_GET_SUBCHUNK_OR_LINE ? keywordPos : eEnd->pos+eEnd->len+1);
+			}
+			else
+			{
+				if (value)
+					m_index.AppendEntry(found, value);
+				*_retVal = (_mode == SNM_GET_SUBCHUNK_OR_LINE ? keywordPos : e->pos+e->len+1); // *EOL* position + 1
+			}
+			break;
+		}
+	}
+	return true;
+}
+
+// locates token _tokenPos of a chunk line (tokens delimited as with LineParser: 
+// white spaces or quotes) 
+// _start: position of the token in _line, quotes excluded (-1 if not found)
+void FindToken(const char* _line, int _lineLen, int _tokenPos, int* _start, int* _len)
+{
+	*_start = -1;
+	*_len = 0;
+	if (_lineLen >= SNM_MAX_CHUNK_LINE_LENGTH)
+		_lineLen = SNM_MAX_CHUNK_LINE_LENGTH-1; // as ParsePatchCore()
+
+	int pos=0, tok=0;
+	for(;;)
+	{
+		while (pos < _lineLen && (_line[pos] == ' ' || _line[pos] == '\t')) pos++;
+		if (pos >= _lineLen)
+			return;
+
+		int start=pos, end;
+		const char quote = _line[pos];
+		if (quote == '"' || quote == '\'' || quote == '`')
+		{
+			start = ++pos;
+			while (pos < _lineLen && _line[pos] != quote) pos++;
+			if (pos >= _lineLen)
+				return; // unbalanced quotes
+			end = pos++;
+		}
+		else
+		{
+			while (pos < _lineLen && _line[pos] != ' ' && _line[pos] != '\t') pos++;
+			end = pos;
+		}
+
+		if (tok++ == _tokenPos) {
+			*_start = start;
+			*_len = end-start;
+			return;
+		}
+	}
+}
+
 // just to avoid duplicate strcmp() calls in ParsePatchCore()
 void IsMatchingParsedLine(bool* _tolerantMatch, bool* _strictMatch, 
 		int _expectedDepth, int _parsedDepth,
@@ -633,6 +1382,18 @@ int ParsePatchCore(
 		return -1;
 #endif
 
+	// pending edits must be applied before patching, see BeginEdits()
+	if (_write)
+		ApplyEdits();
+
+	// read-only lookups: use the chunk index if possible
+	int indexedRetVal;
+	if (!_write && !m_breakParsePatch && 
+		IndexedParse(_mode, _depth, _expectedParent, _keyWord, _occurence, _tokenPos, _value, _breakKeyword, &indexedRetVal))
+	{
+		return indexedRetVal;
+	}
+
 	// get/cache the chunk
 	const char* cData = GetChunk() ? GetChunk()->Get() : NULL;
 	if (!cData)
@@ -64,8 +64,13 @@ bool AddReceiveWithVolPan(MediaTrack * _srcTr, MediaTrack * _destTr, int _type,
 	{
 		SNM_ChunkParserPatcher p(_srcTr, false);
 		p.SetWantsMinimalState(true);
-		if (p.Parse(SNM_GET_CHUNK_CHAR, 1, "TRACK", "VOLPAN", 0, 1, vol, NULL, "MUTESOLO") > 0 &&
-			p.Parse(SNM_GET_CHUNK_CHAR, 1, "TRACK", "VOLPAN", 0, 2, pan, NULL, "MUTESOLO") > 0)
+		SNM_ChunkQuery q[2] = {
+			SNM_ChunkQuery(1, "TRACK", "VOLPAN", 0, 1, "MUTESOLO"),
+			SNM_ChunkQuery(1, "TRACK", "VOLPAN", 0, 2, "MUTESOLO")
+		};
+		if (p.ParseQueries(q, 2) == 2 &&
+			q[0].GetToken(p.GetChunk()->Get(), vol, sizeof(vol)) &&
+			q[1].GetToken(p.GetChunk()->Get(), pan, sizeof(pan)))
 		{
 			update = _p->AddReceive(_srcTr, _type, vol, pan) > 0;
 		}
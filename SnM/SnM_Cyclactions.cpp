@@ -229,7 +229,7 @@ bool IsCondStatement(const char* _cmd) {
 // _cmdStr:   custom id to explode
 // _cmds:     output list of exploded commands
 //            it is up to the caller to unalloc items!
-// _macros:   to optimize accesses to reaper-kb.ini, 
+// _macros:   to optimize accesses to reaper-kb.ini (see LoadKbIni()),
 //            if NULL, macros won't be exploded, no file access
 // _consoles: to optimize accesses to reaconsole_customcommands.txt
 //
@@ -281,15 +281,13 @@ int ExplodeMacro(int _section, const char* _cmdStr,
 	 // want macro explosion?
 	if (_macros)
 	{
-		bool loadOk = true;
-		if (!_macros->GetSize()) {
-			loadOk = LoadKbIni(_macros);
-			_macros->Add(new WDL_FastString);
-		}
-		if (!loadOk) return -1;
+		// reaper-kb.ini is checked once per explosion batch, _macros keeps the result
+		if (!_macros->GetSize())
+			_macros->Add(new WDL_FastString(LoadKbIni() ? "1" : ""));
+		if (!_macros->Get(0)->GetLength()) return -1;
 
 		WDL_PtrList_DeleteOnDestroy<WDL_FastString> subCmds;
-		int r = GetMacroOrScript(_cmdStr, SNM_GetActionSectionUniqueId(_section), _macros, &subCmds);
+		int r = GetMacroOrScript(_cmdStr, SNM_GetActionSectionUniqueId(_section), &subCmds);
 		if (r==0)
 		{
 			return -1;
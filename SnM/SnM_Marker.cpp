@@ -32,6 +32,98 @@
 
 #include <WDL/localize/localize.h>
 
+#include <unordered_map>
+
+///////////////////////////////////////////////////////////////////////////////
+// Marker and region index
+///////////////////////////////////////////////////////////////////////////////
+
+// lookup structures built from g_mkrRgnCache (i.e. for the current project),
+// indexes are the ones of EnumProjectMarkers3()
+class SNM_MarkerRegionIndex
+{
+public:
+	SNM_MarkerRegionIndex() : m_proj(NULL), m_stateCount(-1), m_sorted(false), m_treeSz(0) {}
+
+	void Build(ReaProject* _proj, WDL_PtrList<MarkerRegion>* _mkrRgns)
+	{
+		const int sz = _mkrRgns->GetSize();
+		m_proj = _proj;
+		m_stateCount = GetProjectStateChangeCount(_proj);
+		m_sorted = true;
+		m_ids.clear();
+		m_starts.Resize(sz, false);
+		m_lastMarker.Resize(sz, false);
+
+		m_treeSz = 1;
+		while (m_treeSz < sz) m_treeSz *= 2;
+		m_rgnEnds.Resize(2*m_treeSz, false);
+
+		for (int i=0; i<sz; i++)
+		{
+			MarkerRegion* m = _mkrRgns->Get(i);
+			m_ids.insert(std::make_pair(m->GetId(), i)); // no overwrite: 1st one wins, as with EnumProjectMarkers3() scans
+			m_starts.Get()[i] = m->GetPos();
+			m_lastMarker.Get()[i] = !m->IsRegion() ? i : (i ? m_lastMarker.Get()[i-1] : -1);
+			m_rgnEnds.Get()[m_treeSz+i] = m->IsRegion() ? m->GetRegEnd() : -DBL_MAX;
+			if (i && m_starts.Get()[i] < m_starts.Get()[i-1])
+				m_sorted = false;
+		}
+		for (int i=m_treeSz+sz; i<2*m_treeSz; i++)
+			m_rgnEnds.Get()[i] = -DBL_MAX;
+		for (int i=m_treeSz-1; i>0; i--)
+			m_rgnEnds.Get()[i] = max(m_rgnEnds.Get()[2*i], m_rgnEnds.Get()[2*i+1]);
+	}
+
+	// true if the index still reflects _proj's markers & regions (as far as cheap checks can tell)
+	bool IsValid(ReaProject* _proj) {
+		return m_proj == _proj && m_stateCount == GetProjectStateChangeCount(_proj) && m_starts.GetSize() == CountProjectMarkers(_proj, NULL, NULL);
+	}
+
+	int FindId(int _id) {
+		std::unordered_map<int,int>::const_iterator it = m_ids.find(_id);
+		return it != m_ids.end() ? it->second : -1;
+	}
+
+	// same as the linear scan in FindMarkerRegion(), i.e. last marker, or region containing _pos,
+	// starting at or before _pos. Returns -2 if markers/regions are not sorted by position
+	int Find(double _pos, int _flags)
+	{
+		if (!m_sorted)
+			return -2;
+		const int n = int(std::upper_bound(m_starts.Get(), m_starts.Get()+m_starts.GetSize(), _pos) - m_starts.Get());
+		int found = -1;
+		if (n>0 && _flags&SNM_MARKER_MASK)
+			found = m_lastMarker.Get()[n-1];
+		if (n>0 && _flags&SNM_REGION_MASK)
+			found = max(found, FindLastRegion(1, 0, m_treeSz, n, _pos));
+		return found;
+	}
+
+private:
+	// interval query on the max-tree of region ends: last region in [0,_n) that ends at or after _pos
+	int FindLastRegion(int _node, int _nodeStart, int _nodeEnd, int _n, double _pos)
+	{
+		if (_nodeStart >= _n || m_rgnEnds.Get()[_node] < _pos)
+			return -1;
+		if (_nodeEnd - _nodeStart == 1)
+			return _nodeStart;
+		const int mid = (_nodeStart + _nodeEnd) / 2;
+		const int found = FindLastRegion(2*_node+1, mid, _nodeEnd, _n, _pos);
+		return found >= 0 ? found : FindLastRegion(2*_node, _nodeStart, mid, _n, _pos);
+	}
+
+	ReaProject* m_proj;
+	int m_stateCount;
+	bool m_sorted;
+	std::unordered_map<int,int> m_ids; // marker/region id -> index
+	WDL_TypedBuf<double> m_starts;     // by index, sorted when m_sorted
+	WDL_TypedBuf<int> m_lastMarker;    // by index, index of the last marker at or before it (-1 if none)
+	WDL_TypedBuf<double> m_rgnEnds;    // max-tree of region ends (-DBL_MAX for markers), leaves start at m_treeSz
+	int m_treeSz;
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Marker and region update listener
 ///////////////////////////////////////////////////////////////////////////////
@@ -39,6 +131,8 @@
 DWORD g_mkrRgnNotifyTime = 0; // really approx (updated on timer)
 WDL_PtrList<MarkerRegion> g_mkrRgnCache;
 WDL_PtrList<SNM_MarkerRegionListener> g_mkrRgnListeners;
+SNM_MarkerRegionIndex g_mkrRgnIndex;
+int g_mkrRgnPendingFlags = 0; // updates detected by lookups, not notified yet
 
 void RegisterToMarkerRegionUpdates(SNM_MarkerRegionListener* _listener)
 {
@@ -77,6 +171,11 @@ int UpdateMarkerRegionCache()
 			updateFlags |= (m->IsRegion() ? SNM_REGION_MASK : SNM_MARKER_MASK);
 		g_mkrRgnCache.Delete(j, true);
 	}
+	// (re)index
+	ReaProject* proj = EnumProjects(-1, NULL, 0);
+	if (updateFlags || !g_mkrRgnIndex.IsValid(proj))
+		g_mkrRgnIndex.Build(proj, &g_mkrRgnCache);
+
 	// project time mode update?
 	static int sPrevTimemode = *ConfigVar<int>("projtimemode");
 	if (updateFlags != (SNM_MARKER_MASK|SNM_REGION_MASK))
@@ -97,22 +196,70 @@ void UpdateMarkerRegionRun()
 		g_mkrRgnNotifyTime = GetTickCount() + SNM_MKR_RGN_UPDATE_FREQ;
 		
 		if (int sz=g_mkrRgnListeners.GetSize())
-			if (int updateFlags = UpdateMarkerRegionCache())
+		{
+			int updateFlags = UpdateMarkerRegionCache() | g_mkrRgnPendingFlags;
+			g_mkrRgnPendingFlags = 0;
+			if (updateFlags)
 				for (int i=sz-1; i>=0; i--)
 					g_mkrRgnListeners.Get(i)->NotifyMarkerRegionUpdate(updateFlags);
+		}
 	}
 }
 
+// returns true if g_mkrRgnIndex can be used for _proj, updates it if needed
+// (updates found here get notified to listeners on next UpdateMarkerRegionRun())
+bool UpdateMarkerRegionIndex(ReaProject* _proj)
+{
+	ReaProject* proj = EnumProjects(-1, NULL, 0);
+	if (_proj && _proj != proj)
+		return false;
+	if (!g_mkrRgnIndex.IsValid(proj))
+		g_mkrRgnPendingFlags |= UpdateMarkerRegionCache();
+	return g_mkrRgnIndex.IsValid(proj);
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Marker/region helpers
 ///////////////////////////////////////////////////////////////////////////////
 
+// true if the marker/region at index _idx of the current project matches g_mkrRgnCache
+// (also true for out of range indexes, if the cache agrees)
+static bool IsCachedMarkerRegion(int _idx)
+{
+	if (_idx < 0)
+		return true;
+	bool isRgn; double pos, rgnend; const char* name; int num, col;
+	MarkerRegion* m = g_mkrRgnCache.Get(_idx);
+	if (!EnumProjectMarkers3(NULL, _idx, &isRgn, &pos, &rgnend, &name, &num, &col))
+		return !m;
+	return m && m->Compare(isRgn, pos, rgnend, name, num, col);
+}
+
 // returns the 1st marker or region index found at _pos
 // note: relies on markers & regions indexed by positions
 // _flags: &SNM_MARKER_MASK=marker, &SNM_REGION_MASK=region
 int FindMarkerRegion(ReaProject* _proj, double _pos, int _flags, int* _idOut)
 {
+	if (UpdateMarkerRegionIndex(_proj))
+	{
+		int foundx = g_mkrRgnIndex.Find(_pos, _flags);
+
+		// markers/regions can be moved via the API without changing the project state count:
+		// double-check the hit and its neighbor, re-index once on mismatch
+		if (foundx != -2 && (!IsCachedMarkerRegion(foundx) || !IsCachedMarkerRegion(foundx+1)))
+		{
+			g_mkrRgnPendingFlags |= UpdateMarkerRegionCache();
+			foundx = g_mkrRgnIndex.Find(_pos, _flags);
+		}
+
+		if (foundx != -2)
+		{
+			if (_idOut) *_idOut = foundx>=0 ? GetMarkerRegionIdFromIndex(_proj, foundx) : -1;
+			return foundx;
+		}
+	}
+
 	bool isrgn;
 	double dPos, dEnd;
 	int x=0, lastx=0, num, foundId=-1, foundx=-1;
@@ -159,8 +306,25 @@ int GetMarkerRegionIdFromIndex(ReaProject* _proj, int _idx)
 	return -1;
 }
 
+// returns the index of the 1st marker/region with this id using g_mkrRgnIndex,
+// -1 if not found, -2 if the index can't tell (caller has to scan markers/regions)
+static int FindMarkerRegionIndexFromId(ReaProject* _proj, int _id)
+{
+	if (_id > 0 && UpdateMarkerRegionIndex(_proj))
+	{
+		int idx = g_mkrRgnIndex.FindId(_id);
+		if (idx < 0 || GetMarkerRegionIdFromIndex(_proj, idx) == _id) // double-check, costs nothing
+			return idx;
+	}
+	return -2;
+}
+
 int GetMarkerRegionIndexFromId(ReaProject* _proj, int _id) 
 {
+	int idx = FindMarkerRegionIndexFromId(_proj, _id);
+	if (idx != -2)
+		return idx;
+
 	if (_id > 0)
 	{
 		int x=0, lastx=0, num=(_id&0x3FFFFFFF), num2; 
@@ -184,6 +348,12 @@ bool IsRegion(int _id) {
 
 int EnumMarkerRegionById(ReaProject* _proj, int _id, bool* _isrgn, double* _pos, double* _end, const char** _name, int* _num, int* _color)
 {
+	int idx = FindMarkerRegionIndexFromId(_proj, _id);
+	if (idx == -1)
+		return -1;
+	if (idx >= 0 && EnumProjectMarkers3(_proj, idx, _isrgn, _pos, _end, _name, _num, _color))
+		return idx;
+
 	if (_id > 0)
 	{
 		const char* name2;
@@ -306,6 +476,17 @@ bool GotoMarkerRegion(ReaProject* _proj, int _num, int _flags, bool _select = fa
 {
 	bool isrgn; double pos, end;
 	int x=0, n; 
+
+	// 1st marker or region with that number, if the index knows
+	int mkrIdx = (_flags&SNM_MARKER_MASK) ? FindMarkerRegionIndexFromId(_proj, MakeMarkerRegionId(_num, false)) : -1;
+	int rgnIdx = (_flags&SNM_REGION_MASK) ? FindMarkerRegionIndexFromId(_proj, MakeMarkerRegionId(_num, true)) : -1;
+	if (mkrIdx != -2 && rgnIdx != -2)
+	{
+		if (mkrIdx < 0 && rgnIdx < 0)
+			return false;
+		x = (mkrIdx >= 0 && (rgnIdx < 0 || mkrIdx < rgnIdx)) ? mkrIdx : rgnIdx;
+	}
+
 	while ((x = EnumProjectMarkers3(_proj, x, &isrgn, &pos, &end, NULL, &n, NULL)))
 		if (n == _num && ((!isrgn && _flags&SNM_MARKER_MASK) || (isrgn && _flags&SNM_REGION_MASK)))
 		{
@@ -57,6 +57,8 @@
 #include <WDL/localize/localize.h>
 #include <WDL/projectcontext.h>
 
+#include <unordered_map>
+
 #define NOTES_WND_ID				"SnMNotesHelp"
 #define NOTES_INI_SEC				"Notes"
 #define MAX_HELP_LENGTH				(64*1024) //JFB! instead of MAX_INI_SECTION (too large)
@@ -145,6 +147,117 @@ MediaTrack *g_trNote = NULL;
 bool g_internalMkrRgnChange = false;
 
 
+// subtitle lookup index: an interval index over subtitle start/end times and
+// id/actor name hash maps, so that cursor-follow lookups cost O(log n + k)
+// rather than scanning all subtitles (and all actors for each of them).
+// rebuilt lazily after SubtitlesChanged() or on project switch
+static int g_subtitlesRevision = 0;
+
+void SubtitlesChanged() {
+  g_subtitlesRevision++;
+}
+
+class SNM_SubtitleIndex {
+  public:
+    SNM_SubtitleIndex()
+      : m_subs{nullptr}, m_actors{nullptr}, m_revision{-1}, m_treeSz{0} {
+    }
+
+    void Update(WDL_PtrList_DOD<SNM_RegionSubtitle> *subs, WDL_PtrList_DOD<SNM_Actor> *actors) {
+      if (m_subs == subs && m_actors == actors && m_revision == g_subtitlesRevision)
+        return;
+
+      m_subs = subs;
+      m_actors = actors;
+      m_revision = g_subtitlesRevision;
+
+      m_actorIdx.clear();
+      for (int i = 0; i < actors->GetSize(); i++)
+        m_actorIdx.insert(std::make_pair(std::string(actors->Get(i)->GetName()), i)); // 1st one wins
+
+      // enabled subtitles only, sorted by start time
+      m_subIds.clear();
+      m_order.clear();
+      for (int i = 0; i < subs->GetSize(); i++) {
+        SNM_RegionSubtitle *sub = subs->Get(i);
+        m_subIds.insert(std::make_pair(sub->GetId(), i));
+        SNM_Actor *actor = FindActor(sub->GetActor());
+        if (actor && actor->IsEnabled())
+          m_order.push_back(i);
+      }
+      std::stable_sort(m_order.begin(), m_order.end(), [subs](int a, int b) {
+        return subs->Get(a)->GetStartTime() < subs->Get(b)->GetStartTime();
+      });
+
+      const int sz = (int)m_order.size();
+      m_starts.Resize(sz, false);
+      m_treeSz = 1;
+      while (m_treeSz < sz) m_treeSz *= 2;
+      m_ends.Resize(2 * m_treeSz, false);
+      for (int i = 0; i < sz; i++) {
+        SNM_RegionSubtitle *sub = subs->Get(m_order[i]);
+        m_starts.Get()[i] = sub->GetStartTime();
+        m_ends.Get()[m_treeSz + i] = sub->GetEndTime();
+      }
+      for (int i = m_treeSz + sz; i < 2 * m_treeSz; i++)
+        m_ends.Get()[i] = -DBL_MAX;
+      for (int i = m_treeSz - 1; i > 0; i--)
+        m_ends.Get()[i] = max(m_ends.Get()[2 * i], m_ends.Get()[2 * i + 1]);
+    }
+
+    SNM_Actor *FindActor(const char *name) {
+      std::unordered_map<std::string, int>::const_iterator it = m_actorIdx.find(name ? name : "");
+      return it != m_actorIdx.end() ? m_actors->Get(it->second) : nullptr;
+    }
+
+    // returns the index of the 1st subtitle with id, or -1
+    int FindId(int id) {
+      std::unordered_map<int, int>::const_iterator it = m_subIds.find(id);
+      return it != m_subIds.end() ? it->second : -1;
+    }
+
+    // out: indexes of the subtitles of enabled actors overlapping pos, in list order
+    void FindOverlapping(double pos, WDL_TypedBuf<int> *out) {
+      out->Resize(0, false);
+      const int n = (int)(std::upper_bound(m_starts.Get(), m_starts.Get() + m_starts.GetSize(), pos) - m_starts.Get());
+      if (n > 0)
+        CollectEnds(1, 0, m_treeSz, n, pos, out);
+      std::sort(out->Get(), out->Get() + out->GetSize());
+    }
+
+  private:
+    // collects subtitles in [0,n) of m_order that end at or after pos
+    void CollectEnds(int node, int nodeStart, int nodeEnd, int n, double pos, WDL_TypedBuf<int> *out) {
+      if (nodeStart >= n || m_ends.Get()[node] < pos)
+        return;
+      if (nodeEnd - nodeStart == 1) {
+        out->Add(m_order[nodeStart]);
+        return;
+      }
+      const int mid = (nodeStart + nodeEnd) / 2;
+      CollectEnds(2 * node, nodeStart, mid, n, pos, out);
+      CollectEnds(2 * node + 1, mid, nodeEnd, n, pos, out);
+    }
+
+    WDL_PtrList_DOD<SNM_RegionSubtitle> *m_subs;
+    WDL_PtrList_DOD<SNM_Actor> *m_actors;
+    int m_revision;
+    std::unordered_map<std::string, int> m_actorIdx; // actor name -> actor index
+    std::unordered_map<int, int> m_subIds;           // subtitle id -> subtitle index
+    std::vector<int> m_order;                        // enabled subtitle indexes, by start time
+    WDL_TypedBuf<double> m_starts;                   // start times, in m_order order
+    WDL_TypedBuf<double> m_ends;                     // max-tree of end times, leaves start at m_treeSz
+    int m_treeSz;
+};
+
+static SNM_SubtitleIndex g_subtitleIndex;
+
+static SNM_SubtitleIndex *GetSubtitleIndex() {
+  g_subtitleIndex.Update(g_pRegionSubs.Get(), g_actors.Get());
+  return &g_subtitleIndex;
+}
+
+
 SNM_TrackNotes *SNM_TrackNotes::find(MediaTrack *track) {
   const GUID *guid = TrackToGuid(track);
   if (!guid)
@@ -1796,23 +1909,9 @@ int NotesWnd::UpdateRgnSub() {
 
     if (g_hideRegions) {
       WDL_PtrList_DOD<SNM_RegionSubtitle> *subs = g_pRegionSubs.Get();
-      WDL_PtrList_DOD<SNM_Actor> *actors = g_actors.Get();
 
       WDL_TypedBuf<int> newOverlapping;
-      for (int i = 0; i < subs->GetSize(); i++) {
-        SNM_RegionSubtitle *sub = subs->Get(i);
-        if (dPos < sub->GetStartTime() || dPos > sub->GetEndTime())
-          continue;
-        bool enabled = false;
-        for (int j = 0; j < actors->GetSize(); j++) {
-          if (!strcmp(actors->Get(j)->GetName(), sub->GetActor())) {
-            enabled = actors->Get(j)->IsEnabled();
-            break;
-          }
-        }
-        if (enabled)
-          newOverlapping.Add(i);
-      }
+      GetSubtitleIndex()->FindOverlapping(dPos, &newOverlapping);
 
       if (newOverlapping.GetSize() > 0) {
         bool regionsChanged = false;
@@ -1914,6 +2013,8 @@ int NotesWnd::UpdateRgnSub() {
     } else {
       int id, idx = FindMarkerRegion(NULL, dPos, SNM_REGION_MASK, &id);
       if (id > 0) {
+        WDL_PtrList_DOD<SNM_RegionSubtitle> *subs = g_pRegionSubs.Get();
+        SNM_SubtitleIndex *subIndex = GetSubtitleIndex();
         WDL_TypedBuf<int> newOverlappingIds;
         int enumIdx = 0;
         bool isRgn;
@@ -1922,12 +2023,8 @@ int NotesWnd::UpdateRgnSub() {
         while ((enumIdx = EnumProjectMarkers2(NULL, enumIdx, &isRgn, &p1, &p2, NULL, &num))) {
           if (isRgn && dPos >= p1 && dPos <= p2) {
             int regionId = MakeMarkerRegionId(num, true);
-            for (int i = 0; i < g_pRegionSubs.Get()->GetSize(); i++) {
-              if (g_pRegionSubs.Get()->Get(i)->GetId() == regionId) {
-                newOverlappingIds.Add(regionId);
-                break;
-              }
-            }
+            if (subIndex->FindId(regionId) >= 0)
+              newOverlappingIds.Add(regionId);
           }
         }
 
@@ -1952,24 +2049,20 @@ int NotesWnd::UpdateRgnSub() {
           m_cbRegion.Empty();
           for (int i = 0; i < m_overlappingRegionIds.GetSize(); i++) {
             int regId = m_overlappingRegionIds.Get()[i];
-            for (int j = 0; j < g_pRegionSubs.Get()->GetSize(); j++) {
-              SNM_RegionSubtitle *sub = g_pRegionSubs.Get()->Get(j);
-              if (sub->GetId() == regId) {
-                char itemText[256];
-                const char *actor = sub->GetActor();
-                if (actor && *actor)
-                  snprintf(itemText, sizeof(itemText), "%s", actor);
-                else {
-                  double pos, end;
-                  int num;
-                  if (EnumMarkerRegionById(NULL, regId, NULL, &pos, &end, NULL, &num, NULL) >= 0)
-                    snprintf(itemText, sizeof(itemText), "R%d", num);
-                  else
-                    snprintf(itemText, sizeof(itemText), "Region %d", i + 1);
-                }
-                m_cbRegion.AddItem(itemText);
-                break;
+            if (SNM_RegionSubtitle *sub = subs->Get(subIndex->FindId(regId))) {
+              char itemText[256];
+              const char *actor = sub->GetActor();
+              if (actor && *actor)
+                snprintf(itemText, sizeof(itemText), "%s", actor);
+              else {
+                double pos, end;
+                int num;
+                if (EnumMarkerRegionById(NULL, regId, NULL, &pos, &end, NULL, &num, NULL) >= 0)
+                  snprintf(itemText, sizeof(itemText), "R%d", num);
+                else
+                  snprintf(itemText, sizeof(itemText), "Region %d", i + 1);
               }
+              m_cbRegion.AddItem(itemText);
             }
           }
 
@@ -1997,21 +2090,16 @@ int NotesWnd::UpdateRgnSub() {
           int unknownActorCount = 0;
           const char *firstActor = NULL;
           for (int i = 0; i < m_overlappingRegionIds.GetSize(); i++) {
-            int regId = m_overlappingRegionIds.Get()[i];
-            for (int j = 0; j < g_pRegionSubs.Get()->GetSize(); j++) {
-              SNM_RegionSubtitle *sub = g_pRegionSubs.Get()->Get(j);
-              if (sub->GetId() == regId) {
-                const char *actor = sub->GetActor();
-                if (!actor || !*actor || !strcmp(actor, "?"))
-                  unknownActorCount++;
-                if (!actor || !*actor) actor = "?";
-                if (!firstActor) {
-                  firstActor = actor;
-                  uniqueActorCount = 1;
-                } else if (strcmp(firstActor, actor)) {
-                  uniqueActorCount = 2;
-                }
-                break;
+            if (SNM_RegionSubtitle *sub = subs->Get(subIndex->FindId(m_overlappingRegionIds.Get()[i]))) {
+              const char *actor = sub->GetActor();
+              if (!actor || !*actor || !strcmp(actor, "?"))
+                unknownActorCount++;
+              if (!actor || !*actor) actor = "?";
+              if (!firstActor) {
+                firstActor = actor;
+                uniqueActorCount = 1;
+              } else if (strcmp(firstActor, actor)) {
+                uniqueActorCount = 2;
               }
             }
           }
@@ -2020,37 +2108,24 @@ int NotesWnd::UpdateRgnSub() {
           WDL_FastString displayText;
           bool first = true;
           for (int i = 0; i < m_overlappingRegionIds.GetSize(); i++) {
-            int regId = m_overlappingRegionIds.Get()[i];
-            for (int j = 0; j < g_pRegionSubs.Get()->GetSize(); j++) {
-              SNM_RegionSubtitle *sub = g_pRegionSubs.Get()->Get(j);
-              if (sub->GetId() == regId) {
-                if (!first)
-                  displayText.Append("\r\n");
-                const char *actor = sub->GetActor();
-                bool hasActor = actor && *actor && strcmp(actor, "?");
-                if (hasActor || showDefaultPrefix)
-                  AppendDisplayLine(&displayText, hasActor ? actor : "?", sub->GetNotes());
-                else
-                  displayText.Append(sub->GetNotes());
-                first = false;
-                break;
-              }
+            if (SNM_RegionSubtitle *sub = subs->Get(subIndex->FindId(m_overlappingRegionIds.Get()[i]))) {
+              if (!first)
+                displayText.Append("\r\n");
+              const char *actor = sub->GetActor();
+              bool hasActor = actor && *actor && strcmp(actor, "?");
+              if (hasActor || showDefaultPrefix)
+                AppendDisplayLine(&displayText, hasActor ? actor : "?", sub->GetNotes());
+              else
+                displayText.Append(sub->GetNotes());
+              first = false;
             }
           }
           SetText(displayText.Get());
         } else if (g_lastMarkerRegionId > 0) {
-          bool found = false;
-          for (int i = 0; i < g_pRegionSubs.Get()->GetSize(); i++) {
-            SNM_RegionSubtitle *sub = g_pRegionSubs.Get()->Get(i);
-            if (sub->GetId() == g_lastMarkerRegionId) {
-              SetText(sub->GetNotes());
-              found = true;
-              break;
-            }
-          }
-          if (!found) {
+          if (SNM_RegionSubtitle *sub = subs->Get(subIndex->FindId(g_lastMarkerRegionId)))
+            SetText(sub->GetNotes());
+          else
             SetText("");
-          }
         } else {
           SetText("");
         }
@@ -2079,13 +2154,7 @@ void NotesWnd::ForceUpdateRgnSub() {
       if (g_hideRegions) {
         sub = subs->Get(m_overlappingRegionIds.Get()[i]);
       } else {
-        int regId = m_overlappingRegionIds.Get()[i];
-        for (int j = 0; j < subs->GetSize(); j++) {
-          if (subs->Get(j)->GetId() == regId) {
-            sub = subs->Get(j);
-            break;
-          }
-        }
+        sub = subs->Get(GetSubtitleIndex()->FindId(m_overlappingRegionIds.Get()[i]));
       }
       if (!sub) continue;
       const char *actor = sub->GetActor();
@@ -2108,13 +2177,7 @@ void NotesWnd::ForceUpdateRgnSub() {
       if (g_hideRegions) {
         sub = subs->Get(m_overlappingRegionIds.Get()[i]);
       } else {
-        int regId = m_overlappingRegionIds.Get()[i];
-        for (int j = 0; j < subs->GetSize(); j++) {
-          if (subs->Get(j)->GetId() == regId) {
-            sub = subs->Get(j);
-            break;
-          }
-        }
+        sub = subs->Get(GetSubtitleIndex()->FindId(m_overlappingRegionIds.Get()[i]));
       }
       if (!sub) continue;
       if (!first)
@@ -2238,40 +2301,54 @@ void NotesMarkerRegionListener::NotifyMarkerRegionUpdate(int _updateFlags) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// untagged text is appended by runs rather than char by char (large imports)
 void StripAssFormattingTags(WDL_FastString *text) {
+  if (!strchr(text->Get(), '\\'))
+    return;
   WDL_FastString result;
-  const char *p = text->Get();
+  const char *p = text->Get(), *run = p;
   while (*p) {
     if (*p == '{' && *(p + 1) == '\\') {
+      if (p > run)
+        result.Append(run, (int) (p - run)); // 0 would mean "all"
       while (*p && *p != '}')
         p++;
       if (*p == '}')
         p++;
+      run = p;
     } else if (*p == '\\' && (*(p + 1) == 'N' || *(p + 1) == 'n')) {
+      if (p > run)
+        result.Append(run, (int) (p - run));
       result.Append("\n");
       p += 2;
-    } else {
-      result.Append(p, 1);
+      run = p;
+    } else
       p++;
-    }
   }
+  if (p > run)
+    result.Append(run, (int) (p - run));
   text->Set(result.Get());
 }
 
 void StripSrtFormattingTags(WDL_FastString *text) {
+  if (!strchr(text->Get(), '<'))
+    return;
   WDL_FastString result;
-  const char *p = text->Get();
+  const char *p = text->Get(), *run = p;
   while (*p) {
     if (*p == '<') {
+      if (p > run)
+        result.Append(run, (int) (p - run));
       while (*p && *p != '>')
         p++;
       if (*p == '>')
         p++;
-    } else {
-      result.Append(p, 1);
+      run = p;
+    } else
       p++;
-    }
   }
+  if (p > run)
+    result.Append(run, (int) (p - run));
   text->Set(result.Get());
 }
 
@@ -2645,126 +2722,162 @@ bool ActorListView::GetCustomColumnColor(SWS_ListItem *item,
   return false;
 }
 
-bool ImportAssFile(const char *_fn) {
-  bool ok = false;
-  double firstPos = -1.0;
-  bool inEventsSection = false;
-
-  if (FILE *f = fopenUTF8(_fn, "rt")) {
-    char buf[4096];
-    if (fgets(buf, 4, f) && strcmp("\xEF\xBB\xBF", buf))
-      rewind(f);
+///////////////////////////////////////////////////////////////////////////////
+// Subtitle import
+///////////////////////////////////////////////////////////////////////////////
 
-    while (fgets(buf, sizeof(buf), f)) {
-      if (buf[0] == '[') {
-        inEventsSection = (_strnicmp(buf, "[Events]", 8) == 0);
-        continue;
-      }
+// single pass line tokenizer over a whole subtitle file loaded in memory
+// (skips the UTF-8 BOM, handles "\n", "\r\n" and "\r" line endings)
+class SNM_SubLineReader {
+  public:
+    SNM_SubLineReader(const char *buf, int size) : m_p{buf}, m_end{buf + size}, m_lines{0} {
+      if (size >= 3 && !memcmp(buf, "\xEF\xBB\xBF", 3))
+        m_p += 3;
+    }
 
-      if (!inEventsSection)
-        continue;
+    // line: not null terminated, end of line excluded
+    bool Next(const char **line, int *len) {
+      if (m_p >= m_end)
+        return false;
+      const char *eol = m_p;
+      while (eol < m_end && *eol != '\n' && *eol != '\r')
+        eol++;
+      *line = m_p;
+      *len = (int) (eol - m_p);
+      if (eol < m_end && *eol == '\r')
+        eol++;
+      if (eol < m_end && *eol == '\n')
+        eol++;
+      m_p = eol;
+      m_lines++;
+      return true;
+    }
 
-      if (_strnicmp(buf, "Dialogue:", 9) != 0)
-        continue;
+    int GetLineCount() const { return m_lines; }
 
-      const char *p = buf + 9;
-      while (*p == ' ')
-        p++;
+  private:
+    const char *m_p, *m_end;
+    int m_lines;
+};
 
-      int field = 0;
-      int p1[3] = {0}, p1cs = 0;
-      int p2[3] = {0}, p2cs = 0;
-      const char *textStart = NULL;
-      const char *actorStart = NULL;
-      int actorLen = 0;
-      bool validTimes = true;
-
-      while (*p && field < 9) {
-        const char *fieldStart = p;
-        while (*p && *p != ',')
-          p++;
+static void SkipSubSpaces(const char *&p, const char *end) {
+  while (p < end && (*p == ' ' || *p == '\t'))
+    p++;
+}
 
-        if (field == 1) {
-          if (sscanf(fieldStart, "%d:%d:%d.%d", &p1[0], &p1[1], &p1[2], &p1cs) != 4)
-            validTimes = false;
-        } else if (field == 2) {
-          if (sscanf(fieldStart, "%d:%d:%d.%d", &p2[0], &p2[1], &p2[2], &p2cs) != 4)
-            validTimes = false;
-        } else if (field == 4) {
-          actorStart = fieldStart;
-          const char *actorEnd = p;
-          actorLen = (int) (actorEnd - actorStart);
-        }
+// digits: optional, number of parsed digits
+static bool ParseSubInt(const char *&p, const char *end, int *v, int *digits = NULL) {
+  const char *start = p;
+  int n = 0;
+  while (p < end && *p >= '0' && *p <= '9')
+    n = n * 10 + (*p++ - '0');
+  *v = n;
+  if (digits)
+    *digits = (int) (p - start);
+  return p > start;
+}
+
+// parses "h:mm:ss<_sep>frac" (ASS: "0:00:01.50", SRT: "00:00:01,500")
+static bool ParseSubTime(const char *&p, const char *end, char sep, double *t) {
+  int h, m, s, frac, fracDigits;
+  SkipSubSpaces(p, end);
+  if (!ParseSubInt(p, end, &h) || p >= end || *p++ != ':' ||
+      !ParseSubInt(p, end, &m) || p >= end || *p++ != ':' ||
+      !ParseSubInt(p, end, &s) || p >= end || *p++ != sep ||
+      !ParseSubInt(p, end, &frac, &fracDigits))
+    return false;
 
-        if (*p == ',')
-          p++;
-        field++;
-      }
+  double div = 1.0;
+  while (fracDigits-- > 0)
+    div *= 10.0;
+  *t = h * 3600 + m * 60 + s + frac / div;
+  return true;
+}
 
-      if (field == 9)
-        textStart = p;
+// returns NULL if failed, otherwise it's up to the caller to free the returned buffer
+static WDL_HeapBuf *LoadSubtitleFile(const char *fn) {
+  WDL_HeapBuf *hb = LoadBin(fn);
+  if (hb && !hb->GetSize())
+    DELETE_NULL(hb);
+  return hb;
+}
+
+static void ReportSubImport(const char *fn, int lines, int subs, double startTime, double parsedTime) {
+#ifdef _SNM_DEBUG
+  char dbg[SNM_MAX_PATH + 128];
+  snprintf(dbg,
+           sizeof(dbg),
+           "Subtitle import: %s - %d lines, %d subtitles, parse: %.1f ms, total: %.1f ms\n",
+           fn,
+           lines,
+           subs,
+           (parsedTime - startTime) * 1000.0,
+           (time_precise() - startTime) * 1000.0);
+  OutputDebugString(dbg);
+#endif
+}
 
-      if (!validTimes)
-        continue;
+// shared by the ASS & SRT importers, once a subtitle is parsed
+// wantNum: region number for SRT indexes (-1: auto)
+static bool AddImportedSubtitle(double startTime,
+                                double endTime,
+                                const char *actor,
+                                const char *notes,
+                                int wantNum) {
+  SNM_Actor *actorObj = FindOrCreateActor(actor);
 
-      if (!textStart || !*textStart)
-        continue;
+  if (g_hideRegions) {
+    SNM_RegionSubtitle *sub = new SNM_RegionSubtitle(nullptr, -1, notes, actor);
+    sub->SetTimes(startTime, endTime);
+    g_pRegionSubs.Get()->Add(sub);
+    return true;
+  }
 
-      const char *textEnd = textStart;
-      while (*textEnd && *textEnd != '\r' && *textEnd != '\n')
-        textEnd++;
+  WDL_String name;
+  BuildRegionName(&name, actor, notes);
 
-      WDL_FastString notes;
-      notes.Append(textStart, (int) (textEnd - textStart));
-      StripAssFormattingTags(&notes);
+  int color = g_coloredRegions ? actorObj->GetEffectiveColor() : 0;
+  int num = AddProjectMarker2(NULL, true, startTime, endTime, name.Get(), wantNum, color);
+  if (num < 0)
+    return false;
 
-      WDL_FastString actor;
-      if (actorStart && actorLen > 0)
-        actor.Append(actorStart, actorLen);
-      else
-        actor.Set("?");
+  int id = MakeMarkerRegionId(num, true);
+  if (id > 0) {
+    SNM_RegionSubtitle *sub = new SNM_RegionSubtitle(nullptr, id, notes, actor);
+    sub->SetTimes(startTime, endTime);
+    g_pRegionSubs.Get()->Add(sub);
+  }
+  return true;
+}
 
-      SNM_Actor *actorObj = FindOrCreateActor(actor.Get());
+// regions are added in one go: parse everything first, then add regions
+// with UI refresh prevented (marker/region listeners are notified once,
+// on the next SNM timer tick)
+struct SNM_ImportedSubtitle {
+  double startTime, endTime;
+  int num;
+  WDL_FastString actor, notes;
+};
 
-      WDL_String name;
-      BuildRegionName(&name, actor.Get(), notes.Get());
+static bool AddImportedSubtitles(WDL_PtrList_DOD<SNM_ImportedSubtitle> *subs) {
+  bool ok = false;
+  double firstPos = -1.0;
 
-      double startTime = p1[0] * 3600 + p1[1] * 60 + p1[2] + double(p1cs) / 100;
-      double endTime = p2[0] * 3600 + p2[1] * 60 + p2[2] + double(p2cs) / 100;
+  if (!g_hideRegions)
+    PreventUIRefresh(1);
 
-      if (g_hideRegions) {
-        SNM_RegionSubtitle *sub = new SNM_RegionSubtitle(nullptr, -1, notes.Get());
-        sub->SetActor(actor.Get());
-        sub->SetTimes(startTime, endTime);
-        g_pRegionSubs.Get()->Add(sub);
-        ok = true;
-        if (firstPos < 0.0) firstPos = startTime;
-      } else {
-        int color = g_coloredRegions ? actorObj->GetEffectiveColor() : 0;
-        int num = AddProjectMarker2(NULL,
-                                    true,
-                                    startTime,
-                                    endTime,
-                                    name.Get(),
-                                    -1,
-                                    color);
-        if (num >= 0) {
-          ok = true;
-          if (firstPos < 0.0)
-            firstPos = startTime;
-          int id = MakeMarkerRegionId(num, true);
-          if (id > 0) {
-            SNM_RegionSubtitle *sub = new SNM_RegionSubtitle(nullptr, id, notes.Get());
-            sub->SetActor(actor.Get());
-            sub->SetTimes(startTime, endTime);
-            g_pRegionSubs.Get()->Add(sub);
-          }
-        }
-      }
+  for (int i = 0; i < subs->GetSize(); i++) {
+    SNM_ImportedSubtitle *sub = subs->Get(i);
+    if (AddImportedSubtitle(sub->startTime, sub->endTime, sub->actor.Get(), sub->notes.Get(), sub->num)) {
+      ok = true;
+      if (firstPos < 0.0)
+        firstPos = sub->startTime;
     }
-    fclose(f);
   }
 
+  if (!g_hideRegions)
+    PreventUIRefresh(-1);
+
   if (ok) {
     if (!g_hideRegions)
       UpdateTimeline();
@@ -2774,90 +2887,126 @@ bool ImportAssFile(const char *_fn) {
   return ok;
 }
 
-bool ImportSubRipFile(const char *_fn) {
-  bool ok = false;
-  double firstPos = -1.0;
-
-  // no need to check extension here, it's done for us
-  if (FILE *f = fopenUTF8(_fn, "rt")) {
-    char buf[1024];
-    if (fgets(buf, 4, f) && strcmp("\xEF\xBB\xBF", buf)) // UTF-8 BOM
-      rewind(f);
-    while (fgets(buf, sizeof(buf), f) && *buf) {
-      if (int num = atoi(buf)) {
-        if (fgets(buf, sizeof(buf), f) && *buf) {
-          int p1[4], p2[4];
-          if (sscanf(buf,
-                     "%d:%d:%d,%d --> %d:%d:%d,%d",
-                     &p1[0],
-                     &p1[1],
-                     &p1[2],
-                     &p1[3],
-                     &p2[0],
-                     &p2[1],
-                     &p2[2],
-                     &p2[3]) != 8) {
-            break;
-          }
-
-          WDL_FastString notes;
-          while (fgets(buf, sizeof(buf), f) && *buf) {
-            if (*buf == '\r' || *buf == '\n') break;
-            notes.Append(buf);
-          }
-          StripSrtFormattingTags(&notes);
+bool ImportAssFile(const char *_fn) {
+  const double startTime = time_precise();
+  WDL_HeapBuf *hb = LoadSubtitleFile(_fn);
+  if (!hb)
+    return false;
 
-          SNM_Actor *actorObj = FindOrCreateActor("?");
+  WDL_PtrList_DOD<SNM_ImportedSubtitle> subs;
+  SNM_SubLineReader reader((const char *) hb->Get(), hb->GetSize());
+  bool inEventsSection = false;
+  const char *line;
+  int len;
+  while (reader.Next(&line, &len)) {
+    const char *end = line + len;
+    if (len && line[0] == '[') {
+      inEventsSection = (len >= 8 && _strnicmp(line, "[Events]", 8) == 0);
+      continue;
+    }
 
-          WDL_String name;
-          BuildRegionName(&name, "?", notes.Get());
+    if (!inEventsSection || len < 9 || _strnicmp(line, "Dialogue:", 9) != 0)
+      continue;
 
-          double startTime = p1[0] * 3600 + p1[1] * 60 + p1[2] + double(p1[3]) / 1000;
-          double endTime = p2[0] * 3600 + p2[1] * 60 + p2[2] + double(p2[3]) / 1000;
+    const char *p = line + 9;
+    SkipSubSpaces(p, end);
+
+    // Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text
+    int field = 0;
+    double t1 = 0.0, t2 = 0.0;
+    const char *actorStart = NULL;
+    int actorLen = 0;
+    bool validTimes = true;
+    while (p < end && field < 9) {
+      const char *fieldStart = p;
+      while (p < end && *p != ',')
+        p++;
 
-          if (g_hideRegions) {
-            SNM_RegionSubtitle *sub = new SNM_RegionSubtitle(nullptr, -1, notes.Get(), "?");
-            sub->SetTimes(startTime, endTime);
-            g_pRegionSubs.Get()->Add(sub);
-            ok = true;
-            if (firstPos < 0.0) firstPos = startTime;
-          } else {
-            int color = g_coloredRegions ? actorObj->GetEffectiveColor() : 0;
-            num = AddProjectMarker2(NULL,
-                                    true,
-                                    startTime,
-                                    endTime,
-                                    name.Get(),
-                                    num,
-                                    color);
-
-            if (num >= 0) {
-              ok = true;
-
-              if (firstPos < 0.0)
-                firstPos = startTime;
-
-              int id = MakeMarkerRegionId(num, true);
-              if (id > 0) {
-                SNM_RegionSubtitle *sub = new SNM_RegionSubtitle(nullptr, id, notes.Get(), "?");
-                sub->SetTimes(startTime, endTime);
-                g_pRegionSubs.Get()->Add(sub);
-              }
-            }
-          }
-        } else
-          break;
+      if (field == 1 || field == 2) {
+        const char *tp = fieldStart;
+        if (!ParseSubTime(tp, p, '.', field == 1 ? &t1 : &t2))
+          validTimes = false;
+      } else if (field == 4) {
+        actorStart = fieldStart;
+        actorLen = (int) (p - fieldStart);
       }
+
+      if (p < end)
+        p++;
+      field++;
     }
-    fclose(f);
+
+    if (field != 9 || !validTimes || p >= end)
+      continue;
+
+    SNM_ImportedSubtitle *sub = subs.Add(new SNM_ImportedSubtitle);
+    sub->startTime = t1;
+    sub->endTime = t2;
+    sub->num = -1;
+    sub->notes.Set(p, (int) (end - p));
+    StripAssFormattingTags(&sub->notes);
+    if (actorStart && actorLen > 0)
+      sub->actor.Set(actorStart, actorLen);
+    else
+      sub->actor.Set("?");
   }
+  delete hb;
 
-  if (ok) {
-    if (!g_hideRegions)
-      UpdateTimeline();
-    if (firstPos > 0.0)
-      SetEditCurPos2(NULL, firstPos, true, false);
+  const double parsedTime = time_precise();
+  bool ok = AddImportedSubtitles(&subs);
+  ReportSubImport(_fn, reader.GetLineCount(), subs.GetSize(), startTime, parsedTime);
+  return ok;
+}
+
+bool ImportSubRipFile(const char *_fn) {
+  const double startTime = time_precise();
+  WDL_HeapBuf *hb = LoadSubtitleFile(_fn);
+  if (!hb)
+    return false;
+
+  // no need to check extension here, it's done for us
+  WDL_PtrList_DOD<SNM_ImportedSubtitle> subs;
+  SNM_SubLineReader reader((const char *) hb->Get(), hb->GetSize());
+  const char *line;
+  int len;
+  while (reader.Next(&line, &len)) {
+    const char *p = line, *end = line + len;
+    int num;
+    SkipSubSpaces(p, end);
+    if (!ParseSubInt(p, end, &num) || !num)
+      continue;
+
+    // "00:00:01,500 --> 00:00:03,000"
+    double t1, t2;
+    if (!reader.Next(&line, &len))
+      break;
+    p = line;
+    end = line + len;
+    if (!ParseSubTime(p, end, ',', &t1))
+      break;
+    SkipSubSpaces(p, end);
+    if (end - p < 3 || strncmp(p, "-->", 3))
+      break;
+    p += 3;
+    if (!ParseSubTime(p, end, ',', &t2))
+      break;
+
+    SNM_ImportedSubtitle *sub = subs.Add(new SNM_ImportedSubtitle);
+    sub->startTime = t1;
+    sub->endTime = t2;
+    sub->num = num;
+    sub->actor.Set("?");
+    while (reader.Next(&line, &len) && len) {
+      sub->notes.Append(line, len);
+      sub->notes.Append("\n");
+    }
+    StripSrtFormattingTags(&sub->notes);
   }
+  delete hb;
+
+  const double parsedTime = time_precise();
+  bool ok = AddImportedSubtitles(&subs);
+  ReportSubImport(_fn, reader.GetLineCount(), subs.GetSize(), startTime, parsedTime);
   return ok;
 }
 
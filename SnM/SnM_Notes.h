@@ -71,6 +71,10 @@ class SNM_TrackNotes {
     WDL_FastString m_notes;
 };
 
+// to be called on any change that affects subtitle lookups (times, ids, actors,
+// enabled states), invalidates the time/actor index used by the notes window
+void SubtitlesChanged();
+
 class SNM_RegionSubtitle {
   public:
     SNM_RegionSubtitle(ReaProject *project, const int id, const char *notes, const char *actor = "")
@@ -78,21 +82,24 @@ class SNM_RegionSubtitle {
         m_endTime{0.0} {
       if (!project)
         m_project = EnumProjects(-1, nullptr, 0);
+      SubtitlesChanged();
     }
+    ~SNM_RegionSubtitle() { SubtitlesChanged(); }
 
     int GetId() const { return m_id; }
-    void SetId(int id) { m_id = id; }
+    void SetId(int id) { m_id = id; SubtitlesChanged(); }
     bool IsValid() const { return GetMarkerRegionIndexFromId(m_project, m_id) >= 0; }
     const char *GetNotes() const { return m_notes.Get(); }
     int GetNotesLength() const { return m_notes.GetLength(); }
     void SetNotes(const char *notes) { m_notes.Set(notes); }
     const char *GetActor() const { return m_actor.Get(); }
-    void SetActor(const char *actor) { m_actor.Set(actor); }
+    void SetActor(const char *actor) { m_actor.Set(actor); SubtitlesChanged(); }
     double GetStartTime() const { return m_startTime; }
     double GetEndTime() const { return m_endTime; }
     void SetTimes(double start, double end) {
       m_startTime = start;
       m_endTime = end;
+      SubtitlesChanged();
     }
 
   private:
@@ -107,14 +114,16 @@ class SNM_Actor {
   public:
     SNM_Actor(const char *name, int color)
       : m_name{name}, m_color{color}, m_enabled{true}, m_hasCustomColor{false} {
+      SubtitlesChanged();
     }
+    ~SNM_Actor() { SubtitlesChanged(); }
 
     const char *GetName() const { return m_name.Get(); }
     int GetColor() const { return m_color; }
     void SetColor(int color) { m_color = color; }
     int GetEffectiveColor() const;
     bool IsEnabled() const { return m_enabled; }
-    void SetEnabled(bool enabled) { m_enabled = enabled; }
+    void SetEnabled(bool enabled) { m_enabled = enabled; SubtitlesChanged(); }
     bool HasCustomColor() const { return m_hasCustomColor; }
     void SetHasCustomColor(bool v) { m_hasCustomColor = v; }
     const char *GetLinkedActorName() const { return m_linkedActorName.Get(); }
@@ -125,6 +125,9 @@ double g_safeTimeToEndPlaylist = -1.0; 	// the 'smooth seek to after the end of
 										// with regular smooth seek --> we need to schedule it after markers
 bool g_endOfPlaylistSeekIssued = false;
 
+int g_seekLookahead = 0;		// ms, end of playlist seeks can be issued that early (e.g. slow polling or high latency)
+int g_plSchedGen = 0;			// bumped to invalidate all playlist schedules, see RgnPlaylistSchedule::IsValid()
+
 int g_oldSeekPref = -1;
 int g_oldStopprojlenPref = -1;
 int g_oldRepeatState = -1;
@@ -137,6 +140,74 @@ RegionPlaylist* GetPlaylist(int _plId = -1) {
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// RgnPlaylistSchedule
+///////////////////////////////////////////////////////////////////////////////
+
+// for updates that do not go through project state changes (e.g. marker/region
+// drag, playlist edits without undo point)
+void InvalidatePlaylistSchedules() {
+	g_plSchedGen++;
+}
+
+bool RgnPlaylistSchedule::IsValid(RegionPlaylist* _pl)
+{
+	ReaProject* proj = EnumProjects(-1, NULL, 0);
+	return m_gen == g_plSchedGen && m_proj == proj && m_items.GetSize() == _pl->GetSize() &&
+		m_stateCount == GetProjectStateChangeCount(proj) && m_mkrCount == CountProjectMarkers(proj, NULL, NULL);
+}
+
+void RgnPlaylistSchedule::Build(RegionPlaylist* _pl)
+{
+	const int sz = _pl->GetSize();
+	m_proj = EnumProjects(-1, NULL, 0);
+	m_stateCount = GetProjectStateChangeCount(m_proj);
+	m_mkrCount = CountProjectMarkers(m_proj, NULL, NULL);
+	m_gen = g_plSchedGen;
+	m_items.Resize(sz, false);
+	m_next.Resize(sz, false);
+	m_prev.Resize(sz, false);
+	m_valids.Resize(0, false);
+
+	for (int i=0; i<sz; i++)
+	{
+		Item* item = m_items.Get()+i;
+		RgnPlaylistItem* plItem = _pl->Get(i);
+		item->m_rgnId = plItem ? plItem->m_rgnId : -1;
+		item->m_cnt = plItem ? plItem->m_cnt : 0;
+		item->m_rgnNum = -1;
+		item->m_pos = 0.0;
+		item->m_end = -1.0;
+		item->m_valid = item->m_rgnId>0 && item->m_cnt!=0 &&
+			EnumMarkerRegionById(NULL, item->m_rgnId, NULL, &item->m_pos, &item->m_end, NULL, &item->m_rgnNum, NULL)>=0;
+		if (item->m_valid)
+			m_valids.Add(i);
+		m_prev.Get()[i] = item->m_valid ? i : (i ? m_prev.Get()[i-1] : -1);
+	}
+	for (int i=sz-1; i>=0; i--)
+		m_next.Get()[i] = m_items.Get()[i].m_valid ? i : (i<sz-1 ? m_next.Get()[i+1] : -1);
+}
+
+int RgnPlaylistSchedule::GetNextValid(int _i) const {
+	return _i>=0 && _i<m_next.GetSize() ? m_next.Get()[_i] : -1;
+}
+
+int RgnPlaylistSchedule::GetPrevValid(int _i) const {
+	if (_i >= m_prev.GetSize()) _i = m_prev.GetSize()-1;
+	return _i>=0 ? m_prev.Get()[_i] : -1;
+}
+
+// return the 1st valid item in [_from, _to[ whose region contains _pos, -1 if none
+int RgnPlaylistSchedule::Find(double _pos, int _from, int _to) const
+{
+	if (_to > m_items.GetSize()) _to = m_items.GetSize();
+	for (int i=GetNextValid(_from); i>=0 && i<_to; i=GetNextValid(i+1))
+		if (_pos >= m_items.Get()[i].m_pos && _pos <= m_items.Get()[i].m_end)
+			return i;
+	return -1;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // RegionPlaylist
 ///////////////////////////////////////////////////////////////////////////////
@@ -163,20 +234,12 @@ bool RegionPlaylist::IsValidIem(int _i)
 // return the first found playlist idx for _pos
 int RegionPlaylist::IsInPlaylist(double _pos, bool _repeat, int _startWith)
 {
-	double rgnpos, rgnend;
-	for (int i=_startWith; i<GetSize(); i++)
-		if (RgnPlaylistItem* plItem = Get(i))
-			if (plItem->m_rgnId>0 && plItem->m_cnt!=0 && EnumMarkerRegionById(NULL, plItem->m_rgnId, NULL, &rgnpos, &rgnend, NULL, NULL, NULL)>=0)
-				if (_pos >= rgnpos && _pos <= rgnend)
-					return i;
+	const RgnPlaylistSchedule* sched = GetSchedule();
+	int found = sched->Find(_pos, _startWith, GetSize());
 	// 2nd try
-	if (_repeat)
-		for (int i=0; i<_startWith; i++)
-			if (RgnPlaylistItem* plItem = Get(i))
-				if (plItem->m_rgnId>0 && plItem->m_cnt!=0 && EnumMarkerRegionById(NULL, plItem->m_rgnId, NULL, &rgnpos, &rgnend, NULL, NULL, NULL)>=0)
-					if (_pos >= rgnpos && _pos <= rgnend)
-						return i;
-	return -1;
+	if (found<0 && _repeat)
+		found = sched->Find(_pos, 0, _startWith);
+	return found;
 }
 
 int RegionPlaylist::IsInfinite()
@@ -289,6 +352,13 @@ int RegionPlaylist::GetDangerouslyShortRegion()
 	return -1;
 }
 
+const RgnPlaylistSchedule* RegionPlaylist::GetSchedule()
+{
+	if (!m_sched.IsValid(this))
+		m_sched.Build(this);
+	return &m_sched;
+}
+
 // get the 1st marker/region num which has a marker/region > _pos
 int RegionPlaylist::GetGreaterMarkerRegion(double _pos)
 {
@@ -330,6 +400,7 @@ RegionPlaylistView::RegionPlaylistView(HWND hwndList, HWND hwndEdit)
 // (e.g. 2 consecutive regions "7" are merged into one with loop counter = 2)
 void RegionPlaylistView::UpdateCompact()
 {
+	InvalidatePlaylistSchedules();
 	if (RegionPlaylist* pl = GetPlaylist())
 		for (int i=pl->GetSize()-1; i>=0 ; i--)
 			if (RgnPlaylistItem* item = pl->Get(i))
@@ -490,6 +561,7 @@ void RegionPlaylistView::OnDrag()
 			pl->Insert(iNewPriority, m_draggedItems.Get(i));
 		}
 
+		InvalidatePlaylistSchedules();
 		Update(true); // no UpdateCompact() here, it would crash! see OnEndDrag()
 
 		for (int i=0; i < m_draggedItems.GetSize(); i++)
@@ -1302,16 +1374,13 @@ namespace {
 
 	int GetShuffledItem(RegionPlaylist* playlist) {
 		// Returns -1 if no item is found.
-		int numItems = playlist->GetSize();
-		int attempts = 0;
-		int timestamp = static_cast<int>(time_precise() * 1000);
-		while (attempts < 10 && numItems > 1) {
+		// Picks among valid items only, no need to retry on invalid ones
+		const RgnPlaylistSchedule* sched = playlist->GetSchedule();
+		const int numValids = sched->GetValidCount();
+		if (playlist->GetSize() > 1 && numValids > 0) {
+			int timestamp = static_cast<int>(time_precise() * 1000);
 			WDL_UINT64 randomIndex = XS64Rand(timestamp).rand64();
-			int candidateItem = static_cast<int>(randomIndex % numItems);
-			if (playlist->IsValidIem(candidateItem)) {
-				return candidateItem;
-			}
-			attempts++;
+			return sched->GetValid(static_cast<int>(randomIndex % numValids));
 		}
 		return -1;
 	}
@@ -1334,15 +1403,18 @@ int GetNextValidItem(int _plId, int _itemId, bool _startWith, bool _repeat, bool
 				}
 				// Fall back on default behavior if shuffling fails...
 			}
-			for (int i=_itemId+(_startWith?0:1); i<pl->GetSize(); i++)
-				if (pl->IsValidIem(i))
-					return i;
+			const RgnPlaylistSchedule* sched = pl->GetSchedule();
+			int i = sched->GetNextValid(_itemId+(_startWith?0:1));
+			if (i>=0)
+				return i;
 			if (_repeat)
-				for (int i=0; i<pl->GetSize() && i<(_itemId+(_startWith?1:0)); i++)
-					if (pl->IsValidIem(i))
-						return i;
+			{
+				i = sched->GetNextValid(0);
+				if (i>=0 && i<(_itemId+(_startWith?1:0)))
+					return i;
+			}
 			// not found if we are here..
-			if (_repeat && pl->IsValidIem(_itemId))
+			if (_repeat && sched->IsValidItem(_itemId))
 				return _itemId;
 		}
 	}
@@ -1364,15 +1436,18 @@ int GetPrevValidItem(int _plId, int _itemId, bool _startWith, bool _repeat, bool
 				}
 				// Fall back on default behavior if shuffling fails...
 			}
-			for (int i = _itemId - (_startWith ? 0 : 1); i >= 0; i--)
-				if (pl->IsValidIem(i))
-					return i;
+			const RgnPlaylistSchedule* sched = pl->GetSchedule();
+			int i = sched->GetPrevValid(_itemId - (_startWith ? 0 : 1));
+			if (i >= 0)
+				return i;
 			if (_repeat)
-				for (int i = pl->GetSize() - 1; i >= 0 && i > (_itemId - (_startWith ? 1 : 0)); i--)
-					if (pl->IsValidIem(i))
-						return i;
+			{
+				i = sched->GetPrevValid(pl->GetSize() - 1);
+				if (i > (_itemId - (_startWith ? 1 : 0)))
+					return i;
+			}
 			// not found if we are here..
-			if (_repeat && pl->IsValidIem(_itemId))
+			if (_repeat && sched->IsValidItem(_itemId))
 				return _itemId;
 		}
 	}
@@ -1438,17 +1513,16 @@ bool SeekItem(const int _plId, const int _nextItemId, const int _curItemId, cons
 			}
 			return true;
 		}
-		else if (RgnPlaylistItem* next = pl->Get(_nextItemId))
+		else if (const RgnPlaylistSchedule::Item* next = pl->GetSchedule()->Get(_nextItemId))
 		{
-			double a, b;
-			if (EnumMarkerRegionById(NULL, next->m_rgnId, NULL, &a, &b, NULL, NULL, NULL)>=0)
+			if (next->m_valid)
 			{
 				g_playNext = _nextItemId;
-				g_nextRegionId = GetMarkerRegionNumFromId(next->m_rgnId);
+				g_nextRegionId = next->m_rgnNum;
 				g_playCur = _plId==g_playPlaylist ? g_playCur : _curItemId;
 				g_rgnLoop = next->m_cnt<0 ? -1 : next->m_cnt>1 ? next->m_cnt : 0;
-				g_nextRgnPos = a;
-				g_nextRgnEnd = b;
+				g_nextRgnPos = next->m_pos;
+				g_nextRgnEnd = next->m_end;
 				if (_curItemId<0) {
 					g_curRgnPos = 0.0;
 					g_curRgnEnd = -1.0;
@@ -1505,7 +1579,7 @@ void PlaylistRun()
 	const bool isPlaylistAboutToEnd = -1 == g_playNext;
 	if (isPlaylistAboutToEnd)
 	{
-		if (!g_endOfPlaylistSeekIssued && g_safeTimeToEndPlaylist < pos) {
+		if (!g_endOfPlaylistSeekIssued && g_safeTimeToEndPlaylist < pos+g_seekLookahead/1000.0) {
 			SeekPlay(g_nextRgnPos);
 			g_endOfPlaylistSeekIssued = true;
 		}
@@ -1552,8 +1626,8 @@ void PlaylistRun()
 					//     or playlist = region3, then unknown region (e.g. deleted) and region3 again, or etc..
 					if (nextId>=0)
 						if (RegionPlaylist* pl = GetPlaylist(g_playPlaylist))
-							if (RgnPlaylistItem* next = pl->Get(nextId)) 
-								if (RgnPlaylistItem* cur = pl->Get(g_playCur)) 
+							if (const RgnPlaylistSchedule::Item* next = pl->GetSchedule()->Get(nextId))
+								if (const RgnPlaylistSchedule::Item* cur = pl->GetSchedule()->Get(g_playCur))
 									g_plLoop = (cur->m_rgnId==next->m_rgnId); // valid regions at this point
 
 #ifdef _SNM_RGNPL_DEBUG1
@@ -1852,6 +1926,7 @@ void PlaylistUnpaused() {
 // used when editing the playlist/regions while playing (required because we always look one region ahead)
 void PlaylistResync()
 {
+	InvalidatePlaylistSchedules();
 	if (RegionPlaylist* pl = GetPlaylist(g_playPlaylist))
 		if (RgnPlaylistItem* item = pl->Get(g_playCur))
 			SeekItem(g_playPlaylist, GetNextValidItem(g_playPlaylist, g_playCur, item->m_cnt<0 || item->m_cnt>1, g_repeatPlaylist, g_shufflePlaylist), g_playCur, SeekMethod::IgnoreMarkers);
@@ -2203,7 +2278,7 @@ void PlaylistUpdateJob::Perform() {
 
 // ScheduledJob used because of multi-notifs
 void PlaylistMarkerRegionListener::NotifyMarkerRegionUpdate(int _updateFlags) {
-	PlaylistResync();
+	PlaylistResync(); // invalidates playlist schedules too
 	ScheduledJob::Schedule(new PlaylistUpdateJob(SNM_SCHEDJOB_ASYNC_DELAY_OPT));
 }
 
@@ -2239,6 +2314,7 @@ static bool ProcessExtensionLine(const char *line, ProjectStateContext *ctx, boo
 				else
 					break;
 			}
+			InvalidatePlaylistSchedules();
 			if (RegionPlaylistWnd* w = g_rgnplWndMgr.Get()) {
 				w->FillPlaylistCombo();
 				w->Update();
@@ -2300,6 +2376,7 @@ int RegionPlaylistInit()
 	g_repeatPlaylist = GetPrivateProfileInt("RegionPlaylist", "Repeat", 0, g_SNM_IniFn.Get());
 	g_seekImmediate = GetPrivateProfileInt("RegionPlaylist", "SeekImmediate", 0, g_SNM_IniFn.Get());
 	g_shufflePlaylist = GetPrivateProfileInt("RegionPlaylist", "ShufflePlaylist", 0, g_SNM_IniFn.Get());
+	g_seekLookahead = BOUNDED(GetPrivateProfileInt("RegionPlaylist", "SeekLookahead", 0, g_SNM_IniFn.Get()), 0, 1000);
 	g_optionFlags = GetPrivateProfileInt("RegionPlaylist", "SeekPlay", 0, g_SNM_IniFn.Get());
 	GetPrivateProfileString("RegionPlaylist", "BigFontName", SNM_DYN_FONT_NAME, g_rgnplBigFontName, sizeof(g_rgnplBigFontName), g_SNM_IniFn.Get());
 	GetPrivateProfileString("RegionPlaylist", "OscFeedback", "", buf, sizeof(buf), g_SNM_IniFn.Get());
@@ -2327,6 +2404,7 @@ void RegionPlaylistExit()
 		{ "SeekImmediate",   g_seekImmediate   },
 		{ "ShufflePlaylist", g_shufflePlaylist },
 		{ "SeekPlay",        g_optionFlags     },
+		{ "SeekLookahead",   g_seekLookahead   },
 	};
 	for(const auto &pair : intOptions) {
 		snprintf(format, sizeof(format), "%d", pair.second);
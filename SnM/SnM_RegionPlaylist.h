@@ -49,6 +49,37 @@ public:
 	int m_rgnId, m_cnt;
 };
 
+class RegionPlaylist;
+
+// playback schedule: playlist items resolved against the project's regions so that
+// PlaylistRun() & co do not have to look regions up on each poll.
+// Built on demand, rebuilt on project/marker/region/playlist updates (see IsValid())
+class RgnPlaylistSchedule {
+public:
+	struct Item {
+		bool m_valid; // see RgnPlaylistItem::IsValidIem()
+		int m_rgnId, m_rgnNum, m_cnt;
+		double m_pos, m_end;
+	};
+	RgnPlaylistSchedule() : m_proj(NULL), m_stateCount(-1), m_mkrCount(-1), m_gen(-1) {}
+	bool IsValid(RegionPlaylist* _pl);
+	void Build(RegionPlaylist* _pl);
+	int GetSize() const { return m_items.GetSize(); }
+	const Item* Get(int _i) const { return _i>=0 && _i<m_items.GetSize() ? m_items.Get()+_i : NULL; }
+	bool IsValidItem(int _i) const { const Item* item = Get(_i); return item && item->m_valid; }
+	int GetNextValid(int _i) const; // 1st valid item >= _i, -1 if none
+	int GetPrevValid(int _i) const; // last valid item <= _i, -1 if none
+	int GetValidCount() const { return m_valids.GetSize(); }
+	int GetValid(int _i) const { return m_valids.Get()[_i]; }
+	int Find(double _pos, int _from, int _to) const;
+private:
+	ReaProject* m_proj;
+	int m_stateCount, m_mkrCount, m_gen;
+	WDL_TypedBuf<Item> m_items;
+	WDL_TypedBuf<int> m_next, m_prev; // by item index, see GetNextValid(), GetPrevValid()
+	WDL_TypedBuf<int> m_valids;       // valid item indexes
+};
+
 class RegionPlaylist : public WDL_PtrList<RgnPlaylistItem> {
 public:
 	RegionPlaylist(RegionPlaylist* _pl = NULL, const char* _name = NULL);
@@ -62,7 +93,10 @@ public:
 	int GetRegionWithUnsafeMarker();
 	int GetDangerouslyShortRegion();
 	int GetGreaterMarkerRegion(double _pos);
+	const RgnPlaylistSchedule* GetSchedule();
 	WDL_FastString m_name;
+private:
+	RgnPlaylistSchedule m_sched;
 };
 
 class RegionPlaylists : public WDL_PtrList<RegionPlaylist>
@@ -133,6 +167,7 @@ protected:
 	void Perform();
 };
 
+void InvalidatePlaylistSchedules();
 int GetNextValidItem(int _playlistId, int _itemId, bool _startWith, bool _repeat, bool _shuffle);
 int GetPrevValidItem(int _playlistId, int _itemId, bool _startWith, bool _repeat, bool _shuffle);
 bool SeekItem(int _plId, int _nextItemId, int _curItemId);
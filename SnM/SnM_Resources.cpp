@@ -2538,41 +2538,68 @@ void AutoSave(int _type, bool _ow, int _flags)
 	}
 }
 
+static SNM_FileScanner g_autoFillScanner;
+
 // recursive from auto-fill path
+// files are scanned in background and slots are added as they are found, see AutoFillJob
+// note: auto-filling again while a scan is running cancels it and starts the new one
 void AutoFill(int _type)
 {
 	ResourceList* fl = g_SNM_ResSlots.Get(_type);
 	if (!fl)
 		return;
 
+	g_autoFillScanner.Cancel();
+
 	if (!CheckSetAutoDirectory(__LOCALIZE("Auto-fill","sws_DLG_150"), _type, false))
 		return;
 
-	int startSlot = g_SNM_ResSlots.Get(_type)->GetSize();
-
 	char fileFilter[2048] = ""; // filters need some room!
 	fl->GetFileFilter(fileFilter, sizeof(fileFilter), false);
 
-	WDL_PtrList_DeleteOnDestroy<WDL_String> files; 
-	ScanFiles(&files, GetAutoFillDir(_type), fileFilter, true);
-	if (int sz = files.GetSize())
+	g_autoFillScanner.Start(GetAutoFillDir(_type), fileFilter, true);
+	ScheduledJob::Schedule(new AutoFillJob(fl, fl->GetSize(), 0));
+}
+
+// polls the auto-fill scanner and adds found files to slots
+void AutoFillJob::Perform()
+{
+	int type = g_SNM_ResSlots.Find(m_list);
+	if (type < 0) { // bookmark deleted in the meantime
+		g_autoFillScanner.Cancel();
+		return;
+	}
+
+	// check before collecting results, not to miss the last ones
+	const bool done = !g_autoFillScanner.IsRunning();
+
+	WDL_PtrList_DeleteOnDestroy<WDL_String> files;
+	int startSlot = m_list->GetSize();
+	if (int sz = g_autoFillScanner.GetResults(&files))
 		for (int i=0; i<sz; i++)
-			if (fl->FindByPath(files.Get(i)->Get()) < 0) { // skip if already present
-				TieResFileToProject(files.Get(i)->Get(), _type);
-				fl->AddSlot(files.Get(i)->Get());
+			if (m_list->FindByPath(files.Get(i)->Get()) < 0) { // skip if already present
+				TieResFileToProject(files.Get(i)->Get(), type);
+				m_list->AddSlot(files.Get(i)->Get());
 			}
 
-	if (startSlot != fl->GetSize())
+	int added = m_added + m_list->GetSize() - startSlot;
+	if (startSlot != m_list->GetSize())
 	{
-		if (g_resType==_type)
+		if (g_resType==type)
 			if (ResourcesWnd* w = g_resWndMgr.Get()) {
 				w->Update();
-				w->SelectBySlot(startSlot, g_SNM_ResSlots.Get(_type)->GetSize());
+				if (m_startSlot < m_list->GetSize())
+					w->SelectBySlot(m_startSlot, m_list->GetSize());
 			}
 	}
-	else
+
+	if (!done)
 	{
-		const char* path = GetAutoFillDir(_type);
+		ScheduledJob::Schedule(new AutoFillJob(m_list, m_startSlot, added));
+	}
+	else if (!added && !g_autoFillScanner.WasCancelled())
+	{
+		const char* path = GetAutoFillDir(type);
 		char msg[SNM_MAX_PATH]="";
 		if (path && *path) snprintf(msg, sizeof(msg), __LOCALIZE_VERFMT("No slot added from: %s\n%s","sws_DLG_150"), path, AUTOFILL_ERR_STR);
 		else snprintf(msg, sizeof(msg), __LOCALIZE_VERFMT("No slot added!\n%s","sws_DLG_150"), AUTOFILL_ERR_STR);
@@ -3291,6 +3318,8 @@ int ResourcesInit()
 
 void ResourcesExit()
 {
+	g_autoFillScanner.Cancel();
+
 	plugin_register("-projectconfig", &s_projectconfig);
 
 	WDL_PtrList_DeleteOnDestroy<WDL_FastString> iniSections;
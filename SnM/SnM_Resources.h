@@ -173,6 +173,16 @@ protected:
 	void Perform();
 };
 
+class AutoFillJob : public ScheduledJob {
+public:
+	AutoFillJob(ResourceList* _list, int _startSlot, int _added)
+		: ScheduledJob(SNM_SCHEDJOB_RES_AUTOFILL, SNM_SCHEDJOB_DEFAULT_DELAY), m_list(_list), m_startSlot(_startSlot), m_added(_added) {}
+protected:
+	void Perform();
+	ResourceList* m_list;
+	int m_startSlot, m_added;
+};
+
 
 extern WDL_PtrList_DOD<ResourceList> g_SNM_ResSlots;
 extern int g_tiedSlotActions[SNM_NUM_DEFAULT_SLOTS];
@@ -924,9 +924,13 @@ bool ApplyTrackTemplate(MediaTrack* _tr, WDL_FastString* _tmplt, bool _itemsFrom
 		if (_tr != GetMasterTrack(NULL))
 		{
 			CopySendsReceives(true, &trs, &snds, &rcvs);
-			// parse twice but it does not cost much (search at the very start of the chunk)
-			p->Parse(SNM_GET_SUBCHUNK_OR_LINE, 1, "TRACK", "ISBUS", 0, -1, &busLine, NULL, "BUSCOMP");
-			p->Parse(SNM_GET_SUBCHUNK_OR_LINE, 1, "TRACK", "BUSCOMP", 0, -1, &compbusLine, NULL, "SHOWINMIX");
+			SNM_ChunkQuery q[2] = {
+				SNM_ChunkQuery(1, "TRACK", "ISBUS", 0, -1, "BUSCOMP"),
+				SNM_ChunkQuery(1, "TRACK", "BUSCOMP", 0, -1, "SHOWINMIX")
+			};
+			p->ParseQueries(q, 2);
+			q[0].GetLine(p->GetChunk()->Get(), &busLine);
+			q[1].GetLine(p->GetChunk()->Get(), &compbusLine);
 		}
 
 		// apply tr template
@@ -1062,7 +1066,9 @@ void SaveSelTrackTemplates(bool _delItems, bool _delEnvs, WDL_FastString* _chunk
 
 	// update receives ids ----------------------------------------------------
 	// no break keyword used here: multiple tracks in the template
+	// batched: positions and occurrences refer to the unaltered chunk
 	SNM_ChunkParserPatcher p(_chunkOut);
+	p.BeginEdits();
 	WDL_FastString line;
 	int occurence = 0;
 	int pos = p.Parse(SNM_GET_SUBCHUNK_OR_LINE, 1, "TRACK", "AUXRECV", occurence, 1, &line); 
@@ -1089,17 +1095,14 @@ void SaveSelTrackTemplates(bool _delItems, bool _delEnvs, WDL_FastString* _chunk
 						WDL_FastString newRcv;
 						newRcv.SetFormatted(SNM_MAX_CHUNK_LINE_LENGTH, "AUXRECV %d%s\n", newId, p3rdTokenToEol);
 						replaced = p.ReplaceLine(pos, newRcv.Get());
-						if (replaced)
-							occurence++;
 					}
 				}
 			}
 		}
 
 		if (!replaced)
-			replaced = p.ReplaceLine(pos, "");
-		if (!replaced) // skip, just in case..
-			occurence++;
+			p.ReplaceLine(pos, "");
+		occurence++;
 
 		line.Set("");
 		pos = p.Parse(SNM_GET_SUBCHUNK_OR_LINE, 1, "TRACK", "AUXRECV", occurence, 1, &line);
@@ -31,11 +31,16 @@
 #include "SnM_Chunk.h"
 #include "SnM_Util.h"
 #include "../cfillion/cfillion.hpp" // CF_LocateInExplorer
+#include "../Utility/ThreadPool.h"
 
 #include <WDL/localize/localize.h>
 #include <WDL/sha.h>
 #include <WDL/projectcontext.h>
 
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
 ///////////////////////////////////////////////////////////////////////////////
 // File util
 ///////////////////////////////////////////////////////////////////////////////
@@ -457,53 +462,303 @@ bool IsDirNoRecurse(const WDL_DirScan &ds)
 	return (ds.GetCurrentIsDirectory() & (IsDir | IsDirSymlink)) != 0;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Directory index & file scanners
+// Directory listings are cached with their modification time so that rescans
+// only list directories where files/sub-directories were added, removed or
+// renamed (unchanged directories are just stat'ed).
+///////////////////////////////////////////////////////////////////////////////
+
+// listing of a directory, in WDL_DirScan order
+struct SNM_DirListing
+{
+	time_t m_mtime, m_scanTime;
+	std::vector<std::pair<std::string,bool> > m_entries; // name, is directory
+};
+
+static SWS_Mutex g_dirIndexMutex;
+static std::unordered_map<std::string,std::shared_ptr<const SNM_DirListing> > g_dirIndex;
+
+static std::shared_ptr<const SNM_DirListing> GetDirListing(const char* _dir)
+{
+	struct stat s;
+#ifdef _WIN32
+	const bool ok = (statUTF8(_dir, &s) == 0);
+#else
+	const bool ok = (stat(_dir, &s) == 0);
+#endif
+	if (!ok)
+	{
+		SWS_SectionLock lock(&g_dirIndexMutex);
+		g_dirIndex.erase(_dir);
+		return NULL;
+	}
+
+	{
+		SWS_SectionLock lock(&g_dirIndexMutex);
+		std::unordered_map<std::string,std::shared_ptr<const SNM_DirListing> >::const_iterator it = g_dirIndex.find(_dir);
+		// listings done in the same second as the last modification are not trusted
+		if (it != g_dirIndex.end() && it->second->m_mtime == s.st_mtime && it->second->m_scanTime > s.st_mtime+1)
+			return it->second;
+	}
+
+	WDL_DirScan ds;
+	if (ds.First(_dir))
+		return NULL;
+
+	std::shared_ptr<SNM_DirListing> listing = std::make_shared<SNM_DirListing>();
+	listing->m_mtime = s.st_mtime;
+	listing->m_scanTime = time(NULL);
+	do
+	{
+		const char* curFn = ds.GetCurrentFN();
+		if (strcmp(curFn, ".") && strcmp(curFn, ".."))
+			listing->m_entries.push_back(std::make_pair(std::string(curFn), IsDirNoRecurse(ds)));
+	}
+	while(!ds.Next());
+
+	SWS_SectionLock lock(&g_dirIndexMutex);
+	g_dirIndex[_dir] = listing;
+	return listing;
+}
+
+// file extensions of a filter list, ex: "*.ext1 *.ext2" or "Desc|*.ext1;*.ext2|"
+class SNM_FileExtFilter
+{
+public:
+	SNM_FileExtFilter(const char* _filterList) : m_all(!strcmp("*", _filterList)) // || !strcmp("*.*", _filterList))
+	{
+		if (m_all)
+			return;
+		for (const char* p = strstr(_filterList, "*."); p; p = strstr(p, "*."))
+		{
+			p += 2;
+			std::string ext;
+			while (*p && !strchr(";|, \t)", *p))
+				ext.push_back((char)tolower((unsigned char)*p++));
+			if (ext.size() && ext != "*")
+				m_exts.insert(ext);
+		}
+	}
+
+	bool Match(const char* _fn) const
+	{
+		if (m_all)
+			return true;
+		const char* ext = GetFileExtension(_fn);
+		if (!*ext)
+			return false;
+		std::string lowExt(ext);
+		for (size_t i=0; i<lowExt.size(); i++)
+			lowExt[i] = (char)tolower((unsigned char)lowExt[i]);
+		return m_exts.find(lowExt) != m_exts.end();
+	}
+
+private:
+	bool m_all;
+	std::unordered_set<std::string> m_exts;
+};
+
+static void ScanFiles(WDL_PtrList<WDL_String>* _files, const char* _dir, const SNM_FileExtFilter& _filter, bool _subdirs)
+{
+	std::shared_ptr<const SNM_DirListing> listing = GetDirListing(_dir);
+	if (!listing)
+		return;
+
+	WDL_FastString fn;
+	for (size_t i=0; i<listing->m_entries.size(); i++)
+	{
+		const std::pair<std::string,bool>& entry = listing->m_entries[i];
+		if (entry.second && !_subdirs)
+			continue;
+		if (!entry.second && !_filter.Match(entry.first.c_str()))
+			continue;
+
+		fn.SetFormatted(SNM_MAX_PATH, "%s%c%s", _dir, PATH_SLASH_CHAR, entry.first.c_str());
+		if (entry.second)
+			ScanFiles(_files, fn.Get(), _filter, true);
+		else
+			_files->Add(new WDL_String(fn.Get()));
+	}
+}
+
 // fills a list of filenames matching extensions defined in _filterList
 // _filterList: file extensions without null separators, ex: "*.ext1 *.ext2" ("*" == all files)
 // note: it is up to the caller to free _files (use WDL_PtrList_DeleteOnDestroy)
 void ScanFiles(WDL_PtrList<WDL_String>* _files, const char* _initDir, const char* _filterList, bool _subdirs)
 {
-	WDL_DirScan ds;
-	if (_files && _initDir && !ds.First(_initDir))
+	if (_files && _initDir && _filterList)
+		ScanFiles(_files, _initDir, SNM_FileExtFilter(_filterList), _subdirs);
+}
+
+// SNM_FileScanner: directories are scanned in parallel, one thread pool job per directory.
+// Results are handed out in the same order as ScanFiles() would return them: each directory
+// keeps its entries (files or sub-directories) in listing order and GetResults() walks that
+// tree depth-first, stopping at the first directory that isn't scanned yet
+
+struct SNM_ScanNode
+{
+	SNM_ScanNode() : m_done(false) {}
+	bool m_done;
+	std::vector<std::pair<std::string,SNM_ScanNode*> > m_entries; // file path or sub-directory node
+};
+
+struct SNM_FileScanner::Context
+{
+	Context(const char* _filterList, bool _subdirs)
+		: m_filter(_filterList), m_subdirs(_subdirs), m_cancel(false), m_pending(0) {}
+	~Context() { m_nodes.Empty(true); }
+
+	SWS_Mutex m_mutex;
+	SNM_FileExtFilter m_filter;
+	bool m_subdirs;
+	volatile bool m_cancel;
+	int m_pending;                                          // queued or running directory jobs
+	WDL_PtrList<SNM_ScanNode> m_nodes;                      // all directories (m_nodes.Get(0): root)
+	std::vector<std::pair<SNM_ScanNode*,size_t> > m_cursor; // next entry to collect, depth-first
+};
+
+struct SNM_ScanDirJob
+{
+	SNM_FileScanner::Context* m_ctx;
+	SNM_ScanNode* m_node;
+	std::string m_dir;
+};
+
+static SWS_ThreadPool g_scanPool; // one thread per CPU core
+
+static unsigned WINAPI ScanDirJob(void* _job);
+
+static SNM_ScanNode* SubmitScanDir(SNM_FileScanner::Context* _ctx, const char* _dir)
+{
+	SNM_ScanDirJob* job = new SNM_ScanDirJob;
+	job->m_ctx = _ctx;
+	job->m_node = new SNM_ScanNode;
+	job->m_dir.assign(_dir);
+	{
+		SWS_SectionLock lock(&_ctx->m_mutex);
+		_ctx->m_nodes.Add(job->m_node);
+		_ctx->m_pending++;
+	}
+	SNM_ScanNode* node = job->m_node; // job can be deleted by the time Submit() returns
+	g_scanPool.Submit(ScanDirJob, job);
+	return node;
+}
+
+static unsigned WINAPI ScanDirJob(void* _job)
+{
+	SNM_ScanDirJob* job = (SNM_ScanDirJob*)_job;
+	SNM_FileScanner::Context* ctx = job->m_ctx;
+
+	std::shared_ptr<const SNM_DirListing> listing;
+	if (!ctx->m_cancel)
+		listing = GetDirListing(job->m_dir.c_str());
+
+	std::vector<std::pair<std::string,SNM_ScanNode*> > entries;
+	if (listing)
 	{
-		const char* curFn;
-		const char* curfnExt;
-		WDL_FastString fn, ext;
-		do 
+		WDL_FastString fn;
+		for (size_t i=0; i<listing->m_entries.size() && !ctx->m_cancel; i++)
 		{
-			curFn = ds.GetCurrentFN();
-			if (!strcmp(curFn, ".") || !strcmp(curFn, "..")) 
+			const std::pair<std::string,bool>& entry = listing->m_entries[i];
+			if (entry.second ? !ctx->m_subdirs : !ctx->m_filter.Match(entry.first.c_str()))
 				continue;
 
-			if (IsDirNoRecurse(ds))
-			{
-				if (_subdirs) {
-					ds.GetCurrentFullFN(&fn);
-					ScanFiles(_files, fn.Get(), _filterList, true);
-				}
-			}
+			fn.SetFormatted(SNM_MAX_PATH, "%s%c%s", job->m_dir.c_str(), PATH_SLASH_CHAR, entry.first.c_str());
+			if (entry.second)
+				entries.push_back(std::make_pair(std::string(), SubmitScanDir(ctx, fn.Get())));
 			else
-			{
-				if (!strcmp("*", _filterList)) // || !strcmp("*.*", _filterList))
-				{
-					ds.GetCurrentFullFN(&fn);
-					_files->Add(new WDL_String(fn.Get()));
-				}
-				else
-				{
-					curfnExt = GetFileExtension(curFn);
-					if (*curfnExt)
-					{
-						ext.SetFormatted(64, "*.%s", curfnExt);
-						if (stristr(_filterList, ext.Get())) {
-							ds.GetCurrentFullFN(&fn);
-							_files->Add(new WDL_String(fn.Get()));
-						}
-					}
-				}
-			}
+				entries.push_back(std::make_pair(std::string(fn.Get()), (SNM_ScanNode*)NULL));
+		}
+	}
+
+	SWS_SectionLock lock(&ctx->m_mutex);
+	job->m_node->m_entries.swap(entries);
+	job->m_node->m_done = true;
+	ctx->m_pending--;
+	delete job;
+	return 0;
+}
+
+SNM_FileScanner::~SNM_FileScanner()
+{
+	Cancel();
+}
+
+// starts a new scan in background, cancels the current one if any
+void SNM_FileScanner::Start(const char* _initDir, const char* _filterList, bool _subdirs)
+{
+	Cancel();
+	m_cancelled = false;
+	if (_initDir && _filterList)
+	{
+		m_ctx = new Context(_filterList, _subdirs);
+		m_ctx->m_cursor.push_back(std::make_pair(SubmitScanDir(m_ctx, _initDir), (size_t)0));
+	}
+}
+
+// blocks until running directory jobs are aborted, not collected results are lost
+void SNM_FileScanner::Cancel()
+{
+	if (!m_ctx)
+		return;
+
+	m_ctx->m_cancel = true;
+	for (;;)
+	{
+		{
+			SWS_SectionLock lock(&m_ctx->m_mutex);
+			if (!m_ctx->m_pending)
+				break;
 		}
-		while(!ds.Next());
+		Sleep(1);
 	}
+	DELETE_NULL(m_ctx);
+	m_cancelled = true;
+}
+
+bool SNM_FileScanner::IsRunning()
+{
+	if (!m_ctx)
+		return false;
+	SWS_SectionLock lock(&m_ctx->m_mutex);
+	return m_ctx->m_pending > 0;
+}
+
+// true if the last scan got cancelled before completion
+bool SNM_FileScanner::WasCancelled()
+{
+	return m_cancelled;
+}
+
+// moves the files found so far to _files (in directory order), returns the number of moved files
+// note: it is up to the caller to free _files (use WDL_PtrList_DeleteOnDestroy)
+int SNM_FileScanner::GetResults(WDL_PtrList<WDL_String>* _files)
+{
+	if (!m_ctx || !_files)
+		return 0;
+	SWS_SectionLock lock(&m_ctx->m_mutex);
+	int nb = 0;
+	std::vector<std::pair<SNM_ScanNode*,size_t> >& cursor = m_ctx->m_cursor;
+	while (cursor.size() && cursor.back().first->m_done)
+	{
+		SNM_ScanNode* node = cursor.back().first;
+		if (cursor.back().second >= node->m_entries.size())
+		{
+			cursor.pop_back();
+			continue;
+		}
+
+		const std::pair<std::string,SNM_ScanNode*>& entry = node->m_entries[cursor.back().second++];
+		if (entry.second)
+			cursor.push_back(std::make_pair(entry.second, (size_t)0));
+		else
+		{
+			_files->Add(new WDL_String(entry.first.c_str()));
+			nb++;
+		}
+	}
+	return nb;
 }
 
 void StringToExtensionConfig(WDL_FastString* _str, ProjectStateContext* _ctx)
@@ -873,6 +1128,63 @@ double SeekPlay(double _pos, bool _moveView)
 // Action helpers
 ///////////////////////////////////////////////////////////////////////////////
 
+// Registered command ids of a section, rebuilt when the section's action list
+// changes (i.e. new list, new size or new last action)
+class SNM_ActionSectionCache
+{
+public:
+	SNM_ActionSectionCache(KbdSectionInfo* _section)
+		: m_section(_section), m_actions(NULL), m_count(-1), m_lastCmd(0) {}
+
+	KbdSectionInfo* GetSection() { return m_section; }
+
+	void Update()
+	{
+		const int lastCmd = m_section->action_list_cnt>0 ? (int)m_section->action_list[m_section->action_list_cnt-1].cmd : 0;
+		if (m_actions == m_section->action_list && m_count == m_section->action_list_cnt && m_lastCmd == lastCmd)
+			return;
+
+		m_actions = m_section->action_list;
+		m_count = m_section->action_list_cnt;
+		m_lastCmd = lastCmd;
+		m_cmds.clear();
+		m_cmds.reserve(m_count>0 ? m_count : 0);
+		for (int i=0; i<m_count; i++)
+			m_cmds.insert((int)m_section->action_list[i].cmd);
+		m_custIds.clear();
+	}
+
+	bool HasCommand(int _cmdId) { return m_cmds.find(_cmdId) != m_cmds.end(); }
+
+	// NamedCommandLookup() with a cache, only for registered commands
+	int NamedCommandLookup(const char* _custId)
+	{
+		std::unordered_map<std::string,int>::const_iterator it = m_custIds.find(_custId);
+		if (it != m_custIds.end())
+			return it->second;
+		int cmdId = ::NamedCommandLookup(_custId);
+		if (cmdId && HasCommand(cmdId))
+			m_custIds[_custId] = cmdId;
+		return cmdId;
+	}
+
+private:
+	KbdSectionInfo* m_section;
+	const KbdCmd* m_actions;
+	int m_count, m_lastCmd;
+	std::unordered_set<int> m_cmds;
+	std::unordered_map<std::string,int> m_custIds;
+};
+
+static SNM_ActionSectionCache* GetActionSectionCache(KbdSectionInfo* _section)
+{
+	static WDL_PtrList_DOD<SNM_ActionSectionCache> s_caches;
+	for (int i=0; i<s_caches.GetSize(); i++)
+		if (s_caches.Get(i)->GetSection() == _section)
+			return s_caches.Get(i);
+	return s_caches.Add(new SNM_ActionSectionCache(_section));
+}
+
 // "fixes" the API's NamedCommandLookup, e.g. NamedCommandLookup("65534")
 // returns "65534" although this action doesn't exist
 // _hardCheck: if true, do more tests on the returned command id because the 
@@ -887,24 +1199,25 @@ int SNM_NamedCommandLookup(const char* _custId, KbdSectionInfo* _section, bool _
 	int cmdId = 0;
 	if (_custId && *_custId)
 	{
+		KbdSectionInfo* mainSection = SNM_GetActionSection(SNM_SEC_IDX_MAIN);
+		SNM_ActionSectionCache* mainCache = GetActionSectionCache(mainSection);
+		mainCache->Update();
+
 		// NamedCommandLookup() works for all sections (unique command ids accross sections)
 		if (*_custId == '_')
-			cmdId = NamedCommandLookup(_custId);
+			cmdId = mainCache->NamedCommandLookup(_custId);
 		else
 			cmdId = atoi(_custId);
 
 		// make sure things like -666 won't match
 		if (cmdId)
 		{
-			bool found = false;
-			KbdSectionInfo* section = _section ? _section : SNM_GetActionSection(SNM_SEC_IDX_MAIN);
-			for (int i=0; i<section->action_list_cnt; i++) {
-				if (section->action_list[i].cmd == cmdId) {
-					found = true;
-					break;
-				}
+			SNM_ActionSectionCache* cache = mainCache;
+			if (_section && _section != mainSection) {
+				cache = GetActionSectionCache(_section);
+				cache->Update();
 			}
-			if (!found)
+			if (!cache->HasCommand(cmdId))
 				cmdId = 0;
 		}
 	}
@@ -925,32 +1238,151 @@ const char* SNM_GetTextFromCmd(int _cmdId, KbdSectionInfo* _section)
 	return kbd_getTextFromCmd(_cmdId, _section);
 }
 
-bool LoadKbIni(WDL_PtrList<WDL_FastString>* _out)
+// Macros/scripts of reaper-kb.ini, parsed once and indexed by custom id + section.
+// Reloaded only when the file has changed (i.e. new modification time or size).
+class SNM_KbIniRegistry
 {
-	char buf[SNM_MAX_PATH] = "";
-	if (_out && snprintfStrict(buf, sizeof(buf), SNM_KB_INI_FILE, GetResourcePath()) > 0)
+public:
+	struct Action {
+		int m_type; // 1=macro, 2=script, 0=unknown
+		WDL_FastString m_name;
+		WDL_PtrList_DeleteOnDestroy<WDL_FastString> m_cmds;
+	};
+
+	SNM_KbIniRegistry() : m_loaded(false), m_mtime(0), m_size(-1) {}
+
+	bool Load(bool _force)
 	{
-		_out->Empty(true);
-		if (FILE* f = fopenUTF8(buf, "r"))
+		char fn[SNM_MAX_PATH] = "";
+		if (snprintfStrict(fn, sizeof(fn), SNM_KB_INI_FILE, GetResourcePath()) <= 0)
+			return false;
+
+		struct stat s;
+#ifdef _WIN32
+		if (statUTF8(fn, &s))
+#else
+		if (stat(fn, &s))
+#endif
 		{
-			while(fgets(buf, sizeof(buf), f) && *buf)
-				if (!_strnicmp(buf,"ACT",3) || !_strnicmp(buf,"SCR",3))
-					_out->Add(new WDL_FastString(buf));
-			fclose(f);
+			Clear();
+			return false;
+		}
+
+		if (!_force && m_loaded && s.st_mtime == m_mtime && (INT64)s.st_size == m_size)
 			return true;
+
+		FILE* f = fopenUTF8(fn, "r");
+		if (!f)
+		{
+			Clear();
+			return false;
 		}
+
+		Clear();
+		m_loaded = true;
+		m_mtime = s.st_mtime;
+		m_size = (INT64)s.st_size;
+
+		WDL_FastString line;
+		char buf[SNM_MAX_PATH];
+		while (fgets(buf, sizeof(buf), f) && *buf)
+		{
+			line.Append(buf);
+			if (line.GetLength() && line.Get()[line.GetLength()-1] != '\n' && !feof(f))
+				continue; // long line, read the rest
+			AddLine(line.Get());
+			line.Set("");
+		}
+		if (line.GetLength())
+			AddLine(line.Get());
+		fclose(f);
+		return true;
 	}
-	return false;
+
+	const Action* Find(const char* _custId, int _sectionUniqueId)
+	{
+		if (!m_loaded)
+			Load(false);
+		std::string key;
+		MakeKey(_custId, _sectionUniqueId, &key);
+		std::unordered_map<std::string,int>::const_iterator it = m_index.find(key);
+		return it != m_index.end() ? m_actions.Get(it->second) : NULL;
+	}
+
+private:
+	void Clear()
+	{
+		m_loaded = false;
+		m_mtime = 0;
+		m_size = -1;
+		m_index.clear();
+		m_actions.Empty(true);
+	}
+
+	static void MakeKey(const char* _custId, int _sectionUniqueId, std::string* _key)
+	{
+		char sec[32];
+		snprintf(sec, sizeof(sec), "%d:", _sectionUniqueId);
+		_key->assign(sec);
+		for (const char* p = _custId; *p; p++)
+			_key->push_back((char)tolower((unsigned char)*p));
+	}
+
+	void AddLine(const char* _line)
+	{
+		if (_strnicmp(_line,"ACT",3) && _strnicmp(_line,"SCR",3))
+			return;
+
+		LineParser lp(false);
+		if (lp.parse(_line) || lp.getnumtokens()<5)
+			return;
+
+		int success, iniSecId = lp.gettoken_int(2, &success);
+		if (!success)
+			return;
+
+		std::string key;
+		MakeKey(lp.gettoken_str(3), iniSecId, &key);
+		if (m_index.find(key) != m_index.end())
+			return; // first definition wins
+
+		Action* a = new Action;
+		a->m_type = !_stricmp(lp.gettoken_str(0), "ACT") ? 1 : !_stricmp(lp.gettoken_str(0), "SCR") ? 2 : 0;
+		a->m_name.Set(lp.gettoken_str(4));
+		for (int i=5; i<lp.getnumtokens(); i++)
+		{
+			WDL_FastString* cmd = a->m_cmds.Add(new WDL_FastString);
+			const char* p = FindFirstRN(lp.gettoken_str(i)); // there are some "\r\n" sometimes
+			cmd->Set(lp.gettoken_str(i), p ? (int)(p-lp.gettoken_str(i)) : 0);
+		}
+		m_index[key] = m_actions.GetSize();
+		m_actions.Add(a);
+	}
+
+	bool m_loaded;
+	time_t m_mtime;
+	INT64 m_size;
+	WDL_PtrList_DOD<Action> m_actions;
+	std::unordered_map<std::string,int> m_index;
+};
+
+static SNM_KbIniRegistry g_kbIni;
+
+// (re)loads macros/scripts of reaper-kb.ini if the file has changed since the last call
+// returns false if the file cannot be read
+bool LoadKbIni(bool _forceReload)
+{
+	return g_kbIni.Load(_forceReload);
 }
 
 // returns 1 for a macro, 2 for a script, 0 if not found
 // _custId: custom id (both formats are allowed: "bla" and "_bla")
-// _inMacroScripts: to optimize accesses to reaper-kb.ini, required
 // _outCmds: optionnal, if any it is up to the caller to unalloc items
-// note: no cache here (the user can create new macros...)
-int GetMacroOrScript(const char* _custId, int _sectionUniqueId, WDL_PtrList<WDL_FastString>* _inMacroScripts, WDL_PtrList<WDL_FastString>* _outCmds, WDL_FastString* _outName)
+// note: lookups use the reaper-kb.ini registry as loaded by the last LoadKbIni()
+//       call (the user can create new macros, so callers refresh it when needed)
+int GetMacroOrScript(const char* _custId, int _sectionUniqueId, WDL_PtrList<WDL_FastString>* _outCmds, WDL_FastString* _outName)
 {
-	if (!_custId || !_inMacroScripts)
+	if (!_custId)
 		return 0;
 
 	if (*_custId == '_')
@@ -959,41 +1391,16 @@ int GetMacroOrScript(const char* _custId, int _sectionUniqueId, WDL_PtrList<WDL_
 	if (_outCmds)
 		_outCmds->Empty(true);
 
-	int found = 0;
-	for (int i=0; i<_inMacroScripts->GetSize(); i++)
-	{
-		if (const char* cmd = _inMacroScripts->Get(i) ? _inMacroScripts->Get(i)->Get() : "")
-		{
-			LineParser lp(false);
-			if (!lp.parse(cmd) && 
-				lp.getnumtokens()>=5 &&
-				!_stricmp(lp.gettoken_str(3), _custId))
-			{
-				int success, iniSecId = lp.gettoken_int(2, &success);
-				if (success && iniSecId==_sectionUniqueId)
-				{
-					found = !_stricmp(lp.gettoken_str(0), "ACT") ? 1 : !_stricmp(lp.gettoken_str(0), "SCR") ? 2 : 0;
-					if (found)
-					{
-						if (_outName)
-							_outName->Set(lp.gettoken_str(4));
-						if (_outCmds)
-						{
-							for (int i=5; i<lp.getnumtokens(); i++)
-							{
-								WDL_FastString* cmd = new WDL_FastString;
-								const char* p = FindFirstRN(lp.gettoken_str(i)); // there are some "\r\n" sometimes
-								cmd->Set(lp.gettoken_str(i), p ? (int)(p-lp.gettoken_str(i)) : 0);
-								_outCmds->Add(cmd);
-							}
-						}
-					}
-					break;
-				}
-			}
-		}
-	}
-	return found;
+	const SNM_KbIniRegistry::Action* a = g_kbIni.Find(_custId, _sectionUniqueId);
+	if (!a || !a->m_type)
+		return 0;
+
+	if (_outName)
+		_outName->Set(a->m_name.Get());
+	if (_outCmds)
+		for (int i=0; i<a->m_cmds.GetSize(); i++)
+			_outCmds->Add(new WDL_FastString(a->m_cmds.Get(i)->Get()));
+	return a->m_type;
 }
 
 // test if an action name or a custom id is a macro/script one
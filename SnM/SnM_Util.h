@@ -59,6 +59,24 @@ WDL_HeapBuf* TranscodeStr64ToHeapBuf(const char* _str64);
 bool GenerateFilename(const char* _dir, const char* _name, const char* _ext, char* _updatedFn, int _updatedSz);
 void ScanFiles(WDL_PtrList<WDL_String>* _files, const char* _initDir, const char* _filterList, bool _subdirs);
 bool IsDirNoRecurse(const WDL_DirScan &);
+
+// scans files in background (see ScanFiles()), results can be collected while scanning
+class SNM_FileScanner
+{
+public:
+	struct Context;
+	SNM_FileScanner() : m_ctx(NULL), m_cancelled(false) {}
+	~SNM_FileScanner();
+	void Start(const char* _initDir, const char* _filterList, bool _subdirs);
+	void Cancel();
+	bool IsRunning();
+	bool WasCancelled();
+	int GetResults(WDL_PtrList<WDL_String>* _files);
+private:
+	Context* m_ctx;
+	bool m_cancelled;
+};
+
 void StringToExtensionConfig(WDL_FastString* _str, ProjectStateContext* _ctx);
 void ExtensionConfigToString(WDL_FastString* _str, ProjectStateContext* _ctx);
 
@@ -81,8 +99,8 @@ double SeekPlay(double _pos, bool _moveView = false);
 
 int SNM_NamedCommandLookup(const char* _custId, KbdSectionInfo* _section = NULL, bool _hardCheck = false);
 const char* SNM_GetTextFromCmd(int _cmdId, KbdSectionInfo* _section);
-bool LoadKbIni(WDL_PtrList<WDL_FastString>* _out);
-int GetMacroOrScript(const char* _customId, int _sectionUniqueId, WDL_PtrList<WDL_FastString>* _inMacroScripts, WDL_PtrList<WDL_FastString>* _outCmds, WDL_FastString* _outName = NULL);
+bool LoadKbIni(bool _forceReload = false);
+int GetMacroOrScript(const char* _customId, int _sectionUniqueId, WDL_PtrList<WDL_FastString>* _outCmds, WDL_FastString* _outName = NULL);
 enum class ActionType { Unknown, Custom, ReaScript };
 ActionType GetActionType(const char* _cmd, bool _cmdIsName = true);
 bool IsMacroOrScript(const char* _cmd, bool _cmdIsName = true);
@@ -35,6 +35,9 @@
 #include <WDL/projectcontext.h>
 #include <WDL/localize/localize.h>
 
+#include <unordered_map>
+#include <unordered_set>
+
 FXSnapshot::FXSnapshot(MediaTrack* tr, int fx)
 {
 	m_iCurParam = 0;
@@ -287,53 +290,60 @@ TrackSnapshot::~TrackSnapshot()
 	m_fx.Empty(true);
 }
 
-// Returns true if cannot find the track to update!
-bool TrackSnapshot::UpdateReaper(int mask, bool bSelOnly, int* fxErr, bool wantChunk, WDL_PtrList<TrackSendFix>* pFix)
+// Set a track attribute only if it differs from the current value
+template <typename T> static void SetTrackInfoIfChanged(MediaTrack* tr, const char* parm, T* val)
 {
-	MediaTrack* tr = GuidToTrack(&m_guid);
-	if (!tr)
-		return true;
+	const T* cur = (const T*)GetSetMediaTrackInfo(tr, parm, NULL);
+	if (!cur || *cur != *val)
+		GetSetMediaTrackInfo(tr, parm, val);
+}
 
-	int iSel = *(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL);
-	if (bSelOnly && !iSel)
-		return false; // Ignore if the track isn't selected
+static void SetTrackValueIfChanged(MediaTrack* tr, const char* parm, double val)
+{
+	if (GetMediaTrackInfo_Value(tr, parm) != val)
+		SetMediaTrackInfo_Value(tr, parm, val);
+}
 
+// tr: the track matching m_guid, see Snapshot::UpdateReaper()
+// wantChunk: false for track attributes & envelopes, true for chunk based stuff (FX chain, sends)
+void TrackSnapshot::UpdateReaper(MediaTrack* tr, int mask, int* fxErr, bool wantChunk, WDL_PtrList<TrackSendFix>* pFix)
+{
 	PreventUIRefresh(1);
 
-	if (mask & VOL_MASK)
+	if (mask & VOL_MASK && !wantChunk)
 	{
-		GetSetMediaTrackInfo(tr, "D_VOL", &m_dVol);
+		SetTrackInfoIfChanged(tr, "D_VOL", &m_dVol);
 		GetSetEnvelope(tr, &m_sVolEnv, "Volume (Pre-FX)", true);
 		GetSetEnvelope(tr, &m_sVolEnv2, "Volume", true);
 	}
-	if (mask & PAN_MASK)
+	if (mask & PAN_MASK && !wantChunk)
 	{
-		GetSetMediaTrackInfo(tr, "D_PAN", &m_dPan);
-		GetSetMediaTrackInfo(tr, "I_PANMODE", &m_iPanMode);
-		GetSetMediaTrackInfo(tr, "D_WIDTH", &m_dPanWidth);
-		GetSetMediaTrackInfo(tr, "D_DUALPANL", &m_dPanL);
-		GetSetMediaTrackInfo(tr, "D_DUALPANR", &m_dPanR);
+		SetTrackInfoIfChanged(tr, "D_PAN", &m_dPan);
+		SetTrackInfoIfChanged(tr, "I_PANMODE", &m_iPanMode);
+		SetTrackInfoIfChanged(tr, "D_WIDTH", &m_dPanWidth);
+		SetTrackInfoIfChanged(tr, "D_DUALPANL", &m_dPanL);
+		SetTrackInfoIfChanged(tr, "D_DUALPANR", &m_dPanR);
 		if (m_dPanLaw != -100.0)
-			GetSetMediaTrackInfo(tr, "D_PANLAW", &m_dPanLaw);
+			SetTrackInfoIfChanged(tr, "D_PANLAW", &m_dPanLaw);
 		GetSetEnvelope(tr, &m_sPanEnv, "Pan (Pre-FX)", true);
 		GetSetEnvelope(tr, &m_sPanEnv2, "Pan", true);
 		GetSetEnvelope(tr, &m_sWidthEnv, "Width (Pre-FX)", true);
 		GetSetEnvelope(tr, &m_sWidthEnv2, "Width", true);
 	}
-	if (mask & MUTE_MASK)
+	if (mask & MUTE_MASK && !wantChunk)
 	{
-		GetSetMediaTrackInfo(tr, "B_MUTE", &m_bMute);
+		SetTrackInfoIfChanged(tr, "B_MUTE", &m_bMute);
 		GetSetEnvelope(tr, &m_sMuteEnv, "Mute", true);
 	}
-	if (mask & SOLO_MASK)
-		GetSetMediaTrackInfo(tr, "I_SOLO", &m_iSolo);
-	if (mask & VIS_MASK)
+	if (mask & SOLO_MASK && !wantChunk)
+		SetTrackInfoIfChanged(tr, "I_SOLO", &m_iSolo);
+	if (mask & VIS_MASK && !wantChunk && GetTrackVis(tr) != m_iVis)
 		SetTrackVis(tr, m_iVis); // ignores master
-	if (mask & SEL_MASK)
-		GetSetMediaTrackInfo(tr, "I_SELECTED", &m_iSel);
-	if (mask & FXATM_MASK) // DEPRECATED, keep for previously saved snapshots
+	if (mask & SEL_MASK && !wantChunk)
+		SetTrackInfoIfChanged(tr, "I_SELECTED", &m_iSel);
+	if (mask & FXATM_MASK && !wantChunk) // DEPRECATED, keep for previously saved snapshots
 	{
-		GetSetMediaTrackInfo(tr, "I_FXEN", &m_iFXEn);
+		SetTrackInfoIfChanged(tr, "I_FXEN", &m_iFXEn);
 		int numFX = TrackFX_GetCount(tr);
 		if (numFX)
 		{
@@ -354,26 +364,24 @@ bool TrackSnapshot::UpdateReaper(int mask, bool bSelOnly, int* fxErr, bool wantC
 	}
 	if (mask & FXCHAIN_MASK)
 	{
-		GetSetMediaTrackInfo(tr, "I_FXEN", &m_iFXEn);
 		if (wantChunk) SetFXChain(tr, m_sFXChain.Get());
+		else SetTrackInfoIfChanged(tr, "I_FXEN", &m_iFXEn);
 	}
 	if (mask & SENDS_MASK)
 	{
 		if (wantChunk) m_sends.UpdateReaper(tr, pFix);
 	}
-	if (mask & PHASE_MASK)
+	if (mask & PHASE_MASK && !wantChunk)
 	{
-		GetSetMediaTrackInfo(tr, "B_PHASE", &m_bPhase);
+		SetTrackInfoIfChanged(tr, "B_PHASE", &m_bPhase);
 	}
-	if (mask & PLAY_OFFSET_MASK)
+	if (mask & PLAY_OFFSET_MASK && !wantChunk)
 	{
-		SetMediaTrackInfo_Value(tr, "I_PLAY_OFFSET_FLAG", m_iPlayOffsetFlag);
-		SetMediaTrackInfo_Value(tr, "D_PLAY_OFFSET", m_dPlayOffset);
+		SetTrackValueIfChanged(tr, "I_PLAY_OFFSET_FLAG", m_iPlayOffsetFlag);
+		SetTrackValueIfChanged(tr, "D_PLAY_OFFSET", m_dPlayOffset);
 	}
 
 	PreventUIRefresh(-1);
-
-	return false;
 }
 
 bool TrackSnapshot::Cleanup()
@@ -678,7 +686,13 @@ void TrackSnapshot::GetSetEnvelope(MediaTrack* tr, WDL_FastString* str, const ch
 	else if (str->GetLength())
 	{	// Set envelope
 		if (te)
-			GetSetEnvelopeState(te, (char*)str->Get(), 0);
+		{
+			// Skip identical envelopes, getting a state is much cheaper than setting it.
+			// One extra char so that longer current states can't match once truncated
+			WDL_TypedBuf<char> cur;
+			if (!cur.Resize(str->GetLength()+2, false) || !GetSetEnvelopeState(te, cur.Get(), cur.GetSize()) || strcmp(cur.Get(), str->Get()))
+				GetSetEnvelopeState(te, (char*)str->Get(), 0);
+		}
 		else
 		{
 			WDL_FastString state;
@@ -891,50 +905,96 @@ void DeleteTracksFromSnapshotOnError(WDL_PtrList<TrackSnapshot>& m_tracks)
 	}
 }
 
+// Recall pipeline: plan (resolve tracks), apply track attributes & envelopes, then
+// chunk based stuff through the object state cache, and finally hide new tracks
 bool Snapshot::UpdateReaper(int mask, bool bSelOnly, bool bHideNewVis)
 {
 	char str[256];
 	int trackErr = 0, fxErr = 0;
 	WDL_PtrList<TrackSendFix> sendFixes;
+	mask &= m_iMask;
+#ifdef _SWS_DEBUG
+	double dTimes[5];
+	dTimes[0] = time_precise();
+#endif
+
+	// Plan: resolve all snapshot tracks in one pass
+	std::unordered_map<GUID, MediaTrack*, GuidHash, GuidEqual> tracksByGuid;
+	tracksByGuid.reserve(GetNumTracks()+1);
+	for (int i = 0; i <= GetNumTracks(); i++)
+	{
+		MediaTrack* tr = CSurf_TrackFromID(i, false);
+		tracksByGuid.emplace(i ? *(GUID*)GetSetMediaTrackInfo(tr, "GUID", NULL) : GUID_NULL, tr); // 1st one wins, as with GuidToTrack()
+	}
+
+	std::vector<std::pair<TrackSnapshot*, MediaTrack*> > plan;
+	std::unordered_set<MediaTrack*> inSnapshot;
+	plan.reserve(m_tracks.GetSize());
+	for (int i = 0; i < m_tracks.GetSize(); i++)
+	{
+		TrackSnapshot* ts = m_tracks.Get(i);
+		auto it = tracksByGuid.find(ts->m_guid);
+		if (it == tracksByGuid.end())
+		{
+			trackErr++;
+			continue;
+		}
+		inSnapshot.insert(it->second);
+		if (bSelOnly && !*(int*)GetSetMediaTrackInfo(it->second, "I_SELECTED", NULL))
+			continue; // Ignore if the track isn't selected
+		plan.push_back(std::make_pair(ts, it->second));
+	}
+#ifdef _SWS_DEBUG
+	dTimes[1] = time_precise();
+#endif
 
 	PreventUIRefresh(1);
 
 	// Do "non-chunk" stuff first
-	for (int i = 0; i < m_tracks.GetSize(); i++)
-		m_tracks.Get(i)->UpdateReaper(mask & m_iMask, bSelOnly, &fxErr, false, &sendFixes);
+	for (size_t i = 0; i < plan.size(); i++)
+		plan[i].first->UpdateReaper(plan[i].second, mask, &fxErr, false, &sendFixes);
+#ifdef _SWS_DEBUG
+	dTimes[2] = time_precise();
+#endif
 
 	// Then cache all ObjectState changes for the chunk updating
-	SWS_CacheObjectState(true);
-	for (int i = 0; i < m_tracks.GetSize(); i++)
-		if (m_tracks.Get(i)->UpdateReaper(mask & m_iMask, bSelOnly, &fxErr, true, &sendFixes))
-			trackErr++;
-	SWS_CacheObjectState(false);
+	if (mask & (FXCHAIN_MASK | SENDS_MASK))
+	{
+		SWS_CacheObjectState(true);
+		for (size_t i = 0; i < plan.size(); i++)
+			plan[i].first->UpdateReaper(plan[i].second, mask, &fxErr, true, &sendFixes);
+		SWS_CacheObjectState(false);
+	}
+#ifdef _SWS_DEBUG
+	dTimes[3] = time_precise();
+#endif
 
-	if (mask & m_iMask & VIS_MASK)
+	if (mask & VIS_MASK)
 	{
 		if (!bSelOnly && bHideNewVis && GetNumTracks() > 1)
 		{
 			// Find tracks that aren't in the snapshot, and hide them
 			// TODO - what type of hide??
-			bool* bInSnapshot = new bool[GetNumTracks()];
-			memset(bInSnapshot, 0, GetNumTracks() * sizeof(bool));
-			for (int i = 0; i < m_tracks.GetSize(); i++)
+			for (int i = 1; i <= GetNumTracks(); i++)
 			{
-				int iTrack = CSurf_TrackToID(GuidToTrack(&m_tracks.Get(i)->m_guid), false);
-				if (iTrack >= 1)
-					bInSnapshot[iTrack-1] = true;
+				MediaTrack* tr = CSurf_TrackFromID(i, false);
+				if (!inSnapshot.count(tr) && GetTrackVis(tr))
+					SetTrackVis(tr, 0);
 			}
-			for (int i = 0; i < GetNumTracks(); i++)
-			{
-				if (!bInSnapshot[i])
-					SetTrackVis(CSurf_TrackFromID(i+1, false), 0);
-			}
-			delete [] bInSnapshot;
 		}
 
 		// Must manually redraw visibiliy changes, maybe others??
 		TrackList_AdjustWindows(false);
 	}
+#ifdef _SWS_DEBUG
+	dTimes[4] = time_precise();
+	WDL_FastString dbg;
+	SWS_GetObjectStateCacheStats(&dbg, true);
+	snprintf(str, sizeof(str), "Snapshot recall: %d/%d track(s) - plan: %.1f ms, tracks: %.1f ms, chunks: %.1f ms, visibility: %.1f ms\n",
+		(int)plan.size(), m_tracks.GetSize(), (dTimes[1]-dTimes[0])*1000.0, (dTimes[2]-dTimes[1])*1000.0, (dTimes[3]-dTimes[2])*1000.0, (dTimes[4]-dTimes[3])*1000.0);
+	OutputDebugString(str);
+	OutputDebugString(dbg.Get());
+#endif
 
 	PreventUIRefresh(-1);
 
@@ -57,7 +57,7 @@ public:
     TrackSnapshot(LineParser* lp);
     ~TrackSnapshot();
 
-	bool UpdateReaper(int mask, bool bSelOnly, int* fxErr, bool wantChunk, WDL_PtrList<TrackSendFix>* pFix);
+	void UpdateReaper(MediaTrack* tr, int mask, int* fxErr, bool wantChunk, WDL_PtrList<TrackSendFix>* pFix);
 	bool Cleanup();
 	void GetChunk(WDL_FastString* chunk);
 	void GetDetails(WDL_FastString* details, int iMask);
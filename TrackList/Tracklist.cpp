@@ -39,6 +39,7 @@
 
 #define RENAME_MSG		0x10005
 #define LOADSNAP_MSG	0x10100 // Keep space afterwards
+#define FILTER_DELAY	150		// ms, filter changes are applied when typing pauses
 
 #define MAJORADJUST false
 	
@@ -199,7 +200,7 @@ int SWS_TrackListView::GetItemState(SWS_ListItem* item)
 }
 
 SWS_TrackListWnd::SWS_TrackListWnd()
-:SWS_DockWnd(IDD_TRACKLIST, __LOCALIZE("Track List","sws_DLG_108"), "SWSTrackList"),m_bUpdate(false),
+:SWS_DockWnd(IDD_TRACKLIST, __LOCALIZE("Track List","sws_DLG_108"), "SWSTrackList"),m_bUpdate(false),m_dwFilterTime(0),
 m_trLastTouched(NULL),m_bHideFiltered(false),m_bLink(false),m_cOptionsKey("Track List Options")
 {
 	// Restore state
@@ -279,7 +280,8 @@ void SWS_TrackListWnd::OnCommand(WPARAM wParam, LPARAM lParam)
 			char curFilter[256];
 			GetWindowText(GetDlgItem(m_hwnd, IDC_FILTER), curFilter, 256);
 			m_filter.Get()->SetFilter(curFilter);
-			Update();
+			m_dwFilterTime = GetTickCount();
+			ScheduleUpdate();
 			break;
 		}
 		case IDC_HIDE:
@@ -373,7 +375,7 @@ void SWS_TrackListWnd::OnDestroy()
 
 void SWS_TrackListWnd::OnTimer(WPARAM wParam)
 {
-	if (m_bUpdate)
+	if (m_bUpdate && GetTickCount() - m_dwFilterTime >= FILTER_DELAY)
 	{
 		Update();
 		m_bUpdate = false;
@@ -500,10 +502,14 @@ int SWS_TrackListWnd::OnKey(MSG* msg, int iKeyState)
 	return 0;
 }
 
-void ScheduleTracklistUpdate()
+void ScheduleTracklistUpdate(bool bNamesChanged)
 {
 	if (g_pList)
+	{
+		if (bNamesChanged)
+			g_pList->GetFilter()->Get()->InvalidateNames();
 		g_pList->ScheduleUpdate();
+	}
 }
 
 void OpenTrackList(COMMAND_T*)
@@ -70,6 +70,7 @@ protected:
 
 private:
 	bool m_bUpdate;
+	DWORD m_dwFilterTime;
 	SWSProjConfig<FilteredVisState> m_filter;
 	bool m_bHideFiltered;
 	bool m_bLink;
@@ -78,4 +79,4 @@ private:
 
 int TrackListInit();
 void TrackListExit();
-void ScheduleTracklistUpdate();
+void ScheduleTracklistUpdate(bool bNamesChanged = false);
@@ -29,6 +29,8 @@
 #include "stdafx.h"
 #include "TracklistFilter.h"
 
+#include <unordered_map>
+
 // TODO UTF8 support here
 void FilteredVisState::SetFilter(const char* cFilter)
 {
@@ -41,6 +43,7 @@ void FilteredVisState::SetFilter(const char* cFilter)
 	for (int i = 0; i < sLCFilter.GetLength(); i++)
 		sLCFilter.Get()[i] = tolower(sLCFilter.Get()[i]);
 	m_parsedFilter->parse(sLCFilter.Get());
+	m_bMatchesDirty = true;
 }
 
 void FilteredVisState::Init(LineParser* lp)
@@ -52,6 +55,8 @@ void FilteredVisState::Init(LineParser* lp)
 	tvs->iVis = lp->gettoken_int(1);
 	if (tvs->tr)
 		m_filteredOut.Add(tvs);
+	else
+		delete tvs;
 }
 
 char* FilteredVisState::ItemString(char* str, int maxLen, bool* bDone)
@@ -86,49 +91,62 @@ char* FilteredVisState::ItemString(char* str, int maxLen, bool* bDone)
 
 WDL_PtrList<void>* FilteredVisState::GetFilteredTracks()
 {
-	static WDL_PtrList<void> tracks;
-	tracks.Empty();
-	
-	for (int i = 1; i <= GetNumTracks(); i++)
-	{
-		MediaTrack* tr = CSurf_TrackFromID(i, false);
-		if (MatchesFilter(tr))
-			tracks.Add(tr);
-	}
-	return &tracks;
+	UpdateMatches();
+	return &m_matches;
+}
+
+// Get/SetTrackVis() without their CSurf_TrackToID() lookup, for tracks (not master) only
+static int GetVis(MediaTrack* tr)
+{
+	int iVis = *(bool*)GetSetMediaTrackInfo(tr, "B_SHOWINMIXER", NULL) ? 1 : 0;
+	iVis    |= *(bool*)GetSetMediaTrackInfo(tr, "B_SHOWINTCP", NULL) ? 2 : 0;
+	return iVis;
+}
+
+static void SetVis(MediaTrack* tr, int iVis)
+{
+	GetSetMediaTrackInfo(tr, "B_SHOWINTCP",   iVis & 2 ? &g_bTrue : &g_bFalse);
+	GetSetMediaTrackInfo(tr, "B_SHOWINMIXER", iVis & 1 ? &g_bTrue : &g_bFalse);
 }
 
 bool FilteredVisState::UpdateReaper(bool bHideFiltered)
 {
 	bool bChanged = false;
+	UpdateMatches();
 
-	// Remove tracks from filteredOut that aren't in the project
+	// Index filteredOut, whatever is left in there after the loop below isn't in the project anymore
+	std::unordered_map<MediaTrack*, TrackVisState*> filteredOut;
 	for (int i = 0; i < m_filteredOut.GetSize(); i++)
-		if (CSurf_TrackToID(m_filteredOut.Get(i)->tr, false) <= 0)
-			m_filteredOut.Delete(i--, true);
+	{
+		TrackVisState*& tvs = filteredOut[m_filteredOut.Get(i)->tr];
+		delete tvs; // Duplicate
+		tvs = m_filteredOut.Get(i);
+	}
+	m_filteredOut.Empty(false);
 
-	for (int i = 1; i <= GetNumTracks(); i++)
+	for (int i = 0; i < m_names.GetSize(); i++)
 	{
-		MediaTrack* tr = CSurf_TrackFromID(i, false);
-		int iVis = GetTrackVis(tr);
+		MediaTrack* tr = m_names.Get(i)->tr;
+		int iVis = GetVis(tr);
 		int iNewVis = iVis;
-		bool bShow = !bHideFiltered || MatchesFilter(tr);
+		bool bShow = !bHideFiltered || m_bMatch[i];
 
 		// Is this track in the filteredOut list?
-		int j;
-		for (j = 0; j < m_filteredOut.GetSize(); j++)
-			if (m_filteredOut.Get(j)->tr == tr)
-				break;
-		
-		if (j < m_filteredOut.GetSize())
+		std::unordered_map<MediaTrack*, TrackVisState*>::iterator it = filteredOut.find(tr);
+		if (it != filteredOut.end())
 		{
+			TrackVisState* tvs = it->second;
+			filteredOut.erase(it);
 			if (bShow)
 			{
-				iNewVis = m_filteredOut.Get(j)->iVis;
-				m_filteredOut.Delete(j, true);
+				iNewVis = tvs->iVis;
+				delete tvs;
 			}
 			else
+			{
 				iNewVis = 0;
+				m_filteredOut.Add(tvs);
+			}
 		}
 		else if (!bShow)
 		{
@@ -140,13 +158,20 @@ bool FilteredVisState::UpdateReaper(bool bHideFiltered)
 
 		if (iVis != iNewVis)
 		{
-			SetTrackVis(tr, iNewVis);
+			// All visibility changes are applied at once
+			if (!bChanged)
+				PreventUIRefresh(1);
+			SetVis(tr, iNewVis);
 			bChanged = true;
 		}
 	}
 
+	for (std::unordered_map<MediaTrack*, TrackVisState*>::iterator it = filteredOut.begin(); it != filteredOut.end(); ++it)
+		delete it->second;
+
 	if (bChanged)
 	{
+		PreventUIRefresh(-1);
 		TrackList_AdjustWindows(false);
 		UpdateTimeline();
 	}
@@ -154,18 +179,79 @@ bool FilteredVisState::UpdateReaper(bool bHideFiltered)
 	return bChanged;
 }
 
-bool FilteredVisState::MatchesFilter(MediaTrack* tr)
+// Returns true if the name index has been rebuilt
+bool FilteredVisState::UpdateNameIndex()
+{
+	const int iTracks = GetNumTracks();
+	bool bValid = !m_bNamesDirty && m_names.GetSize() == iTracks;
+	for (int i = 0; bValid && i < iTracks; i++)
+		bValid = m_names.Get(i)->tr == CSurf_TrackFromID(i + 1, false);
+	if (bValid)
+		return false;
+
+	m_names.Empty(true);
+	for (int i = 1; i <= iTracks; i++)
+	{
+		TrackName* tn = m_names.Add(new TrackName);
+		tn->tr = CSurf_TrackFromID(i, false);
+		tn->sLCName.Set((char*)GetSetMediaTrackInfo(tn->tr, "P_NAME", NULL));
+		for (int j = 0; j < tn->sLCName.GetLength(); j++)
+			tn->sLCName.Get()[j] = tolower(tn->sLCName.Get()[j]);
+	}
+	m_bMatch.assign(iTracks, 0);
+	m_bNamesDirty = false;
+	return true;
+}
+
+// A track matching the current filter matches the previous one too, i.e. every
+// token contains a previous token (ex: "vi" -> "vio"), so only the previous
+// matches need to be checked
+bool FilteredVisState::IsNarrowing()
+{
+	if (!m_matchedTokens.size())
+		return true;
+	for (int i = 0; i < m_parsedFilter->getnumtokens(); i++)
+	{
+		bool bFound = false;
+		for (size_t j = 0; !bFound && j < m_matchedTokens.size(); j++)
+			bFound = strstr(m_parsedFilter->gettoken_str(i), m_matchedTokens[j].c_str()) != NULL;
+		if (!bFound)
+			return false;
+	}
+	return m_parsedFilter->getnumtokens() > 0;
+}
+
+void FilteredVisState::UpdateMatches()
+{
+	const bool bRebuilt = UpdateNameIndex();
+	if (!bRebuilt && !m_bMatchesDirty)
+		return;
+
+	const bool bNarrow = !bRebuilt && IsNarrowing();
+	m_matches.Empty();
+	for (int i = 0; i < m_names.GetSize(); i++)
+	{
+		if (bNarrow && !m_bMatch[i])
+			continue;
+		m_bMatch[i] = MatchesFilter(m_names.Get(i)->sLCName.Get());
+		if (m_bMatch[i])
+			m_matches.Add(m_names.Get(i)->tr);
+	}
+
+	m_matchedTokens.clear();
+	for (int i = 0; i < m_parsedFilter->getnumtokens(); i++)
+		m_matchedTokens.push_back(m_parsedFilter->gettoken_str(i));
+	m_bMatchesDirty = false;
+}
+
+bool FilteredVisState::MatchesFilter(const char* cLCName)
 {
-	static WDL_String sTrackName;
 	if (!m_parsedFilter->getnumtokens())
 		return true;
-	sTrackName.Set((char*)GetSetMediaTrackInfo(tr, "P_NAME", NULL));
-	if (!sTrackName.GetLength())
+	if (!cLCName[0])
 		return false;
-	for (int i = 0; i < sTrackName.GetLength(); i++)
-		sTrackName.Get()[i] = tolower(sTrackName.Get()[i]);
 	for (int j = 0; j < m_parsedFilter->getnumtokens(); j++)
-		if (strstr(sTrackName.Get(), m_parsedFilter->gettoken_str(j)))
+		if (strstr(cLCName, m_parsedFilter->gettoken_str(j)))
 			return true;
 	return false;
 }
@@ -37,18 +37,35 @@ typedef struct TrackVisState
 class FilteredVisState
 {
 public:
-	FilteredVisState() { m_parsedFilter = new LineParser(false); }
-	~FilteredVisState() { m_filteredOut.Empty(true); delete m_parsedFilter; }
+	FilteredVisState() : m_bNamesDirty(true), m_bMatchesDirty(true) { m_parsedFilter = new LineParser(false); }
+	~FilteredVisState() { m_filteredOut.Empty(true); m_names.Empty(true); delete m_parsedFilter; }
 	void SetFilter(const char* cFilter);
 	const char* GetFilter() { return m_sFilter.Get(); }
 	void Init(LineParser* lp);
 	char* ItemString(char* str, int maxLen, bool* bDone);
 	WDL_PtrList<void>* GetFilteredTracks();
 	bool UpdateReaper(bool bHideFiltered);
+	void InvalidateNames() { m_bNamesDirty = true; } // Track names changed
 
 private:
-	bool MatchesFilter(MediaTrack* tr);
+	typedef struct TrackName
+	{
+		MediaTrack* tr;
+		WDL_String sLCName;
+	} TrackName;
+
+	bool UpdateNameIndex();
+	void UpdateMatches();
+	bool IsNarrowing();
+	bool MatchesFilter(const char* cLCName);
 	WDL_String m_sFilter;
 	LineParser* m_parsedFilter;
 	WDL_PtrList<TrackVisState> m_filteredOut;
+
+	// Lowercase track names (in track order) and the tracks matching m_matchedTokens
+	WDL_PtrList<TrackName> m_names;
+	std::vector<char> m_bMatch;         // One per m_names item
+	std::vector<std::string> m_matchedTokens;
+	WDL_PtrList<void> m_matches;
+	bool m_bNamesDirty, m_bMatchesDirty;
 };
@@ -0,0 +1,171 @@
+/******************************************************************************
+/ ThreadPool.cpp
+/
+/ Copyright (c) 2026 reaper-oss
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#include "stdafx.h"
+
+#include "ThreadPool.h"
+
+#ifndef _WIN32
+#  include <unistd.h>
+#endif
+
+SWS_ThreadPool::SWS_ThreadPool (int maxThreads /*=0*/) :
+m_maxThreads (maxThreads > 0 ? maxThreads : GetCPUCount()),
+m_workers    (0),
+m_lastId     (0)
+{
+}
+
+SWS_ThreadPool::~SWS_ThreadPool ()
+{
+	{
+		SWS_SectionLock lock(&m_mutex);
+		m_queue.clear();
+	}
+
+	// Let running jobs finish, workers exit on their own once the queue is empty
+	for (;;)
+	{
+		{
+			SWS_SectionLock lock(&m_mutex);
+			if (!m_workers)
+				break;
+		}
+		Sleep(1);
+	}
+}
+
+int SWS_ThreadPool::Submit (JobProc proc, void* param)
+{
+	SWS_SectionLock lock(&m_mutex);
+
+	Job job = {++m_lastId, proc, param};
+	m_queue.push_back(job);
+
+	if (m_workers < m_maxThreads)
+	{
+		if (HANDLE thread = (HANDLE)_beginthreadex(NULL, 0, Worker, (void*)this, 0, NULL))
+		{
+			++m_workers;
+			CloseHandle(thread);
+		}
+	}
+
+	return job.id;
+}
+
+bool SWS_ThreadPool::Cancel (int jobId)
+{
+	SWS_SectionLock lock(&m_mutex);
+	for (std::list<Job>::iterator it = m_queue.begin(); it != m_queue.end(); ++it)
+	{
+		if (it->id == jobId)
+		{
+			m_queue.erase(it);
+			return true;
+		}
+	}
+	return false;
+}
+
+void SWS_ThreadPool::Wait (int jobId)
+{
+	while (this->IsPending(jobId))
+		Sleep(1);
+}
+
+bool SWS_ThreadPool::IsPending (int jobId)
+{
+	SWS_SectionLock lock(&m_mutex);
+	if (m_running.count(jobId))
+		return true;
+
+	for (std::list<Job>::iterator it = m_queue.begin(); it != m_queue.end(); ++it)
+	{
+		if (it->id == jobId)
+			return true;
+	}
+	return false;
+}
+
+int SWS_ThreadPool::CountPending ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	return (int)(m_queue.size() + m_running.size());
+}
+
+void SWS_ThreadPool::SetMaxThreads (int maxThreads)
+{
+	SWS_SectionLock lock(&m_mutex);
+	m_maxThreads = (maxThreads > 0) ? maxThreads : GetCPUCount();
+}
+
+int SWS_ThreadPool::GetMaxThreads ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	return m_maxThreads;
+}
+
+int SWS_ThreadPool::GetCPUCount ()
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	const int count = (int)info.dwNumberOfProcessors;
+#else
+	const int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	return (count > 0) ? count : 1;
+}
+
+unsigned WINAPI SWS_ThreadPool::Worker (void* threadPool)
+{
+	SWS_ThreadPool* _this = (SWS_ThreadPool*)threadPool;
+
+	for (;;)
+	{
+		Job job;
+		{
+			SWS_SectionLock lock(&_this->m_mutex);
+
+			// Exit when there's nothing left to do or the thread limit got lowered in the meantime
+			if (_this->m_queue.empty() || _this->m_workers > _this->m_maxThreads)
+			{
+				--_this->m_workers;
+				return 0;
+			}
+
+			job = _this->m_queue.front();
+			_this->m_queue.pop_front();
+			_this->m_running.insert(job.id);
+		}
+
+		job.proc(job.param);
+
+		SWS_SectionLock lock(&_this->m_mutex);
+		_this->m_running.erase(job.id);
+	}
+}
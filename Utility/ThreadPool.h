@@ -0,0 +1,70 @@
+/******************************************************************************
+/ ThreadPool.h
+/
+/ Copyright (c) 2026 reaper-oss
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#pragma once
+
+// SWS_ThreadPool: runs queued jobs on a bounded number of worker threads.
+// Workers are spawned on demand (up to the thread limit) and exit as soon as
+// the queue runs dry, so an idle pool doesn't hold on to any threads.
+//
+// Jobs use the same signature as _beginthreadex() thread functions so existing
+// thread functions can be submitted as they are. The pool can't interrupt a
+// running job, that is up to the job itself (i.e. by checking a kill flag).
+class SWS_ThreadPool
+{
+public:
+	typedef unsigned (WINAPI *JobProc)(void* param);
+
+	explicit SWS_ThreadPool (int maxThreads = 0); // 0 -> one thread per CPU core
+	~SWS_ThreadPool ();
+
+	int  Submit (JobProc proc, void* param);      // returns job id
+	bool Cancel (int jobId);                      // removes the job from the queue, false if it's already running or finished
+	void Wait (int jobId);                        // blocks until the job is finished (returns immediately if it's unknown or cancelled)
+	bool IsPending (int jobId);                   // queued or running
+	int  CountPending ();
+	void SetMaxThreads (int maxThreads);          // 0 -> one thread per CPU core
+	int  GetMaxThreads ();
+
+	static int GetCPUCount ();
+
+private:
+	struct Job
+	{
+		int id;
+		JobProc proc;
+		void* param;
+	};
+
+	static unsigned WINAPI Worker (void* threadPool);
+	SWS_ThreadPool (const SWS_ThreadPool&);
+	void operator= (const SWS_ThreadPool&);
+
+	SWS_Mutex m_mutex;
+	std::list<Job> m_queue;
+	std::set<int> m_running;
+	int m_maxThreads, m_workers, m_lastId;
+};
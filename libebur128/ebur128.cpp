@@ -27,6 +27,7 @@
 
 #include "stdafx.h"
 #include "ebur128.h"
+#include "ebur128_simd.h"
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include "queue/sys/queue.h"
@@ -423,7 +424,14 @@ static void ebur128_check_true_peak(ebur128_state* st, size_t frames) {
                                                  frames,
                                                  st->d->resampler_buffer_output_frames,
                                                  st->channels);
+  /* SWS: find block maximum with SIMD and scan only channels with new peaks */
+  double block_max[64];
+  int prefilter = st->channels <= 64;
+  if (prefilter)
+    ebur128_abs_max(st->d->resampler_buffer_output, st->channels, out_len,
+                    block_max);
   for (size_t c = 0; c < st->channels; ++c) {
+    if (prefilter && !(block_max[c] > st->d->true_peak[c])) continue;
     for (size_t i = 0; i < out_len; ++i) {
       if (st->d->resampler_buffer_output[i * st->channels + c] >
                                                          st->d->true_peak[c]) {
@@ -460,6 +468,43 @@ static void ebur128_check_true_peak(ebur128_state* st, size_t frames) {
     st->d->v[ci][1] = fabs(st->d->v[ci][1]) < DBL_MIN ? 0.0 : st->d->v[ci][1];
 #endif
 
+/* SWS: filter channels with SIMD kernels when possible. Only for double input
+ * (scaling factor is 1.0, so samples go to the filter unchanged), other types
+ * use the scalar code. Every lane gets the first channel using a filter state,
+ * channels sharing it (dual mono) stay scalar and are filtered afterwards, in
+ * the same order as before. Returns bit mask of filtered channels. */
+static unsigned long long ebur128_filter_simd(ebur128_state* st,
+                                              const double* src,
+                                              double* audio_data,
+                                              size_t frames) {
+  size_t lane_channels[5];
+  double* lane_state[5];
+  size_t lanes = 0;
+  int used = 0;
+  size_t c, l, done;
+  unsigned long long mask = 0;
+
+  for (c = 0; c < st->channels && c < 64; ++c) {
+    int ci = st->d->channel_map[c] - 1;
+    if (ci < 0) continue;
+    else if (ci > 4) ci = 0; /* dual mono */
+    if (used & (1 << ci)) continue;
+    used |= 1 << ci;
+    lane_channels[lanes] = c;
+    lane_state[lanes] = st->d->v[ci];
+    ++lanes;
+  }
+  done = ebur128_filter_lanes(src, audio_data, st->channels, lane_channels,
+                              lane_state, lanes, frames, st->d->a, st->d->b);
+  for (l = 0; l < done; ++l) mask |= 1ULL << lane_channels[l];
+  return mask;
+}
+
+static unsigned long long ebur128_filter_simd(ebur128_state*, const void*,
+                                              double*, size_t) {
+  return 0;
+}
+
 #define EBUR128_FILTER(type, min_scale, max_scale)                             \
 static void ebur128_filter_##type(ebur128_state* st, const type* src,          \
                                   size_t frames) {                             \
@@ -467,6 +512,7 @@ static void ebur128_filter_##type(ebur128_state* st, const type* src,          \
                                  -((double) min_scale) : (double) max_scale;   \
   double* audio_data = st->d->audio_data + st->d->audio_data_index;            \
   size_t i, c;                                                                 \
+  unsigned long long simd_done;                                                \
                                                                                \
   TURN_ON_FTZ                                                                  \
                                                                                \
@@ -503,11 +549,14 @@ static void ebur128_filter_##type(ebur128_state* st, const type* src,          \
     }                                                                          \
     ebur128_check_true_peak(st, frames);                                       \
   }                                                                            \
+  simd_done = ebur128_filter_simd(st, src, audio_data, frames);                \
   for (c = 0; c < st->channels; ++c) {                                         \
     int ci = st->d->channel_map[c] - 1;                                        \
     if (ci < 0) continue;                                                      \
     else if (ci > 4) ci = 0; /* dual mono */                                   \
-    for (i = 0; i < frames; ++i) {                                             \
+    if (c < 64 && (simd_done & (1ULL << c))) i = frames;                       \
+    else i = 0;                                                                \
+    for (; i < frames; ++i) {                                                  \
       st->d->v[ci][0] = (double) (src[i * st->channels + c] / scaling_factor)  \
                    - st->d->a[1] * st->d->v[ci][1]                             \
                    - st->d->a[2] * st->d->v[ci][2]                             \
@@ -0,0 +1,255 @@
+/* SWS: SIMD kernels for ebur128.cpp, see ebur128_simd.h                       */
+
+#include "stdafx.h"
+#include "ebur128_simd.h"
+
+#include <math.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define EBUR128_X86
+#  include <emmintrin.h>
+#  include <immintrin.h>
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#    define EBUR128_TARGET(isa)
+#  else
+#    define EBUR128_TARGET(isa) __attribute__((target(isa)))
+#  endif
+#endif
+
+static int ebur128_simd_detect(void) {
+  int detected = EBUR128_SIMD_NONE;
+#if defined(EBUR128_X86) && defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  if (info[3] & (1 << 26)) detected = EBUR128_SIMD_SSE2;
+
+  /* AVX2 needs CPU support (leaf 7) and OS saving YMM registers (OSXSAVE + XCR0) */
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  __cpuid(info, 0);
+  if (osxsave && info[0] >= 7) {
+    __cpuidex(info, 7, 0);
+    if ((info[1] & (1 << 5)) && (_xgetbv(0) & 0x6) == 0x6)
+      detected = EBUR128_SIMD_AVX2;
+  }
+#elif defined(EBUR128_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2")) detected = EBUR128_SIMD_SSE2;
+  if (__builtin_cpu_supports("avx2")) detected = EBUR128_SIMD_AVX2;
+#endif
+
+  return detected;
+}
+
+int ebur128_simd_level(void) {
+  /* thread-safe one-time init, analysis may run from several threads */
+  static const int level = ebur128_simd_detect();
+  return level;
+}
+
+#ifdef EBUR128_X86
+
+/* Operations (and their order) match the scalar filter in ebur128.cpp:
+ * v0 = x - a1*v1 - a2*v2 - a3*v3 - a4*v4, y = b0*v0 + b1*v1 + ... + b4*v4 */
+EBUR128_TARGET("sse2")
+static void ebur128_filter_sse2(const double* src, double* dst, size_t channels,
+                                const size_t* ch, double** v, size_t frames,
+                                const double* a, const double* b) {
+  __m128d a1 = _mm_set1_pd(a[1]), a2 = _mm_set1_pd(a[2]);
+  __m128d a3 = _mm_set1_pd(a[3]), a4 = _mm_set1_pd(a[4]);
+  __m128d b0 = _mm_set1_pd(b[0]), b1 = _mm_set1_pd(b[1]);
+  __m128d b2 = _mm_set1_pd(b[2]), b3 = _mm_set1_pd(b[3]);
+  __m128d b4 = _mm_set1_pd(b[4]);
+
+  __m128d v1 = _mm_set_pd(v[1][1], v[0][1]);
+  __m128d v2 = _mm_set_pd(v[1][2], v[0][2]);
+  __m128d v3 = _mm_set_pd(v[1][3], v[0][3]);
+  __m128d v4 = _mm_set_pd(v[1][4], v[0][4]);
+  __m128d v0 = _mm_set_pd(v[1][0], v[0][0]);
+
+  const bool adjacent = ch[1] == ch[0] + 1;
+  for (size_t i = 0; i < frames; ++i) {
+    const double* in = src + i * channels;
+    double* out = dst + i * channels;
+    __m128d x = adjacent ? _mm_loadu_pd(in + ch[0])
+                         : _mm_set_pd(in[ch[1]], in[ch[0]]);
+
+    v0 = _mm_sub_pd(x,  _mm_mul_pd(a1, v1));
+    v0 = _mm_sub_pd(v0, _mm_mul_pd(a2, v2));
+    v0 = _mm_sub_pd(v0, _mm_mul_pd(a3, v3));
+    v0 = _mm_sub_pd(v0, _mm_mul_pd(a4, v4));
+
+    __m128d y = _mm_mul_pd(b0, v0);
+    y = _mm_add_pd(y, _mm_mul_pd(b1, v1));
+    y = _mm_add_pd(y, _mm_mul_pd(b2, v2));
+    y = _mm_add_pd(y, _mm_mul_pd(b3, v3));
+    y = _mm_add_pd(y, _mm_mul_pd(b4, v4));
+
+    if (adjacent) {
+      _mm_storeu_pd(out + ch[0], y);
+    } else {
+      _mm_storel_pd(out + ch[0], y);
+      _mm_storeh_pd(out + ch[1], y);
+    }
+
+    v4 = v3;
+    v3 = v2;
+    v2 = v1;
+    v1 = v0;
+  }
+
+  double tmp[2];
+  _mm_storeu_pd(tmp, v0); v[0][0] = tmp[0]; v[1][0] = tmp[1];
+  _mm_storeu_pd(tmp, v1); v[0][1] = tmp[0]; v[1][1] = tmp[1];
+  _mm_storeu_pd(tmp, v2); v[0][2] = tmp[0]; v[1][2] = tmp[1];
+  _mm_storeu_pd(tmp, v3); v[0][3] = tmp[0]; v[1][3] = tmp[1];
+  _mm_storeu_pd(tmp, v4); v[0][4] = tmp[0]; v[1][4] = tmp[1];
+}
+
+EBUR128_TARGET("avx2")
+static void ebur128_filter_avx2(const double* src, double* dst, size_t channels,
+                                const size_t* ch, double** v, size_t frames,
+                                const double* a, const double* b) {
+  __m256d a1 = _mm256_set1_pd(a[1]), a2 = _mm256_set1_pd(a[2]);
+  __m256d a3 = _mm256_set1_pd(a[3]), a4 = _mm256_set1_pd(a[4]);
+  __m256d b0 = _mm256_set1_pd(b[0]), b1 = _mm256_set1_pd(b[1]);
+  __m256d b2 = _mm256_set1_pd(b[2]), b3 = _mm256_set1_pd(b[3]);
+  __m256d b4 = _mm256_set1_pd(b[4]);
+
+  __m256d v0 = _mm256_set_pd(v[3][0], v[2][0], v[1][0], v[0][0]);
+  __m256d v1 = _mm256_set_pd(v[3][1], v[2][1], v[1][1], v[0][1]);
+  __m256d v2 = _mm256_set_pd(v[3][2], v[2][2], v[1][2], v[0][2]);
+  __m256d v3 = _mm256_set_pd(v[3][3], v[2][3], v[1][3], v[0][3]);
+  __m256d v4 = _mm256_set_pd(v[3][4], v[2][4], v[1][4], v[0][4]);
+
+  const bool adjacent = ch[1] == ch[0] + 1 && ch[2] == ch[0] + 2 &&
+                        ch[3] == ch[0] + 3;
+  for (size_t i = 0; i < frames; ++i) {
+    const double* in = src + i * channels;
+    double* out = dst + i * channels;
+    __m256d x = adjacent ? _mm256_loadu_pd(in + ch[0])
+                         : _mm256_set_pd(in[ch[3]], in[ch[2]],
+                                         in[ch[1]], in[ch[0]]);
+
+    v0 = _mm256_sub_pd(x,  _mm256_mul_pd(a1, v1));
+    v0 = _mm256_sub_pd(v0, _mm256_mul_pd(a2, v2));
+    v0 = _mm256_sub_pd(v0, _mm256_mul_pd(a3, v3));
+    v0 = _mm256_sub_pd(v0, _mm256_mul_pd(a4, v4));
+
+    __m256d y = _mm256_mul_pd(b0, v0);
+    y = _mm256_add_pd(y, _mm256_mul_pd(b1, v1));
+    y = _mm256_add_pd(y, _mm256_mul_pd(b2, v2));
+    y = _mm256_add_pd(y, _mm256_mul_pd(b3, v3));
+    y = _mm256_add_pd(y, _mm256_mul_pd(b4, v4));
+
+    if (adjacent) {
+      _mm256_storeu_pd(out + ch[0], y);
+    } else {
+      double tmp[4];
+      _mm256_storeu_pd(tmp, y);
+      out[ch[0]] = tmp[0]; out[ch[1]] = tmp[1];
+      out[ch[2]] = tmp[2]; out[ch[3]] = tmp[3];
+    }
+
+    v4 = v3;
+    v3 = v2;
+    v2 = v1;
+    v1 = v0;
+  }
+
+  __m256d state[5] = {v0, v1, v2, v3, v4};
+  for (int k = 0; k < 5; ++k) {
+    double tmp[4];
+    _mm256_storeu_pd(tmp, state[k]);
+    for (int lane = 0; lane < 4; ++lane)
+      v[lane][k] = tmp[lane];
+  }
+}
+
+EBUR128_TARGET("sse2")
+static size_t ebur128_abs_max_sse2(const double* src, size_t channels,
+                                   size_t frames, double* max) {
+  const __m128d sign = _mm_set1_pd(-0.0);
+  size_t c = 0;
+  for (; c + 2 <= channels; c += 2) {
+    __m128d m = _mm_setzero_pd();
+    for (size_t i = 0; i < frames; ++i) {
+      __m128d x = _mm_andnot_pd(sign, _mm_loadu_pd(src + i * channels + c));
+      m = _mm_max_pd(x, m); /* returns m when x is NaN */
+    }
+    _mm_storeu_pd(max + c, m);
+  }
+  return c;
+}
+
+EBUR128_TARGET("avx2")
+static size_t ebur128_abs_max_avx2(const double* src, size_t channels,
+                                   size_t frames, double* max) {
+  const __m256d sign = _mm256_set1_pd(-0.0);
+  size_t c = 0;
+  for (; c + 4 <= channels; c += 4) {
+    __m256d m = _mm256_setzero_pd();
+    for (size_t i = 0; i < frames; ++i) {
+      __m256d x = _mm256_andnot_pd(sign,
+                                   _mm256_loadu_pd(src + i * channels + c));
+      m = _mm256_max_pd(x, m);
+    }
+    _mm256_storeu_pd(max + c, m);
+  }
+  return c;
+}
+
+#endif  /* EBUR128_X86 */
+
+size_t ebur128_filter_lanes(const double* src, double* dst, size_t channels,
+                            const size_t* lane_channels, double** lane_state,
+                            size_t lanes, size_t frames,
+                            const double* a, const double* b) {
+  size_t done = 0;
+#ifdef EBUR128_X86
+  const int level = ebur128_simd_level();
+  if (level >= EBUR128_SIMD_AVX2) {
+    for (; done + 4 <= lanes; done += 4)
+      ebur128_filter_avx2(src, dst, channels, lane_channels + done,
+                          lane_state + done, frames, a, b);
+  }
+  if (level >= EBUR128_SIMD_SSE2) {
+    for (; done + 2 <= lanes; done += 2)
+      ebur128_filter_sse2(src, dst, channels, lane_channels + done,
+                          lane_state + done, frames, a, b);
+  }
+#endif
+  return done;
+}
+
+void ebur128_abs_max(const double* src, size_t channels, size_t frames,
+                     double* max) {
+  size_t c = 0;
+#ifdef EBUR128_X86
+  const int level = ebur128_simd_level();
+  if (level >= EBUR128_SIMD_AVX2)
+    c = ebur128_abs_max_avx2(src, channels, frames, max);
+  else if (level >= EBUR128_SIMD_SSE2)
+    c = ebur128_abs_max_sse2(src, channels, frames, max);
+#endif
+  for (; c < channels; ++c) {
+    double m = 0.0;
+    for (size_t i = 0; i < frames; ++i) {
+      double x = fabs(src[i * channels + c]);
+      if (x > m) m = x;
+    }
+    max[c] = m;
+  }
+}
+
+void ebur128_abs_max(const float* src, size_t channels, size_t frames,
+                     double* max) {
+  for (size_t c = 0; c < channels; ++c) {
+    double m = 0.0;
+    for (size_t i = 0; i < frames; ++i) {
+      double x = fabs((double) src[i * channels + c]);
+      if (x > m) m = x;
+    }
+    max[c] = m;
+  }
+}
@@ -0,0 +1,52 @@
+/* SWS: SIMD kernels for ebur128.cpp. Channels are processed in parallel      *
+*  lanes (2 with SSE2, 4 with AVX2), instruction set is selected at runtime    *
+*  and everything falls back to scalar code in ebur128.cpp when unavailable.  *
+*  Kernels perform the same floating point operations in the same order as    *
+*  the scalar code so results are bit-identical.                              */
+
+#ifndef EBUR128_SIMD_H_
+#define EBUR128_SIMD_H_
+
+#include <stddef.h>
+
+enum {
+  EBUR128_SIMD_NONE = 0,
+  EBUR128_SIMD_SSE2,
+  EBUR128_SIMD_AVX2
+};
+
+/** \brief Get instruction set used by SIMD kernels (detected once). */
+int ebur128_simd_level(void);
+
+/** \brief Apply K-weighting filter to several channels at once.
+ *
+ *  @param src interleaved input (already scaled to -1.0..1.0).
+ *  @param dst interleaved output.
+ *  @param channels channel count (stride) of src and dst.
+ *  @param lane_channels channel index of each lane, must be distinct.
+ *  @param lane_state filter state (v[5]) of each lane, must be distinct.
+ *  @param lanes number of lanes.
+ *  @param frames number of frames.
+ *  @param a filter coefficients (denominator).
+ *  @param b filter coefficients (nominator).
+ *  @return number of lanes processed (starting from the first one), the rest
+ *          is left to the caller.
+ */
+size_t ebur128_filter_lanes(const double* src, double* dst, size_t channels,
+                            const size_t* lane_channels, double** lane_state,
+                            size_t lanes, size_t frames,
+                            const double* a, const double* b);
+
+/** \brief Get absolute maximum of each channel.
+ *
+ *  @param src interleaved input.
+ *  @param channels channel count.
+ *  @param frames number of frames.
+ *  @param max output, one per channel (NaNs are ignored).
+ */
+void ebur128_abs_max(const double* src, size_t channels, size_t frames,
+                     double* max);
+void ebur128_abs_max(const float* src, size_t channels, size_t frames,
+                     double* max);
+
+#endif  /* EBUR128_SIMD_H_ */
@@ -490,7 +490,7 @@ class SWSTimeSlice: public IReaperControlSurface {
 
       if (m_bChanged) {
         m_bChanged = false;
-        ScheduleTracklistUpdate();
+        ScheduleTracklistUpdate(true);
         g_pMarkerList->Update();
         UpdateSnapshotsDialog();
         ProjectListUpdate();
@@ -514,6 +514,8 @@ class SWSTimeSlice: public IReaperControlSurface {
 
     // This is our only notification of active project tab change, so update everything
     void SetTrackListChange() {
+      InvalidateGuidIndex();
+      SWS_FolderTree::Invalidate();
       m_bChanged = true;
       m_bAutoColorTrackAsync = true;
       AutoColorMarkerRegion(false);
@@ -524,7 +526,7 @@ class SWSTimeSlice: public IReaperControlSurface {
     // want to call AutoColorRun once, so ignore those n+1.
     // However, we still need to trap track name changes with no track list change.
     void SetTrackTitle(MediaTrack *tr, const char *c) {
-      ScheduleTracklistUpdate();
+      ScheduleTracklistUpdate(true);
       if (!m_iACIgnore) {
         m_bAutoColorTrackAsync = true;
         SNM_CSurfSetTrackTitle();
@@ -383,53 +383,117 @@ void ClearSelected()
 		GetSetMediaTrackInfo(CSurf_TrackFromID(i, false), "I_SELECTED", &iSel);
 }
 
-int GetFolderDepth(MediaTrack* tr, int* iType, MediaTrack** nextTr) // iType: 0=normal, 1=parent, < 0=last in folder
+///////////////////////////////////////////////////////////////////////////////
+// Folder tree
+///////////////////////////////////////////////////////////////////////////////
+
+static SWS_FolderTree g_folderTree;
+static int g_folderTreeGen = 0;
+
+const SWS_FolderTree* SWS_FolderTree::Get()
 {
-	//static MediaTrack* nextTr = NULL; Let calling fcn keep track so state is reset appropriately
-	static int iLastFolder = 0;
-	int iFolder;
+	ReaProject* proj = EnumProjects(-1, NULL, 0);
+	if (g_folderTree.m_gen != g_folderTreeGen || g_folderTree.m_proj != proj ||
+		g_folderTree.m_stateCount != GetProjectStateChangeCount(proj) || g_folderTree.GetCount() != GetNumTracks()+1)
+		g_folderTree.Build(proj);
+	return &g_folderTree;
+}
 
-	if (tr == *nextTr)
-	{
-		*nextTr = CSurf_TrackFromID(CSurf_TrackToID(tr, false) + 1, false);
+// track list changes, or folder depths changed by the caller (i.e. with no undo point yet)
+void SWS_FolderTree::Invalidate()
+{
+	g_folderTreeGen++;
+}
 
-		if (CSurf_TrackToID(tr, false) == 0) // Special case for master
-		{
-			if (iType)
-				*iType = 1;
-			return -1; // Master is at '-1' depth
-		}
+void SWS_FolderTree::Build(ReaProject* proj)
+{
+	const int nbTracks = GetNumTracks();
+	m_proj = proj;
+	m_stateCount = GetProjectStateChangeCount(proj);
+	m_gen = g_folderTreeGen;
+	m_nodes.resize(nbTracks+1);
+	m_ids.clear();
+	m_ids.reserve(nbTracks+1);
 
-		iFolder = *(int*)GetSetMediaTrackInfo(tr, "I_FOLDERDEPTH", NULL);
-			
-		if (iType)
-			*iType = iFolder;
+	// master: '-1' depth, considered as the parent of all tracks (as GetFolderDepth() always did)
+	Node* node = &m_nodes[0];
+	node->tr = CSurf_TrackFromID(0, false);
+	node->depth = -1;
+	node->type = 1;
+	node->parent = -1;
+	node->lastDesc = nbTracks;
+	m_ids.emplace(node->tr, 0);
 
-		if (iFolder == 0)
-			return iLastFolder;
-		else if (iFolder == 1)
+	std::vector<int> openFolders;
+	int iLastFolder = 0;
+	for (int id = 1; id <= nbTracks; id++)
+	{
+		node = &m_nodes[id];
+		node->tr = CSurf_TrackFromID(id, false);
+		node->type = *(int*)GetSetMediaTrackInfo(node->tr, "I_FOLDERDEPTH", NULL);
+		node->parent = openFolders.size() ? openFolders.back() : -1;
+		node->lastDesc = id;
+		m_ids.emplace(node->tr, id);
+
+		if (node->type <= 1)
 		{
-			iLastFolder++;
-			return iLastFolder - 1; // Count parent as at the "previous" level
+			node->depth = iLastFolder; // parents are at the "previous" level
+			iLastFolder += node->type;
 		}
-		else if (iFolder < 0)
+		else
+			node->depth = -1;
+
+		// close folders, same test as legacy GetFolderDepth() callers
+		while (openFolders.size() && node->depth + node->type <= m_nodes[openFolders.back()].depth)
 		{
-			int iCur = iLastFolder;
-			iLastFolder += iFolder;
-			return iCur;
+			m_nodes[openFolders.back()].lastDesc = id;
+			openFolders.pop_back();
 		}
+		if (node->type == 1)
+			openFolders.push_back(id);
 	}
-	else
+	// unterminated folders
+	for (size_t i = 0; i < openFolders.size(); i++)
+		m_nodes[openFolders[i]].lastDesc = nbTracks;
+}
+
+int SWS_FolderTree::GetId(MediaTrack* tr) const
+{
+	std::unordered_map<MediaTrack*, int>::const_iterator it = m_ids.find(tr);
+	return it != m_ids.end() ? it->second : -1;
+}
+
+int SWS_FolderTree::GetDepth(int id, int* iType) const
+{
+	if (id < 0 || id >= GetCount())
 	{
-		// Must iterate until reaching the track passed in
-		iLastFolder = 0;
-		*nextTr = CSurf_TrackFromID(0, false);
-		while (tr != *nextTr)
-			GetFolderDepth(*nextTr, NULL, nextTr);
+		if (iType)
+			*iType = 0;
+		return -1;
+	}
+	if (iType)
+		*iType = m_nodes[id].type;
+	return m_nodes[id].depth;
+}
 
-		return GetFolderDepth(tr, iType, nextTr);
+// iType: 0=normal, 1=parent, < 0=last in folder
+// nextTr: legacy iteration cursor, not needed anymore (set to the next track though)
+int GetFolderDepth(MediaTrack* tr, int* iType, MediaTrack** nextTr)
+{
+	const SWS_FolderTree* tree = SWS_FolderTree::Get();
+	int id = tree->GetId(tr);
+
+	// cheap check in case folder depths were changed with no notification/undo point yet
+	if (id > 0 && tree->GetType(id) != *(int*)GetSetMediaTrackInfo(tr, "I_FOLDERDEPTH", NULL))
+	{
+		SWS_FolderTree::Invalidate();
+		tree = SWS_FolderTree::Get();
+		id = tree->GetId(tr);
 	}
-	return -1;
+
+	if (nextTr)
+		*nextTr = tree->GetTrack(id >= 0 ? id+1 : -1);
+	return tree->GetDepth(id, iType);
 }
 
 int GetTrackVis(MediaTrack* tr) // &1 == mcp, &2 == tcp
@@ -488,6 +552,133 @@ const GUID* TrackToGuid(ReaProject* proj, MediaTrack* tr)
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// GUID -> track/item index
+///////////////////////////////////////////////////////////////////////////////
+
+size_t GuidHash::operator()(const GUID& g) const
+{
+	// FNV-1a
+	const unsigned char* p = (const unsigned char*)&g;
+	size_t h = (size_t)2166136261u;
+	for (size_t i = 0; i < sizeof(GUID); ++i)
+		h = (h ^ p[i]) * (size_t)16777619u;
+	return h;
+}
+
+// Lookup tables per project, (re)built on demand when the project state change
+// count or the track/item count changed, or after InvalidateGuidIndex().
+// Found objects are double-checked so that stale tables can't return dangling pointers,
+// the 1st miss at a given state rebuilds the table (unless it was just built) in case GUIDs
+// changed with no state change (chunk edits etc.), later misses at that state are trusted.
+class SWS_GuidIndex
+{
+public:
+	MediaTrack* FindTrack(ReaProject* proj, const GUID* guid)
+	{
+		Tables* t = GetTables(&proj);
+		bool built = !IsValid(proj, &t->m_trackState, CountTracks(proj));
+		if (built)
+			BuildTracks(t, proj);
+		for (;;)
+		{
+			auto it = t->m_tracks.find(*guid);
+			if (it != t->m_tracks.end() && ValidatePtr2(proj, it->second, "MediaTrack*") && TrackMatchesGuid(proj, it->second, guid))
+				return it->second;
+			if (built || t->m_trackState.retried)
+				return nullptr;
+			BuildTracks(t, proj); // GUIDs can change without the counts changing (chunk edits etc.), rebuild once before giving up
+			t->m_trackState.retried = true;
+			built = true;
+		}
+	}
+
+	MediaItem* FindItem(ReaProject* proj, const GUID* guid)
+	{
+		Tables* t = GetTables(&proj);
+		bool built = !IsValid(proj, &t->m_itemState, CountMediaItems(proj));
+		if (built)
+			BuildItems(t, proj);
+		for (;;)
+		{
+			auto it = t->m_items.find(*guid);
+			if (it != t->m_items.end() && ValidatePtr2(proj, it->second, "MediaItem*") && GuidsEqual((GUID*)GetSetMediaItemInfo(it->second, "GUID", nullptr), guid))
+				return it->second;
+			if (built || t->m_itemState.retried)
+				return nullptr;
+			BuildItems(t, proj); // see FindTrack()
+			t->m_itemState.retried = true;
+			built = true;
+		}
+	}
+
+	void Invalidate() { m_projects.clear(); }
+
+private:
+	struct State
+	{
+		State() : stateCount(-1), count(-1), retried(false) {}
+		int stateCount, count;
+		bool retried; // rebuilt on a miss at this state already, further misses are trusted
+	};
+	struct Tables
+	{
+		State m_trackState, m_itemState;
+		std::unordered_map<GUID, MediaTrack*, GuidHash, GuidEqual> m_tracks;
+		std::unordered_map<GUID, MediaItem*, GuidHash, GuidEqual> m_items;
+	};
+
+	Tables* GetTables(ReaProject** proj)
+	{
+		if (!*proj)
+			*proj = EnumProjects(-1, nullptr, 0);
+		return &m_projects[*proj];
+	}
+
+	static bool IsValid(ReaProject* proj, State* state, int count)
+	{
+		return state->count == count && state->stateCount == GetProjectStateChangeCount(proj);
+	}
+
+	static void BuildTracks(Tables* t, ReaProject* proj)
+	{
+		const int trackCount = CountTracks(proj);
+		t->m_trackState.count = trackCount;
+		t->m_trackState.stateCount = GetProjectStateChangeCount(proj);
+		t->m_trackState.retried = false;
+		t->m_tracks.clear();
+		t->m_tracks.reserve(trackCount);
+		for (int i = 0; i < trackCount; ++i)
+			if (MediaTrack* tr = GetTrack(proj, i))
+				if (const GUID* g = TrackToGuid(proj, tr))
+					t->m_tracks.emplace(*g, tr); // no overwrite: 1st one wins, as with linear scans
+	}
+
+	static void BuildItems(Tables* t, ReaProject* proj)
+	{
+		const int itemCount = CountMediaItems(proj);
+		t->m_itemState.count = itemCount;
+		t->m_itemState.stateCount = GetProjectStateChangeCount(proj);
+		t->m_itemState.retried = false;
+		t->m_items.clear();
+		t->m_items.reserve(itemCount);
+		for (int i = 0; i < itemCount; ++i)
+			if (MediaItem* item = GetMediaItem(proj, i))
+				if (const GUID* g = (GUID*)GetSetMediaItemInfo(item, "GUID", nullptr))
+					t->m_items.emplace(*g, item);
+	}
+
+	std::unordered_map<ReaProject*, Tables> m_projects;
+};
+
+static SWS_GuidIndex g_guidIndex;
+
+// track list changes (incl. project tab switches, closed projects, etc.)
+void InvalidateGuidIndex()
+{
+	g_guidIndex.Invalidate();
+}
+
 MediaTrack* GuidToTrack(ReaProject* project, const GUID* guid)
 {
 	if (!guid)
@@ -497,14 +688,12 @@ MediaTrack* GuidToTrack(ReaProject* project, const GUID* guid)
 	if (master && TrackMatchesGuid(project, master, guid))
 		return master;
 
-	const int trackCount = CountTracks(project);
-	for (int i = 0; i < trackCount; ++i) {
-		MediaTrack* tr = GetTrack(project, i);
-		if (tr && TrackMatchesGuid(project, tr, guid))
-			return tr;
-	}
+	return g_guidIndex.FindTrack(project, guid);
+}
 
-	return nullptr;
+MediaItem* GuidToMediaItem(ReaProject* project, const GUID* guid)
+{
+	return guid ? g_guidIndex.FindItem(project, guid) : nullptr;
 }
 
 bool GuidsEqual(const GUID* g1, const GUID* g2)
@@ -27,6 +27,9 @@
 
 #pragma once
 
+#include <unordered_map>
+#include <vector>
+
 #if defined(_SWS_DEBUG)
   #define WDL_PtrList_DOD WDL_PtrList_DeleteOnDestroy
 #else
@@ -230,6 +233,37 @@ int NumSelTracks();
 void SaveSelected();
 void RestoreSelected();
 void ClearSelected();
+
+// Folder hierarchy of the current project's tracks, cached until the track list or the
+// project state changes. Ids are CSurf_TrackFromID() ones (0 = master)
+class SWS_FolderTree
+{
+public:
+	SWS_FolderTree() : m_proj(NULL), m_stateCount(-1), m_gen(-1) {}
+	static const SWS_FolderTree* Get(); // up-to-date tree
+	static void Invalidate();
+
+	int GetCount() const { return (int)m_nodes.size(); } // incl. master
+	MediaTrack* GetTrack(int id) const { return id >= 0 && id < GetCount() ? m_nodes[id].tr : NULL; }
+	int GetId(MediaTrack* tr) const; // -1 if not found
+	int GetDepth(int id, int* iType = NULL) const; // as GetFolderDepth()
+	int GetType(int id) const { return id >= 0 && id < GetCount() ? m_nodes[id].type : 0; } // I_FOLDERDEPTH
+	int GetParent(int id) const { return id >= 0 && id < GetCount() ? m_nodes[id].parent : -1; } // -1 for top level tracks
+	// children/descendants are in ]id, GetLastDescendant(id)], returns id when not a folder
+	int GetLastDescendant(int id) const { return id >= 0 && id < GetCount() ? m_nodes[id].lastDesc : id; }
+
+private:
+	struct Node {
+		MediaTrack* tr;
+		int depth, type, parent, lastDesc;
+	};
+	void Build(ReaProject* proj);
+
+	ReaProject* m_proj;
+	int m_stateCount, m_gen;
+	std::vector<Node> m_nodes;
+	std::unordered_map<MediaTrack*, int> m_ids;
+};
 int GetFolderDepth(MediaTrack* tr, int* iType, MediaTrack** nextTr);
 int GetTrackVis(MediaTrack* tr); // &1 == mcp, &2 == tcp
 void SetTrackVis(MediaTrack* tr, int vis); // &1 == mcp, &2 == tcp
@@ -241,7 +275,11 @@ const GUID* TrackToGuid(ReaProject*, MediaTrack*);
 inline const GUID* TrackToGuid(MediaTrack* tr) { return TrackToGuid(nullptr, tr); }
 MediaTrack* GuidToTrack(ReaProject*, const GUID*);
 inline MediaTrack* GuidToTrack(const GUID* guid) { return GuidToTrack(nullptr, guid); }
+MediaItem* GuidToMediaItem(ReaProject*, const GUID*); // see GuidToItem() in BR_Util.h
+void InvalidateGuidIndex();
 bool GuidsEqual(const GUID* g1, const GUID* g2);
+struct GuidHash { size_t operator()(const GUID& g) const; };
+struct GuidEqual { bool operator()(const GUID& g1, const GUID& g2) const { return !memcmp(&g1, &g2, sizeof(GUID)); } };
 bool TrackMatchesGuid(ReaProject*, MediaTrack*, const GUID*);
 inline bool TrackMatchesGuid(MediaTrack* tr, const GUID* g) { return TrackMatchesGuid(nullptr, tr, g); }
 const char *stristr(const char* a, const char* b);
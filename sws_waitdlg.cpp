@@ -29,6 +29,7 @@
 // The box closes and the constructor returns when dProgress >= 1.0.
 // ESC closes the box as well, but it blocks until dProgress >= 1.0.
 // You'll want to start a thread to do the work that updates dProgress.
+// If bCancel is provided, the cancel button sets it - the thread should check it and finish early.
 
 // Note, on Win7 the progress bar update is filtered (why??) such that
 // it appears that the progress is "behind" where it actually is for
@@ -42,10 +43,11 @@
 
 const char SWS_WAITDLG_WNDPOS_KEY[] = "Wait Dialog Position";
 
-SWS_WaitDlg::SWS_WaitDlg(const char* cTitle, double* dProgress, HWND hParent)
+SWS_WaitDlg::SWS_WaitDlg(const char* cTitle, double* dProgress, HWND hParent, bool* bCancel)
 {
 	m_hwnd = NULL;
 	m_dProgress = dProgress;
+	m_bCancel = bCancel;
 	m_cTitle = cTitle;
 	double dPrevProgress = *dProgress;
 	Sleep(0);
@@ -82,6 +84,7 @@ int SWS_WaitDlg::waitDlgWndProc(UINT uMsg, WPARAM wParam, LPARAM lParam)
 			SetWindowText(m_hwnd, m_cTitle);
 			RestoreWindowPos(m_hwnd, SWS_WAITDLG_WNDPOS_KEY, false);
 			hProgress = GetDlgItem(m_hwnd, IDC_PROGRESS);
+			ShowWindow(GetDlgItem(m_hwnd, IDCANCEL), m_bCancel ? SW_SHOW : SW_HIDE);
 			SendMessage(hProgress, PBM_SETPOS, (int)(*m_dProgress * 100.0), 0);
 			SetTimer(m_hwnd, 1, 50, NULL);
 			break;
@@ -97,6 +100,8 @@ int SWS_WaitDlg::waitDlgWndProc(UINT uMsg, WPARAM wParam, LPARAM lParam)
 			{
 				case IDOK:
 				case IDCANCEL:
+					if (m_bCancel && *m_dProgress < 1.0)
+						*m_bCancel = true;
 					SaveWindowPos(m_hwnd, SWS_WAITDLG_WNDPOS_KEY);
 					KillTimer(m_hwnd, 1);
 					EndDialog(m_hwnd, 0);
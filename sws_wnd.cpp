@@ -47,6 +47,8 @@
 #  include <WDL/swell/swell-dlggen.h>
 #endif
 
+#include <unordered_set>
+
 
 #define CELL_EDIT_TIMER		0x1000
 #define CELL_EDIT_TIMEOUT	50
@@ -700,6 +702,7 @@ SWS_ListView::SWS_ListView(HWND hwndList,
     m_iEditingItem(-1), m_iEditingCol(-1),
     m_iCols(iCols), m_pCols(NULL), m_pDefaultCols(NULL), m_bDisableUpdates(false),
     m_cINIKey(cINIKey), m_cLocalizeSection(cLocalizeSection), m_bDrawArrow(bDrawArrow),
+    m_bTextOnDemand(false),
 #ifndef _WIN32
     m_pClickedItem(NULL)
 #else
@@ -883,6 +886,16 @@ bool SWS_ListView::SelectByItem(SWS_ListItem *_item, bool bSelectOnly, bool bEns
 int SWS_ListView::OnNotify(WPARAM wParam, LPARAM lParam) {
   NMLISTVIEW *s = (NMLISTVIEW *) lParam;
 
+  if (m_bTextOnDemand && s->hdr.code == LVN_GETDISPINFO) {
+    NMLVDISPINFO *di = (NMLVDISPINFO *) lParam;
+    if ((di->item.mask & LVIF_TEXT) && di->item.pszText && di->item.cchTextMax > 0) {
+      di->item.pszText[0] = 0;
+      if (SWS_ListItem *item = GetListItem(di->item.iItem))
+        GetItemText(item, DisplayToDataCol(di->item.iSubItem), di->item.pszText, di->item.cchTextMax);
+    }
+    return 0;
+  }
+
 #ifdef _WIN32
   if (!m_bDisableUpdates && s->hdr.code == LVN_ITEMCHANGING && s->iItem >= 0 && (s->uNewState ^ s->
     uOldState) & LVIS_SELECTED) {
@@ -1124,36 +1137,61 @@ void SWS_ListView::Update(const bool reassign) {
     SWS_ListItemList items;
     GetItemList(&items);
 
-    if (!items.GetSize())
+    if (!items.GetSize()) {
       ListView_DeleteAllItems(m_hwndList);
+      m_itemGens.clear();
+    }
+
+    // Hash the item list so that listview rows are matched in constant time:
+    // matched items are removed from the set, what's left are new items
+    std::unordered_set<SWS_ListItem *> newItems;
+    newItems.reserve(items.GetSize());
+    for (int i = 0; i < items.GetSize(); i++)
+      newItems.insert(items.Get(i));
 
-    // The list is sorted, use that to our advantage here:
     int lvItemCount = ListView_GetItemCount(m_hwndList);
     int newIndex = lvItemCount;
-    for (int i = 0; items.GetSize() || i < lvItemCount; i++) {
+    int iNewItem = items.GetSize(); // new items are added from the end of the list
+    for (int i = 0; newItems.size() || i < lvItemCount; i++) {
       bool bFound = false;
-      SWS_ListItem *pItem;
+      SWS_ListItem *pItem = NULL;
       if (i < lvItemCount) {
         // First check items in the listview, match to item list
         pItem = GetListItem(i);
-        int iIndex = items.Find(pItem);
-        if (iIndex == -1) {
+        if (!newItems.erase(pItem)) {
           // Delete items from listview that aren't in the item list
           ListView_DeleteItem(m_hwndList, i);
+          m_itemGens.erase(pItem);
           i--;
           lvItemCount--;
           newIndex--;
           continue;
-        } else {
-          // Delete item from item list to indicate "used"
-          items.Delete(iIndex);
-          bFound = true;
         }
+        bFound = true;
       } else {
-        // Items left in the item list are new
-        pItem = items.Remove();
+        // Items left in the set are new
+        while (!pItem && iNewItem > 0) {
+          SWS_ListItem *p = items.Get(--iNewItem);
+          if (newItems.erase(p))
+            pItem = p;
+        }
+        if (!pItem)
+          break;
       }
 
+      // Unchanged generation: no need to pull/compare texts
+      const int iGen = GetItemGeneration(pItem);
+      bool bTextChanged = true;
+      if (iGen >= 0) {
+        std::unordered_map<SWS_ListItem *, int>::iterator it = m_itemGens.find(pItem);
+        if (it != m_itemGens.end()) {
+          bTextChanged = !bFound || reassign || it->second != iGen;
+          it->second = iGen;
+        } else
+          m_itemGens.insert(std::make_pair(pItem, iGen));
+      } else
+        m_itemGens.erase(pItem);
+
       // We have an item pointer, and a listview index, add/edit the listview
       // Update the list, no matter what, because text may have changed
       LVITEM item;
@@ -1175,7 +1213,7 @@ void SWS_ListView::Update(const bool reassign) {
       }
 
       item.iItem = bFound ? i : newIndex++;
-      item.pszText = str;
+      item.pszText = m_bTextOnDemand ? LPSTR_TEXTCALLBACK : str;
 
       if (reassign) {
         // update list view item/internal data item association
@@ -1184,11 +1222,26 @@ void SWS_ListView::Update(const bool reassign) {
         item.lParam = reinterpret_cast<LPARAM>(pItem);
       }
 
+      if (bFound && (m_bTextOnDemand || !bTextChanged)) {
+        // Texts are pulled when displayed, or known to be unchanged
+        if (item.mask) {
+          item.iSubItem = 0;
+          ListView_SetItem(m_hwndList, &item);
+        }
+        if (m_bTextOnDemand && bTextChanged) {
+          ListView_RedrawItems(m_hwndList, i, i);
+          if (iGen >= 0) // unknown generations don't trigger sorts, see GetItemGeneration()
+            bResort = true;
+        }
+        continue;
+      }
+
       int iCol = 0;
       for (int k = 0; k < m_iCols; k++)
         if (m_pCols[k].iPos != -1) {
           item.iSubItem = iCol;
-          GetItemText(pItem, k, str, sizeof(str));
+          if (!m_bTextOnDemand)
+            GetItemText(pItem, k, str, sizeof(str));
           if (!bFound) {
             item.mask |= LVIF_TEXT;
             if (iCol == 0) {
@@ -1320,6 +1373,7 @@ bool SWS_ListView::DoColumnMenu(int x, int y) {
       }
 
       ListView_DeleteAllItems(m_hwndList);
+      m_itemGens.clear();
       while (ListView_DeleteColumn(m_hwndList, 0));
       ShowColumns();
       Update();
@@ -1466,8 +1520,12 @@ bool SWS_ListView::EditListItemEnd(bool bSave, bool bResort) {
       GetItemText(item, editedCol, curStr, sizeof(curStr));
       if (strcmp(curStr, newStr)) {
         SetItemText(item, editedCol, newStr);
-        GetItemText(item, editedCol, newStr, sizeof(newStr));
-        ListView_SetItemText(m_hwndList, m_iEditingItem, DataToDisplayCol(editedCol), newStr);
+        if (m_bTextOnDemand) {
+          ListView_RedrawItems(m_hwndList, m_iEditingItem, m_iEditingItem); // keep the text callback
+        } else {
+          GetItemText(item, editedCol, newStr, sizeof(newStr));
+          ListView_SetItemText(m_hwndList, m_iEditingItem, DataToDisplayCol(editedCol), newStr);
+        }
         updated = true;
       }
       if (bResort)
@@ -27,6 +27,8 @@
 
 #pragma once
 
+#include <unordered_map>
+
 #define TOOLTIP_MAX_LEN					512
 #define CELL_MAX_LEN					256
 #define MIN_DOCKWND_WIDTH				147
@@ -126,6 +128,13 @@ class SWS_ListView {
     }
     void DisableUpdates(bool bDisable) { m_bDisableUpdates = bDisable; }
     bool UpdatesDisabled() { return m_bDisableUpdates; }
+    // On-demand text: cells are not filled by Update(), their text is pulled
+    // through GetItemText() only when displayed (visible rows).
+    // Should be set before the first Update(), along with GetItemGeneration():
+    // rows are only redrawn/resorted when their generation changes.
+    void SetTextOnDemand(bool bOnDemand) { m_bTextOnDemand = bOnDemand; }
+    // Next Update() refreshes all rows, e.g. when the display format changes
+    void InvalidateItemGenerations() { m_itemGens.clear(); }
     HWND GetHWND() { return m_hwndList; }
     HWND GetEditHWND() { return m_hwndEdit; }
     virtual bool HideGridLines() { return false; }
@@ -151,6 +160,11 @@ class SWS_ListView {
     virtual void GetItemList(SWS_ListItemList *pList) { pList->Empty(); }
     virtual int GetItemState(SWS_ListItem *item) { return -1; }
     // Selection state: -1 == unchanged, 0 == false, 1 == selected
+    virtual int GetItemGeneration(SWS_ListItem *item) { return -1; }
+    // Change counter of the item's texts: Update() skips rows with an unchanged
+    // generation. Must change whenever the texts do, and never be shared by another
+    // item (item pointers can be reused), e.g. a global counter.
+    // -1 == unknown (texts are always compared, or just redrawn when on demand)
     // These inform the derived class of user interaction
     virtual bool OnItemSelChanging(SWS_ListItem *item, bool bSel) { return false; }
     // Returns TRUE to prevent the change, or FALSE to allow the change
@@ -201,6 +215,8 @@ class SWS_ListView {
     bool m_bShiftSel;
 #endif
     WDL_TypedBuf<int> m_pSavedSel;
+    bool m_bTextOnDemand;
+    std::unordered_map<SWS_ListItem *, int> m_itemGens; // generations of the listview's items, see Update()
     HWND m_hwndEdit;
     SWS_LVColumn *m_pDefaultCols;
     const char *m_cINIKey;